@@ -75,6 +75,13 @@
 #
 #     libregex
 #     zlib
+#
+#  The mesh boolean library shipped with newer BRL-CAD releases is
+#  optional, it's looked up together with its headers:
+#
+#     BRLCAD_MANIFOLD_LIBRARY - manifold library
+#     BRLCAD_MANIFOLD_STATIC_LIBRARY - manifold static library
+#     BRLCAD_MANIFOLD_INCLUDE_DIR - the directory containing manifold/manifold.h
 # 
 #########################################################################
 
@@ -226,7 +233,6 @@ SET(BRL-CAD_SRC_OTHER_REQUIRED
     express
     jpeg
     lmdb
-    manifold
     mmesh
     netpbm
     openNURBS
@@ -255,6 +261,23 @@ ENDFOREACH(ext_lib ${BRL-CAD_SRC_OTHER_REQUIRED})
 # Do another check for opennurbs static lib
 FIND_LIBRARY(BRLCAD_OPENNURBS_STATIC_LIBRARY NAMES opennurbsStatic PATHS ${BRLCAD_LIB_DIR} NO_SYSTEM_PATH)
 
+# The optional manifold library, it's only useful together with its headers
+FIND_LIBRARY(BRLCAD_MANIFOLD_LIBRARY NAMES manifold libmanifold manifold_brl libmanifold_brl PATHS ${BRLCAD_LIB_DIR} NO_SYSTEM_PATH)
+FIND_LIBRARY(BRLCAD_MANIFOLD_STATIC_LIBRARY NAMES manifold${STATIC_LIBRARY_SUFFIX} libmanifold${STATIC_LIBRARY_SUFFIX} manifold_brl${STATIC_LIBRARY_SUFFIX} libmanifold_brl${STATIC_LIBRARY_SUFFIX} PATHS ${BRLCAD_LIB_DIR} NO_SYSTEM_PATH)
+IF("${BRLCAD_MANIFOLD_STATIC_LIBRARY}" STREQUAL "BRLCAD_MANIFOLD_STATIC_LIBRARY-NOTFOUND")
+    # use the dynamic one
+    SET(BRLCAD_MANIFOLD_STATIC_LIBRARY ${BRLCAD_MANIFOLD_LIBRARY})
+ENDIF("${BRLCAD_MANIFOLD_STATIC_LIBRARY}" STREQUAL "BRLCAD_MANIFOLD_STATIC_LIBRARY-NOTFOUND")
+FIND_PATH(BRLCAD_MANIFOLD_INCLUDE_DIR manifold/manifold.h HINTS ${BRLCAD_INCLUDE_DIRS} ${BRLCAD_BASE_DIR} PATH_SUFFIXES include NO_SYSTEM_ENVIRONMENT_PATH NO_CMAKE_SYSTEM_PATH)
+IF(BRLCAD_MANIFOLD_LIBRARY)
+    SET(BRLCAD_LIBRARIES ${BRLCAD_LIBRARIES} ${BRLCAD_MANIFOLD_LIBRARY})
+ENDIF(BRLCAD_MANIFOLD_LIBRARY)
+IF(BRLCAD_MANIFOLD_LIBRARY AND BRLCAD_MANIFOLD_INCLUDE_DIR)
+    MESSAGE(STATUS "Found BRL-CAD's manifold library: ${BRLCAD_MANIFOLD_LIBRARY}")
+ELSE(BRLCAD_MANIFOLD_LIBRARY AND BRLCAD_MANIFOLD_INCLUDE_DIR)
+    MESSAGE(STATUS "BRL-CAD's manifold library or headers not found, the mesh boolean backend is disabled")
+ENDIF(BRLCAD_MANIFOLD_LIBRARY AND BRLCAD_MANIFOLD_INCLUDE_DIR)
+
 # Lastly, we need to check for local installs in the BRL-CAD install of
 # libraries that might otherwise be present on the system - if they are
 # found in the BRL-CAD install tree, use those versions instead of any
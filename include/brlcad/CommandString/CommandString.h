@@ -35,6 +35,9 @@ struct ged;
 namespace BRLCAD {
     class BRLCAD_MOOSE_EXPORT CommandString {
     public:
+        /// the commands work on \a database
+        /** If the database keeps objects outside of it, e.g. a BRLCAD::MemoryDatabase with compressed bags of triangles,
+            the commands don't get the database and Results() explains it. */
         CommandString(Database& database);
         ~CommandString(void);
 
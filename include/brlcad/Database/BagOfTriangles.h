@@ -118,6 +118,28 @@ namespace BRLCAD {
         bool                  UseFloats(void) const;
         void                  SetUseFloats(bool useFloats);
 
+        /// computes smooth vertex normals and stores them as the normals of all faces
+        /** The normal of a face's corner is the sum of the normals of the faces sharing this vertex, weighted by their area and corner angle.
+            Only faces whose normals differ by at most \a creaseAngle (in radians) from the face at hand contribute, i.e. sharper edges become creases.
+            The former normals are replaced and FacesHaveNormals() and UseFaceNormals() are set. */
+        void                  ComputeVertexNormals(double creaseAngle);
+
+        /// sorts the faces along a Morton curve and renumbers the vertices and normals in order of their first use
+        /** This improves the memory locality of every later traversal of the triangles.
+            With \a optimizeVertexCache set the faces of spatially coherent clusters are additionally ordered for a post-transform vertex cache (Tipsify).
+            The geometry is not changed, but the face indices are. */
+        void                  Reorder(bool optimizeVertexCache);
+
+        /// reduces the number of faces by quadric error edge collapses
+        /** The decimation stops when at most \a targetFaces faces are left or no collapse is possible which keeps the vertices within \a maxError of the planes of the original faces they replace.
+            A negative \a maxError means no error bound.
+            The mesh is split into spatially coherent partitions which are decimated in parallel.
+            Vertices on partition borders, open or non-manifold edges and edges between faces of different thickness or mode are kept.
+            Therefore, more than \a targetFaces faces may remain, especially for small meshes with many partitions.
+            The vertex normals are removed as they don't fit to the moved vertices, ComputeVertexNormals() can be used to get new ones. */
+        void                  Decimate(size_t targetFaces,
+                                       double maxError);
+
         size_t                NumberOfFaces(void) const;
 
         Face                  GetFace(size_t index);
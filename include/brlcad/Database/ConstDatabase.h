@@ -33,11 +33,14 @@
 struct rt_i;
 struct resource;
 struct directory;
+struct rt_db_internal;
 class  CallBackHooks;
 
 
 namespace BRLCAD {
     class NonManifoldGeometry;
+    class BagOfTriangles;
+    class MappedBagOfTriangles;
 
 
     class BRLCAD_MOOSE_EXPORT ConstDatabase {
@@ -105,16 +108,155 @@ namespace BRLCAD {
         /// overloaded member function, provided for convenience: selects a single object and and returns a copy of it
         /** Do not forget to BRLCAD::Object::Destroy() the copy when you are finished with it! */
         Object*              Get(const char* objectName) const;
+
+        /// returns a read-only view on the bag of triangles \a objectName whose vertices and faces stay in the database
+        /** The returned object holds at most \a workingSetSize bytes of the vertex and face data in memory.
+            The function returns nullptr if the object isn't a bag of triangles, its body is compressed, or its geometry is kept outside of the database
+            (see BRLCAD::MemoryDatabase::CompressBagsOfTriangles()).
+            Do not forget to BRLCAD::MappedBagOfTriangles::Destroy() the view when you are finished with it! */
+        MappedBagOfTriangles* MapBagOfTriangles(const char* objectName,
+                                                size_t      workingSetSize) const;
         //@}
 
         /// @name Generating alternative representations
         /// facetizes a single object's tree and returns it as a non-manifold geometry
-        /** Do not forget to BRLCAD::Object::Destroy() the non-manifold geometry when you are finished with it! */
+        /** The solids are tessellated and the regions are evaluated and united in parallel only if ParallelNonManifoldGeometry() is set.
+            If the evaluation of a region or of a union fails the non-manifold geometry is empty, a part of the tree isn't left out silently.
+            Do not forget to BRLCAD::Object::Destroy() the non-manifold geometry when you are finished with it! */
         NonManifoldGeometry* Facetize(const char* objectName) const;
 
+        /// facetizes a single object's tree and returns it as an indexed triangle mesh
+        /** The triangles are generated directly from the result of the boolean evaluation without an intermediate non-manifold geometry object.
+            Do not forget to BRLCAD::Object::Destroy() the bag of triangles when you are finished with it! */
+        BagOfTriangles*      FacetizeToBot(const char* objectName) const;
+
+        /// tessellation tolerances of a level of detail, 0 disables a tolerance
+        struct FacetizeTolerance {
+            double absolute; ///< maximal distance between the surface and the facets
+            double relative; ///< maximal distance between the surface and the facets relative to the size of the solid
+            double normal;   ///< maximal angle between the surface normals in radians
+        };
+
+        /// facetizes a single object's tree once for each of the \a numberOfLevels tolerances in \a levels
+        /** The tree is walked and its solids are read only once for all levels.
+            Regions which consist of solids with planar faces only (e.g. arbs or bags of triangles) are evaluated once and copied to the other levels.
+            The boolean operations are evaluated by BooleanBackend::NonManifold.
+            \a results[i] gets the non-manifold geometry for \a levels[i].
+            Do not forget to BRLCAD::Object::Destroy() the non-manifold geometries when you are finished with them! */
+        void                 FacetizeLevelsOfDetail(const char*              objectName,
+                                                    size_t                   numberOfLevels,
+                                                    const FacetizeTolerance* levels,
+                                                    NonManifoldGeometry**    results) const;
+
+        /// file formats of ExportFacetization()
+        enum class MeshFormat {
+            BinaryStl,
+            BinaryPly,
+            Obj        ///< text, an object per region
+        };
+
+        /// destination of ExportFacetization(): writes \a size bytes of \a data at \a position
+        /** The data comes in ascending positions, except for the header which is rewritten with the same size at position 0 at the end.
+            \return false on failure, this cancels the export */
+        typedef std::function<bool(size_t      position,
+                                   const void* data,
+                                   size_t      size)> ExportSink;
+
+        /// facetizes the regions of a single object's tree and writes each of them to \a sink as soon as it is done
+        /** The regions are evaluated in batches, in parallel if ParallelNonManifoldGeometry() is set.
+            A solid is read from the database with the first batch which needs it and freed after the last one,
+            i.e. only the solids and facetizations of the current batches are held in memory.
+            The regions aren't united, and their boolean operations are evaluated by BooleanBackend::NonManifold.
+            \return false if writing or the evaluation of a region failed */
+        bool                 ExportFacetization(const char*       objectName,
+                                                MeshFormat        format,
+                                                const ExportSink& sink) const;
+
+        /// overloaded member function, provided for convenience: writes to the file \a fileName
+        bool                 ExportFacetization(const char* objectName,
+                                                MeshFormat  format,
+                                                const char* fileName) const;
+
+        /// evaluation of the boolean operations in Facetize() and FacetizeToBot()
+        enum class BooleanBackend {
+            NonManifold, ///< BRL-CAD's non-manifold geometry booleans
+            Manifold     ///< mesh booleans of the manifold library, falls back to NonManifold if a leaf doesn't give a closed mesh or the evaluation fails
+        };
+
+        BooleanBackend       FacetizeBooleanBackend(void) const;
+        /// \return false if \a backend isn't available in this build, the selection remains unchanged then
+        bool                 SetFacetizeBooleanBackend(BooleanBackend backend);
+
+        /// if the tessellation and the boolean evaluation with non-manifold geometry run in parallel threads
+        /** BRL-CAD's non-manifold geometry library isn't known to be reentrant, therefore it runs serially by default.
+            This concerns the facetization functions and PlotShaded().
+            Reading the database and the booleans of BooleanBackend::Manifold aren't affected. */
+        bool                 ParallelNonManifoldGeometry(void) const;
+        void                 SetParallelNonManifoldGeometry(bool parallel);
+
+        /// the distance below which the facetization considers points as equal
+        double               DistanceTolerance(void) const;
+
         /// plot a single object's tree and write the resulting wireframe to a vector list
+        /** The solids not in the plot cache are read in parallel, but their wireframes are generated serially with BRL-CAD's global list of free vector list chunks rt_vlfree.
+            The application must not use rt_vlfree in another thread meanwhile, this applies to the other Plot() too. */
         void                 Plot(const char* objectName,
                                   VectorList& vectorList) const;
+
+        /// plots the solids of a single object's tree which are in the view and at least \a pixelTolerance pixels large
+        /** \a viewMatrix maps the model coordinates to clip coordinates, i.e. the view is the cube [-1, 1]^3 after the perspective division.
+            The subtrees are culled by their bounding boxes before their solids are read.
+            A solid is read only once for its bounding box and its wireframe, and a combination's box is known from the plot after the one which has visited its members.
+            The bounding boxes are kept until a change of a member of the subtree is signalled.
+            Solids whose tessellation with the database's tolerances would be finer than \a pixelTolerance pixels get a coarser tolerance.
+            The result isn't stored in the facetization cache, but the wireframes of the solids are stored in the plot cache. */
+        void                 Plot(const char*  objectName,
+                                  const double viewMatrix[16],
+                                  size_t       viewportWidth,
+                                  size_t       viewportHeight,
+                                  double       pixelTolerance,
+                                  VectorList&  vectorList) const;
+
+        /// an indexed triangle mesh of a solid handed over by PlotShaded()
+        struct ShadedMesh {
+            const char*   solidName;
+            const double* matrix;            ///< 16 values, the accumulated transformation from the solid's coordinates to the ones of the object
+            bool          hasColor;          ///< the solid got a color from the combinations in the tree
+            double        red;
+            double        green;
+            double        blue;
+            size_t        numberOfVertices;
+            const double* vertices;          ///< 3 coordinates per vertex in the solid's coordinates
+            size_t        numberOfTriangles;
+            const size_t* triangles;         ///< 3 vertex indices per triangle, counterclockwise seen from the outside if the solid is oriented
+        };
+
+        /// tessellates the solids of a single object's tree for a shaded preview and hands their meshes over to \a callback
+        /** The boolean operations are not evaluated, the solids subtracted in the tree are left out.
+            Each solid is tessellated only once and handed over for every occurrence with the occurrence's transformation and color.
+            Bags of triangles are taken as they are, the other solids are tessellated with the database's tolerances, in parallel if ParallelNonManifoldGeometry() is set.
+            Solids which can't be tessellated are skipped.
+            The pointers in \a mesh are valid during the call of \a callback only. */
+        void                 PlotShaded(const char*                                         objectName,
+                                        const std::function<void(const ShadedMesh& mesh)>& callback) const;
+
+        /// keeps the results of Facetize(), FacetizeToBot() and Plot() for later calls with unchanged trees
+        /** The results are identified by the SHA-256 digest of the content of the object's tree and the tolerances.
+            They are held in memory up to \a memoryLimit bytes, and additionally in files in \a cacheDirectory if it isn't nullptr.
+            The directory can be shared with other database handles and program runs.
+            A file is ignored if its key or the digest of its content doesn't match, or if it doesn't contain a valid result.
+            The hashes of the trees are kept until a change of a member of the tree is signalled. */
+        void                 EnableFacetizationCache(const char* cacheDirectory,
+                                                     size_t      memoryLimit);
+        void                 DisableFacetizationCache(void);
+
+        /// keeps the wireframes of the solids plotted by Plot() for later calls with any tree which contains them
+        /** The wireframes are identified by the solid, its accumulated transformation matrix and the tolerances.
+            They are held in memory up to \a memoryLimit bytes, the least recently used ones are discarded first.
+            The wireframes of a solid are dropped when a change of it is signalled.
+            With the cache Plot() reads only the solids whose wireframes aren't in the cache. */
+        void                 EnablePlotCache(size_t memoryLimit);
+        void                 DisablePlotCache(void);
         //@}
 
         /// @name Active set functions
@@ -192,12 +334,52 @@ namespace BRLCAD {
         rt_i*     m_rtip;
         resource* m_resp;
 
+        /// suppresses the change signals while set, e.g. during internal modifications of the database
+        bool m_selfModification;
+
+        /// @name Hooks for derived classes which keep objects in an other form than the database
+        //@{
+        /// true if some objects are kept partly outside of the database, see KeptContent()
+        virtual bool KeepsContent(void) const;
+
+        /// the part of the object \a pDir which isn't in the database
+        /** The content identifies the object together with its external form, e.g. for the facetization cache.
+            \return false if the object is completely in the database */
+        virtual bool KeptContent(const directory* pDir,
+                                 const void*&     data,
+                                 size_t&          size) const;
+
+        /// completes \a intern, which was read from the database for \a pDir with \a matrix applied (nullptr for none)
+        /** The function must not modify the database, it may be called from several threads at the same time. */
+        virtual void CompleteInternal(const directory* pDir,
+                                      const double*    matrix,
+                                      rt_db_internal&  intern) const;
+
+        /// called before and after rt_gettree() reads the objects in the tree of \a objectName from the database
+        /** A derived class can write the objects in their full form to the database for the time of the call.
+            If KeepsContent() is true, Select() reads the tree one region at a time, and \a objectName is the path of the region then. */
+        virtual void BeginTreeAccess(const char* objectName);
+        virtual void EndTreeAccess(const char* objectName);
+        //@}
+
         void RegisterCoreCallbacks(void);
         void DeRegisterCoreCallbacks(void);
 
     private:
+        class FacetizationCache;
+        class PlotCache;
+        class BoundingBoxCache;
+
         ChangeSignalHandler** m_changeSignalHandlers;
         mutable bool          m_selfUpdateNref;
+        FacetizationCache*    m_facetizationCache;
+        PlotCache*            m_plotCache;
+        BoundingBoxCache*     m_boundingBoxCache;
+        BooleanBackend        m_booleanBackend;
+        bool                  m_parallelNmg;
+
+        /// CompleteInternal() as a function object for the helper functions of the implementation
+        std::function<void(const directory*, const double*, rt_db_internal&)> Completion(void) const;
 
         void GetInternal(directory*                                       pDir,
                          const std::function<void(const Object& object)>& callback) const;
@@ -208,6 +390,8 @@ namespace BRLCAD {
         void SignalChange(const char* objectName,
                           ChangeType  changeType) const;
 
+        void DeleteCaches(void);
+
         friend CallBackHooks;
 
         ConstDatabase(const ConstDatabase&);                  // not implemented
@@ -0,0 +1,141 @@
+/*                      M A P P E D B A G O F T R I A N G L E S . H
+ * BRL-CAD
+ *
+ * Copyright (c) 2026 United States Government as represented by
+ * the U.S. Army Research Laboratory.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this file; see the file named COPYING for more
+ * information.
+ */
+/** @file MappedBagOfTriangles.h
+ *
+ *  BRL-CAD core C++ interface:
+ *      declares a read-only, out-of-core view on a bag of triangles (ID_BOT) database object
+ */
+
+#ifndef BRLCAD_MAPPEDBAGOFTRIANGLES_INCLUDED
+#define BRLCAD_MAPPEDBAGOFTRIANGLES_INCLUDED
+
+#include <functional>
+
+#include <brlcad/vector.h>
+#include <brlcad/Database/BagOfTriangles.h>
+
+
+struct directory;
+struct db_i;
+
+
+namespace BRLCAD {
+    /// read-only view on the vertices and faces of a bag of triangles which stay in the database
+    /** The vertex and face arrays are read page-wise from the database on demand and kept in a cache of limited size.
+        Therefore, the memory consumption is bounded even for objects which do not fit into the main memory once decoded.
+        The coordinates are the ones stored in the database object, i.e. without any transformation.
+        The view reflects the object at the time of its creation and becomes invalid if the object is modified.
+        A page which can't be read isn't handed out as geometry: the bulk functions and ShootRay() report the failure,
+        Vertex() returns the origin and Face::VertexIndex() returns NumberOfVertices() then, and ReadFailed() gets set.
+        It is thread safe. */
+    class BRLCAD_MOOSE_EXPORT MappedBagOfTriangles {
+    public:
+        ~MappedBagOfTriangles(void);
+
+        /// the destructor which keeps the memory management in a healthy state
+        void                           Destroy(void);
+
+        class BRLCAD_MOOSE_EXPORT Face {
+        public:
+            Face(void) : m_bot(nullptr), m_faceIndex(0) {}
+            Face(const Face& original) : m_bot(original.m_bot), m_faceIndex(original.m_faceIndex) {}
+            ~Face(void) {}
+
+            const Face& operator=(const Face& original) {
+                m_bot       = original.m_bot;
+                m_faceIndex = original.m_faceIndex;
+
+                return *this;
+            }
+
+            size_t      VertexIndex(size_t index) const;
+            Vector3D    Point(size_t index) const;
+
+        private:
+            const MappedBagOfTriangles* m_bot;
+            size_t                      m_faceIndex;
+
+            Face(const MappedBagOfTriangles* bot,
+                 size_t                      faceIndex) : m_bot(bot), m_faceIndex(faceIndex) {}
+
+            friend MappedBagOfTriangles;
+        };
+
+        BagOfTriangles::BotMode        Mode(void) const;
+        BagOfTriangles::BotOrientation Orientation(void) const;
+
+        size_t                         NumberOfVertices(void) const;
+        size_t                         NumberOfFaces(void) const;
+
+        Face                           GetFace(size_t index) const;
+        Vector3D                       Vertex(size_t index) const;
+
+        /// @name Bulk access
+        //@{
+        /// copies the coordinates of \a count vertices starting with \a firstVertex to \a coordinates
+        /** \a coordinates has to provide space for 3 * \a count values.
+            \return the number of copied vertices, less than requested if a page can't be read */
+        size_t                         GetVertices(size_t  firstVertex,
+                                                   size_t  count,
+                                                   double* coordinates) const;
+
+        /// copies the vertex indices of \a count faces starting with \a firstFace to \a vertexIndices
+        /** \a vertexIndices has to provide space for 3 * \a count values.
+            \return the number of copied faces, less than requested if a page can't be read */
+        size_t                         GetFaces(size_t  firstFace,
+                                                size_t  count,
+                                                size_t* vertexIndices) const;
+        //@}
+
+        /// intersects \a ray with the faces and hands the hits over to \a callback sorted by their distance
+        /** The face pages are intersected in the order of the ray's entry into their bounding boxes,
+            and the traversal stops as soon as the callback returns false.
+            On the first call the bounding boxes of the face pages will be computed, which needs one pass over the whole object.
+            \return false if a page can't be read, the traversal is cancelled then */
+        bool                           ShootRay(const Ray3D&                                                   ray,
+                                                const std::function<bool(size_t faceIndex, double distance)>& callback) const;
+
+        /// a page of the object couldn't be read since the creation of the view
+        bool                           ReadFailed(void) const;
+
+        /// maximal number of bytes held in the page cache
+        size_t                         WorkingSetSize(void) const;
+        void                           SetWorkingSetSize(size_t workingSetSize);
+
+    private:
+        class Pages;
+
+        Pages* m_pages;
+
+        MappedBagOfTriangles(Pages* pages);
+
+        static MappedBagOfTriangles* Create(db_i*      dbip,
+                                            directory* pDir,
+                                            size_t     workingSetSize);
+
+        friend class ConstDatabase;
+
+        MappedBagOfTriangles(const MappedBagOfTriangles&);                  // not implemented
+        const MappedBagOfTriangles& operator=(const MappedBagOfTriangles&); // not implemented
+    };
+}
+
+
+#endif // BRLCAD_MAPPEDBAGOFTRIANGLES_INCLUDED
@@ -44,7 +44,45 @@ namespace BRLCAD {
                   size_t      dataSize);
         bool Save(const char* fileName);
 
+        /// @name Compressed storage of bags of triangles
+        //@{
+        /// keeps the geometry of the bags of triangles in a compressed form
+        /** The vertices are quantized in their bounding box with a maximal deviation of \a maxError per coordinate,
+            the normals with 16 bit per coordinate, and the face and normal indices are delta and variable-length coded.
+            If \a maxError isn't positive the vertices and normals are kept verbatim, i.e. the compression is lossless.
+            In the database the objects are replaced by placeholders without geometry but with their properties and attributes.
+            The functions of this class, e.g. Get(), Facetize(), Plot() and PlotShaded(), decode the geometry into their own copies of the objects
+            and leave the database unchanged.
+            Select() and Save() have to read the objects from the database and write them in their full form there for the time of the call.
+            Select() reads the selected tree one region at a time, therefore only the compressed bags of triangles of one region are decoded
+            at the same time before they are prepared for raytracing.
+            MapBagOfTriangles() returns nullptr for a compressed bag of triangles.
+            The function does nothing if an other handle, e.g. a CommandString, uses the database,
+            and a CommandString which is created later doesn't get the database, call DecompressBagsOfTriangles() before.
+            Bags of triangles which are added or overwritten later are stored uncompressed until the next call of this function.
+            \return the number of newly compressed objects */
+        size_t CompressBagsOfTriangles(double maxError);
+
+        /// restores the full geometry of all compressed bags of triangles in the database
+        void   DecompressBagsOfTriangles(void);
+        //@}
+
+    protected:
+        bool KeepsContent(void) const override;
+        bool KeptContent(const directory* pDir,
+                         const void*&     data,
+                         size_t&          size) const override;
+        void CompleteInternal(const directory* pDir,
+                              const double*    matrix,
+                              rt_db_internal&  intern) const override;
+        void BeginTreeAccess(const char* objectName) override;
+        void EndTreeAccess(const char* objectName) override;
+
     private:
+        class BotStore;
+
+        BotStore* m_botStore;
+
         MemoryDatabase(const MemoryDatabase&);                  // not implemented
         const MemoryDatabase& operator=(const MemoryDatabase&); // not implemented
     };
@@ -303,6 +303,51 @@ namespace BRLCAD {
         };
 
 
+        /// the faces of a non-manifold geometry flattened into contiguous arrays
+        /** It will be filled by NonManifoldGeometry::Flatten().
+            Only faces are taken, i.e. wire edges and loops outside of faces are omitted. */
+        class BRLCAD_MOOSE_EXPORT IndexedFaces {
+        public:
+            IndexedFaces(void);
+            ~IndexedFaces(void);
+
+            size_t               NumberOfVertices(void) const;
+            /// 3 * NumberOfVertices() coordinates of the vertices, every vertex of the geometry is contained once
+            const double*        Vertices(void) const;
+
+            size_t               NumberOfLoops(void) const;
+            /// NumberOfLoops() + 1 offsets in LoopVertices(), loop i consists of the vertices at [LoopOffsets()[i], LoopOffsets()[i + 1])
+            const size_t*        LoopOffsets(void) const;
+            const size_t*        LoopVertices(void) const;
+            /// per loop: 1 if it is a hole in its face, 0 otherwise
+            const unsigned char* LoopIsHole(void) const;
+
+            size_t               NumberOfFaces(void) const;
+            /// NumberOfFaces() + 1 offsets in the loops, face i consists of the loops [FaceLoopOffsets()[i], FaceLoopOffsets()[i + 1])
+            const size_t*        FaceLoopOffsets(void) const;
+            /// 3 * NumberOfFaces() coordinates of the outward pointing face normals
+            const double*        FaceNormals(void) const;
+            /// per face: the index of its shell
+            const size_t*        FaceShells(void) const;
+
+            size_t               NumberOfShells(void) const;
+            /// per shell: the index of its region
+            const size_t*        ShellRegions(void) const;
+
+            size_t               NumberOfRegions(void) const;
+
+        private:
+            class Arrays;
+
+            Arrays* m_arrays;
+
+            friend class NonManifoldGeometry;
+
+            IndexedFaces(const IndexedFaces&);                  // not implemented
+            const IndexedFaces& operator=(const IndexedFaces&); // not implemented
+        };
+
+
         // Basic Operations
         /*
         Region       MakeRegion(void); // 0
@@ -349,10 +394,44 @@ namespace BRLCAD {
         Loop         MakeEdgeKillLoop(Vetrex& firstVertexToConnect,
                                       Vertex& secondVertexToConnect);
         */
+        // Bulk construction
+        /// adds a region with one shell which consists of the polygons of an indexed face set
+        /** \a vertices contains 3 * \a numberOfVertices coordinates.
+            Polygon i consists of the vertices with the indices at [\a polygonOffsets[i], \a polygonOffsets[i + 1]) in \a polygonVertices,
+            i.e. \a polygonOffsets has \a numberOfPolygons + 1 entries.
+            The vertices of a polygon have to be in counter-clockwise order seen from the outside.
+            Polygons sharing vertices or edges are connected, degenerated polygons are skipped.
+            \return false if an index is out of range, if all polygons are degenerated or if the construction failed, the geometry remains unchanged then */
+        bool         AddPolygons(size_t        numberOfVertices,
+                                 const double* vertices,
+                                 size_t        numberOfPolygons,
+                                 const size_t* polygonOffsets,
+                                 const size_t* polygonVertices);
+
+        /// splits the faces into triangles with a distance tolerance of 0.0005, by BRL-CAD's serial in place triangulation
         void         Triangulate(void);
         void         Triangulate(Shell& shellToTrinagulate);
         void         Triangulate(Face& faceToTrinagulate);
 
+        /// splits the faces into triangles, \a distanceTolerance is the distance below which points are considered equal
+        /** E.g. ConstDatabase::DistanceTolerance() gives the tolerance of a database.
+            The faces are triangulated serially in place. */
+        void         Triangulate(double distanceTolerance);
+        void         Triangulate(Shell& shellToTrinagulate,
+                                 double distanceTolerance);
+        void         Triangulate(Face&  faceToTrinagulate,
+                                 double distanceTolerance);
+
+        /// as above, if \a parallel is set the faces are triangulated in parallel threads
+        /** The triangles are computed on copies of the faces and applied afterwards if they give a valid geometry, otherwise the faces are triangulated in place.
+            BRL-CAD's non-manifold geometry library isn't known to be reentrant, see ConstDatabase::SetParallelNonManifoldGeometry().
+            Therefore \a parallel should only be set if no other thread uses it meanwhile. */
+        void         Triangulate(double distanceTolerance,
+                                 bool   parallel);
+        void         Triangulate(Shell& shellToTrinagulate,
+                                 double distanceTolerance,
+                                 bool   parallel);
+
         // Destruction Operations
         /*
         void         KillRegion(Region& regionToRemove);
@@ -376,6 +455,18 @@ namespace BRLCAD {
         // iterate over the regions
         RegionIterator             Regions(void) const;
 
+        /// copies the faces in one pass to \a indexedFaces, replacing its previous content
+        /** If \a triangulated is set, a triangulated copy of the geometry is flattened, i.e. every loop is a triangle and there are no holes.
+            The copy is triangulated with a distance tolerance of 0.0005. */
+        void                       Flatten(IndexedFaces& indexedFaces,
+                                           bool          triangulated) const;
+        /// as above, \a distanceTolerance is the distance below which points are considered equal while triangulating the copy
+        /** E.g. ConstDatabase::DistanceTolerance() gives the tolerance of a database.
+            \a indexedFaces is empty if the triangulation failed. */
+        void                       Flatten(IndexedFaces& indexedFaces,
+                                           bool          triangulated,
+                                           double        distanceTolerance) const;
+
         // inherited from BRLCAD::Object
         const Object&              operator=(const Object& original) override;
         Object*                    Clone(void) const override;
@@ -468,17 +468,291 @@ namespace BRLCAD {
             friend class VectorList;
         };
 
+        /// the elements of a vector list copied to contiguous arrays
+        /** It will be filled by VectorList::Export(). */
+        class BRLCAD_MOOSE_EXPORT ElementArrays {
+        public:
+            ElementArrays(void);
+            ~ElementArrays(void);
+
+            size_t                      NumberOfElements(void) const;
+            const Element::ElementType* ElementTypes(void) const;
+            /// 3 * NumberOfElements() values: the point or normal of the element, the size or width in the first value of PointSize and LineWidth
+            const double*               Values(void) const;
+
+        private:
+            class Arrays;
+
+            Arrays* m_arrays;
+
+            friend class VectorList;
+
+            ElementArrays(const ElementArrays&);                  // not implemented
+            const ElementArrays& operator=(const ElementArrays&); // not implemented
+        };
+
+        /// the points, line segments and triangles of a vector list as index buffers on shared vertices
+        /** It will be filled by VectorList::Export().
+            Polygons are split into triangle fans, elements in display space, normals, sizes and widths are omitted. */
+        class BRLCAD_MOOSE_EXPORT IndexedPrimitives {
+        public:
+            IndexedPrimitives(void);
+            ~IndexedPrimitives(void);
+
+            size_t        NumberOfVertices(void) const;
+            /// 3 * NumberOfVertices() coordinates, every distinct point of the vector list is contained once
+            const double* Vertices(void) const;
+
+            size_t        NumberOfPoints(void) const;
+            const size_t* PointIndices(void) const;
+
+            size_t        NumberOfLines(void) const;
+            /// 2 * NumberOfLines() vertex indices
+            const size_t* LineIndices(void) const;
+
+            size_t        NumberOfTriangles(void) const;
+            /// 3 * NumberOfTriangles() vertex indices
+            const size_t* TriangleIndices(void) const;
+
+        private:
+            class Arrays;
+
+            Arrays* m_arrays;
+
+            friend class VectorList;
+
+            IndexedPrimitives(const IndexedPrimitives&);                  // not implemented
+            const IndexedPrimitives& operator=(const IndexedPrimitives&); // not implemented
+        };
+
+        /// read-only view on a file written by VectorList::Save(), the file is mapped into memory
+        class BRLCAD_MOOSE_EXPORT MappedView {
+        public:
+            MappedView(void);
+            ~MappedView(void);
+
+            /// maps \a fileName, a previously mapped file will be released
+            /** The commands of all elements are checked while opening.
+                \return false if the file can't be mapped or isn't a valid vector list file */
+            bool              Open(const char* fileName);
+            void              Close(void);
+
+            size_t            NumberOfElements(void) const;
+            /// decodes the elements directly from the mapped file, the elements aren't modifiable
+            void              Iterate(const std::function<bool(const Element* element)>& callback) const;
+
+        private:
+            class Mapping;
+
+            Mapping* m_mapping;
+
+            friend class VectorList;
+
+            MappedView(const MappedView&);                  // not implemented
+            const MappedView& operator=(const MappedView&); // not implemented
+        };
+
+        /// representation of the coordinates in the files written by Save()
+        enum class CoordinateFormat {
+            Double,
+            Float,
+            Quantized16 ///< 16 bit integers, the points relative to their bounding box, the normals relative to [-1, 1], point sizes, line widths and display points as doubles
+        };
+
+        /// writes the elements to \a fileName in a compact binary form in the byte order of the machine
+        /** The file consists of a header, a byte per element with its command and the coordinates in \a coordinateFormat.
+            \return false if the file can't be written */
+        bool              Save(const char*      fileName,
+                               CoordinateFormat coordinateFormat) const;
+        /// overloaded member function, provided for convenience: writes the coordinates as doubles
+        bool              Save(const char* fileName) const;
+
+        /// replaces the elements by the ones in \a fileName, written by Save()
+        /** \return false if the file can't be read, the vector list is unchanged then */
+        bool              Load(const char* fileName);
+
+        /// copies the elements in one pass to \a elementArrays, replacing its previous content
+        void              Export(ElementArrays& elementArrays) const;
+        /// converts the elements in one pass to \a indexedPrimitives, replacing its previous content
+        void              Export(IndexedPrimitives& indexedPrimitives) const;
+
         void              Iterate(const std::function<bool(const Element* element)>& callback) const;
         void              Iterate(const std::function<bool(Element* element)>& callback);
 
+        /// calls the member function of \a visitor named after the element type for each element
+        /** This is an inlineable alternative to Iterate() which doesn't create Element objects.
+            The visitor has to provide
+            - bool PointDraw(const double* point), LineMove(const double* point), LineDraw(const double* point),
+              TriangleMove(const double* point), TriangleDraw(const double* point), TriangleEnd(const double* point),
+              PolygonMove(const double* point), PolygonDraw(const double* point), PolygonEnd(const double* point),
+            - bool TriangleStart(const double* normal), TriangleVertexNormal(const double* normal),
+              PolygonStart(const double* normal), PolygonVertexNormal(const double* normal),
+            - bool PointSize(double size), LineWidth(double width),
+            - bool DisplaySpace(const double* referencePoint) and ModelSpace(void).
+
+            The pointers point to 3 coordinates in the vector list and are valid during the call only.
+            The iteration stops if a member function returns false. */
+        template<typename Visitor>
+        void              Visit(Visitor& visitor) const;
+
         bool              Append(const Element& element);
+
+        /// @name Bulk append
+        //@{
+        /// appends a PointDraw element for each of the \a numberOfPoints points in \a points (3 coordinates per point)
+        bool              AppendPoints(size_t        numberOfPoints,
+                                       const double* points);
+        /// appends a LineMove to the first and LineDraw elements to the following of the \a numberOfPoints points in \a points
+        bool              AppendPolyline(size_t        numberOfPoints,
+                                         const double* points);
+        /// appends the \a numberOfTriangles triangles with the 9 coordinates per triangle in \a vertices
+        /** Each triangle gets a TriangleStart element with its normal, which follows from the vertex order counter-clockwise. */
+        bool              AppendTriangles(size_t        numberOfTriangles,
+                                          const double* vertices);
+        //@}
+
+        /// removes the points of the polylines which deviate less than \a tolerance from the remaining ones
+        /** The polylines, i.e. sequences of LineMove and LineDraw elements in model space, are simplified by the Douglas-Peucker algorithm in parallel.
+            Their first and last points and all other elements are kept. */
+        void              Simplify(double tolerance);
+
+        /// removes all elements, their memory is kept for the following appends
         void              Clear(void);
 
+        /// @name Memory management
+        /** Every vector list takes its chunks from a pool of its own.
+            Therefore, different vector lists can be filled concurrently. */
+        //@{
+        /// ensures that \a numberOfElements elements can be appended without a further allocation
+        void              Reserve(size_t numberOfElements);
+        /// releases the memory of the chunks which aren't in use, e.g. after Clear()
+        void              FreeUnusedMemory(void);
+        //@}
+
     private:
         bu_list* m_vlist;
+        bu_list* m_freeChunks; ///< the pool of chunks for m_vlist
+
+        /// the BV_VLIST_* command codes, used by Visit()
+        enum class Command : int {
+            LineMove             = 0,
+            LineDraw             = 1,
+            PolygonStart         = 2,
+            PolygonMove          = 3,
+            PolygonDraw          = 4,
+            PolygonEnd           = 5,
+            PolygonVertexNormal  = 6,
+            TriangleStart        = 7,
+            TriangleMove         = 8,
+            TriangleDraw         = 9,
+            TriangleEnd          = 10,
+            TriangleVertexNormal = 11,
+            PointDraw            = 12,
+            PointSize            = 13,
+            LineWidth            = 14,
+            DisplaySpace         = 15,
+            ModelSpace           = 16
+        };
+
+        /// the chunk following \a chunk, the first one for nullptr
+        /** \return nullptr after the last chunk */
+        const bv_vlist*   NextChunk(const bv_vlist* chunk) const;
+        /// the command codes and 3 * the number of elements coordinates of \a chunk
+        /** \return the number of elements in \a chunk */
+        static size_t     ChunkElements(const bv_vlist* chunk,
+                                        const int*&     commands,
+                                        const double*&  points);
 
         friend class ConstDatabase;
     };
+
+
+    template<typename Visitor>
+    void VectorList::Visit
+    (
+        Visitor& visitor
+    ) const {
+        bool cont = true;
+
+        for (const bv_vlist* chunk = NextChunk(nullptr); cont && (chunk != nullptr); chunk = NextChunk(chunk)) {
+            const int*    commands;
+            const double* points;
+            size_t        numberOfElements = ChunkElements(chunk, commands, points);
+
+            for (size_t i = 0; cont && (i < numberOfElements); ++i) {
+                const double* point = points + 3 * i;
+
+                switch (static_cast<Command>(commands[i])) {
+                    case Command::LineMove:
+                        cont = visitor.LineMove(point);
+                        break;
+
+                    case Command::LineDraw:
+                        cont = visitor.LineDraw(point);
+                        break;
+
+                    case Command::PolygonStart:
+                        cont = visitor.PolygonStart(point);
+                        break;
+
+                    case Command::PolygonMove:
+                        cont = visitor.PolygonMove(point);
+                        break;
+
+                    case Command::PolygonDraw:
+                        cont = visitor.PolygonDraw(point);
+                        break;
+
+                    case Command::PolygonEnd:
+                        cont = visitor.PolygonEnd(point);
+                        break;
+
+                    case Command::PolygonVertexNormal:
+                        cont = visitor.PolygonVertexNormal(point);
+                        break;
+
+                    case Command::TriangleStart:
+                        cont = visitor.TriangleStart(point);
+                        break;
+
+                    case Command::TriangleMove:
+                        cont = visitor.TriangleMove(point);
+                        break;
+
+                    case Command::TriangleDraw:
+                        cont = visitor.TriangleDraw(point);
+                        break;
+
+                    case Command::TriangleEnd:
+                        cont = visitor.TriangleEnd(point);
+                        break;
+
+                    case Command::TriangleVertexNormal:
+                        cont = visitor.TriangleVertexNormal(point);
+                        break;
+
+                    case Command::PointDraw:
+                        cont = visitor.PointDraw(point);
+                        break;
+
+                    case Command::PointSize:
+                        cont = visitor.PointSize(point[0]);
+                        break;
+
+                    case Command::LineWidth:
+                        cont = visitor.LineWidth(point[0]);
+                        break;
+
+                    case Command::DisplaySpace:
+                        cont = visitor.DisplaySpace(point);
+                        break;
+
+                    case Command::ModelSpace:
+                        cont = visitor.ModelSpace();
+                }
+            }
+        }
+    }
 };
 
 
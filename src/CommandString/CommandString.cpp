@@ -56,10 +56,15 @@ CommandString::CommandString
         if (!BU_SETJUMP) {
             ged_init((m_ged));
 
-            if (database.m_wdbp != nullptr)
+            // the commands read the database directly, they would miss the objects which are kept outside of it
+            if ((database.m_wdbp != nullptr) && !database.KeepsContent())
                 m_ged->dbip = db_clone_dbi(database.m_wdbp->dbip, nullptr);
-            else
+            else {
                 m_ged->dbip = nullptr;
+
+                if (database.m_wdbp != nullptr)
+                    bu_vls_printf(m_ged->ged_result_str, "The database keeps objects outside of it, e.g. compressed bags of triangles, and can't be used by the commands.\n");
+            }
         }
         else {
             BU_UNSETJUMP;
@@ -25,6 +25,11 @@
 
 #include <cstring>
 #include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+#include <queue>
 
 #include "raytrace.h"
 #include "rt/geom.h"
@@ -237,6 +242,1207 @@ static void EnsureFaceNormals
 }
 
 
+static void SmoothNormals
+(
+    rt_bot_internal& bot,
+    double           creaseAngle
+) {
+    size_t numberOfFaces    = bot.num_faces;
+    size_t numberOfVertices = bot.num_vertices;
+    double orientation      = (bot.orientation == RT_BOT_CW) ? -1. : 1.;
+    double minimumCosine    = cos(creaseAngle);
+
+    // per face: unit normal, per corner: area and angle weighted normal
+    std::vector<double> faceNormals(3 * numberOfFaces);
+    std::vector<double> cornerWeights(9 * numberOfFaces);
+
+    ParallelFor(numberOfFaces, 4096, [&bot, &faceNormals, &cornerWeights, orientation](size_t begin, size_t end, size_t) {
+        for (size_t face = begin; face < end; ++face) {
+            const fastf_t* corners[3] = {bot.vertices + 3 * bot.faces[3 * face],
+                                         bot.vertices + 3 * bot.faces[3 * face + 1],
+                                         bot.vertices + 3 * bot.faces[3 * face + 2]};
+            vect_t         edge1;
+            vect_t         edge2;
+            vect_t         normal;
+
+            VSUB2(edge1, corners[1], corners[0]);
+            VSUB2(edge2, corners[2], corners[0]);
+            VCROSS(normal, edge1, edge2);
+            VSCALE(normal, normal, orientation);
+
+            double length = MAGNITUDE(normal);
+
+            if (length > SMALL_FASTF)
+                VSCALE(faceNormals.data() + 3 * face, normal, 1. / length);
+            else
+                VSETALL(faceNormals.data() + 3 * face, 0.);
+
+            for (size_t corner = 0; corner < 3; ++corner) {
+                vect_t toNext;
+                vect_t toPrevious;
+                vect_t sine;
+
+                VSUB2(toNext, corners[(corner + 1) % 3], corners[corner]);
+                VSUB2(toPrevious, corners[(corner + 2) % 3], corners[corner]);
+                VCROSS(sine, toNext, toPrevious);
+
+                double angle = atan2(MAGNITUDE(sine), VDOT(toNext, toPrevious));
+
+                // the magnitude of normal is twice the area of the face
+                VSCALE(cornerWeights.data() + 9 * face + 3 * corner, normal, angle);
+            }
+        }
+    });
+
+    // vertex to corner adjacency
+    std::vector<size_t> vertexCornersBegin(numberOfVertices + 1, 0);
+    std::vector<size_t> vertexCorners(3 * numberOfFaces);
+
+    for (size_t i = 0; i < 3 * numberOfFaces; ++i)
+        ++vertexCornersBegin[bot.faces[i] + 1];
+
+    for (size_t i = 0; i < numberOfVertices; ++i)
+        vertexCornersBegin[i + 1] += vertexCornersBegin[i];
+
+    {
+        std::vector<size_t> fill(vertexCornersBegin.begin(), vertexCornersBegin.end() - 1);
+
+        for (size_t i = 0; i < 3 * numberOfFaces; ++i)
+            vertexCorners[fill[bot.faces[i]]++] = i;
+    }
+
+    // per corner: its smoothed normal and the first corner of the same vertex with an equal normal
+    std::vector<double> cornerNormals(9 * numberOfFaces);
+    std::vector<size_t> cornerRepresentative(3 * numberOfFaces);
+    std::vector<size_t> vertexNormalsBegin(numberOfVertices + 1, 0);
+
+    ParallelFor(numberOfVertices, 4096, [&](size_t begin, size_t end, size_t) {
+        for (size_t vertex = begin; vertex < end; ++vertex) {
+            size_t distinctNormals = 0;
+
+            for (size_t i = vertexCornersBegin[vertex]; i < vertexCornersBegin[vertex + 1]; ++i) {
+                size_t        corner     = vertexCorners[i];
+                const double* faceNormal = faceNormals.data() + 3 * (corner / 3);
+                double*       normal     = cornerNormals.data() + 3 * corner;
+
+                VSETALL(normal, 0.);
+
+                for (size_t j = vertexCornersBegin[vertex]; j < vertexCornersBegin[vertex + 1]; ++j) {
+                    size_t other = vertexCorners[j];
+
+                    if ((other == corner) || (VDOT(faceNormal, faceNormals.data() + 3 * (other / 3)) >= minimumCosine))
+                        VADD2(normal, normal, cornerWeights.data() + 3 * other);
+                }
+
+                double length = MAGNITUDE(normal);
+
+                if (length > SMALL_FASTF)
+                    VSCALE(normal, normal, 1. / length);
+                else
+                    VMOVE(normal, faceNormal);
+
+                cornerRepresentative[corner] = corner;
+
+                for (size_t j = vertexCornersBegin[vertex]; j < i; ++j) {
+                    size_t other = vertexCorners[j];
+
+                    if ((cornerRepresentative[other] == other) && VNEAR_EQUAL(normal, cornerNormals.data() + 3 * other, VUNITIZE_TOL)) {
+                        cornerRepresentative[corner] = other;
+                        break;
+                    }
+                }
+
+                if (cornerRepresentative[corner] == corner)
+                    ++distinctNormals;
+            }
+
+            vertexNormalsBegin[vertex + 1] = distinctNormals;
+        }
+    });
+
+    for (size_t i = 0; i < numberOfVertices; ++i)
+        vertexNormalsBegin[i + 1] += vertexNormalsBegin[i];
+
+    size_t   numberOfNormals   = vertexNormalsBegin[numberOfVertices];
+    fastf_t* normals           = static_cast<fastf_t*>(bu_malloc(3 * std::max(numberOfNormals, size_t(1)) * sizeof(fastf_t), "bot interface SmoothNormals(): normals"));
+    int*     faceNormalIndices = static_cast<int*>(bu_malloc(3 * std::max(numberOfFaces, size_t(1)) * sizeof(int), "bot interface SmoothNormals(): face_normals"));
+
+    ParallelFor(numberOfVertices, 4096, [&](size_t begin, size_t end, size_t) {
+        for (size_t vertex = begin; vertex < end; ++vertex) {
+            size_t normalIndex = vertexNormalsBegin[vertex];
+
+            for (size_t i = vertexCornersBegin[vertex]; i < vertexCornersBegin[vertex + 1]; ++i) {
+                size_t corner = vertexCorners[i];
+
+                if (cornerRepresentative[corner] == corner) {
+                    VMOVE(normals + 3 * normalIndex, cornerNormals.data() + 3 * corner);
+                    faceNormalIndices[corner] = static_cast<int>(normalIndex);
+                    ++normalIndex;
+                }
+            }
+
+            // the representatives got their indices in the first pass
+            for (size_t i = vertexCornersBegin[vertex]; i < vertexCornersBegin[vertex + 1]; ++i) {
+                size_t corner = vertexCorners[i];
+
+                if (cornerRepresentative[corner] != corner)
+                    faceNormalIndices[corner] = faceNormalIndices[cornerRepresentative[corner]];
+            }
+        }
+    });
+
+    if (bot.normals != nullptr)
+        bu_free(bot.normals, "bot interface SmoothNormals(): normals");
+
+    if (bot.face_normals != nullptr)
+        bu_free(bot.face_normals, "bot interface SmoothNormals(): face_normals");
+
+    bot.normals          = normals;
+    bot.num_normals      = numberOfNormals;
+    bot.face_normals     = faceNormalIndices;
+    bot.num_face_normals = numberOfFaces;
+    bot.bot_flags       |= RT_BOT_HAS_SURFACE_NORMALS | RT_BOT_USE_NORMALS;
+}
+
+
+static uint64_t SpreadBits
+(
+    uint64_t value
+) {
+    value &= 0x1fffff;
+    value  = (value | (value << 32)) & 0x1f00000000ffffULL;
+    value  = (value | (value << 16)) & 0x1f0000ff0000ffULL;
+    value  = (value | (value << 8))  & 0x100f00f00f00f00fULL;
+    value  = (value | (value << 4))  & 0x10c30c30c30c30c3ULL;
+    value  = (value | (value << 2))  & 0x1249249249249249ULL;
+
+    return value;
+}
+
+
+/// face indices sorted along the Morton curve of the face centroids
+static std::vector<size_t> MortonOrder
+(
+    const rt_bot_internal& bot
+) {
+    size_t              numberOfFaces = bot.num_faces;
+    std::vector<size_t> ret(numberOfFaces);
+
+    if (numberOfFaces == 0)
+        return ret;
+
+    point_t minimum;
+    point_t maximum;
+
+    VSETALL(minimum, INFINITY);
+    VSETALL(maximum, -INFINITY);
+
+    for (size_t i = 0; i < bot.num_vertices; ++i)
+        VMINMAX(minimum, maximum, bot.vertices + 3 * i);
+
+    vect_t scale;
+
+    for (size_t i = 0; i < 3; ++i) {
+        double extent = maximum[i] - minimum[i];
+
+        scale[i] = (extent > SMALL_FASTF) ? (double(0x1fffff) / extent) : 0.;
+    }
+
+    std::vector<std::pair<uint64_t, size_t> > codes(numberOfFaces);
+
+    ParallelFor(numberOfFaces, 4096, [&bot, &codes, &minimum, &scale](size_t begin, size_t end, size_t) {
+        for (size_t face = begin; face < end; ++face) {
+            point_t centroid;
+
+            VADD3(centroid, bot.vertices + 3 * bot.faces[3 * face], bot.vertices + 3 * bot.faces[3 * face + 1], bot.vertices + 3 * bot.faces[3 * face + 2]);
+            VSCALE(centroid, centroid, 1. / 3.);
+
+            uint64_t code = 0;
+
+            for (size_t i = 0; i < 3; ++i) {
+                double cell = (centroid[i] - minimum[i]) * scale[i];
+
+                code |= SpreadBits(static_cast<uint64_t>(std::max(0., std::min(cell, double(0x1fffff))))) << (2 - i);
+            }
+
+            codes[face] = std::make_pair(code, face);
+        }
+    });
+
+    // sort chunks in parallel and merge them pairwise
+    size_t chunks    = ParallelThreads(numberOfFaces, 65536);
+    size_t chunkSize = (numberOfFaces + chunks - 1) / chunks;
+
+    ParallelFor(chunks, 1, [&codes, numberOfFaces, chunkSize](size_t begin, size_t end, size_t) {
+        for (size_t chunk = begin; chunk < end; ++chunk)
+            std::sort(codes.begin() + std::min(chunk * chunkSize, numberOfFaces), codes.begin() + std::min((chunk + 1) * chunkSize, numberOfFaces));
+    });
+
+    for (size_t width = chunkSize; width < numberOfFaces; width *= 2) {
+        ParallelFor((numberOfFaces + 2 * width - 1) / (2 * width), 1, [&codes, numberOfFaces, width](size_t begin, size_t end, size_t) {
+            for (size_t pair = begin; pair < end; ++pair) {
+                size_t first  = 2 * width * pair;
+                size_t middle = std::min(first + width, numberOfFaces);
+                size_t last   = std::min(first + 2 * width, numberOfFaces);
+
+                std::inplace_merge(codes.begin() + first, codes.begin() + middle, codes.begin() + last);
+            }
+        });
+    }
+
+    ParallelFor(numberOfFaces, 65536, [&codes, &ret](size_t begin, size_t end, size_t) {
+        for (size_t i = begin; i < end; ++i)
+            ret[i] = codes[i].second;
+    });
+
+    return ret;
+}
+
+
+/// reorders the faces in [begin, end) of \a faceOrder for a vertex cache of \a cacheSize entries (Tipsify)
+static void OptimizeVertexCache
+(
+    const rt_bot_internal& bot,
+    size_t*                begin,
+    size_t*                end,
+    size_t                 cacheSize
+) {
+    size_t              numberOfFaces = end - begin;
+    std::vector<size_t> faces(begin, end);
+    std::vector<int>    vertices(3 * numberOfFaces);
+
+    for (size_t i = 0; i < numberOfFaces; ++i) {
+        vertices[3 * i]     = bot.faces[3 * faces[i]];
+        vertices[3 * i + 1] = bot.faces[3 * faces[i] + 1];
+        vertices[3 * i + 2] = bot.faces[3 * faces[i] + 2];
+    }
+
+    // local vertex indices
+    std::vector<int> localVertices(vertices);
+
+    std::sort(localVertices.begin(), localVertices.end());
+    localVertices.erase(std::unique(localVertices.begin(), localVertices.end()), localVertices.end());
+
+    size_t              numberOfVertices = localVertices.size();
+    std::vector<size_t> corners(3 * numberOfFaces);
+
+    for (size_t i = 0; i < corners.size(); ++i)
+        corners[i] = std::lower_bound(localVertices.begin(), localVertices.end(), vertices[i]) - localVertices.begin();
+
+    // vertex to face adjacency
+    std::vector<size_t> adjacencyBegin(numberOfVertices + 1, 0);
+    std::vector<size_t> adjacency(3 * numberOfFaces);
+
+    for (size_t i = 0; i < corners.size(); ++i)
+        ++adjacencyBegin[corners[i] + 1];
+
+    for (size_t i = 0; i < numberOfVertices; ++i)
+        adjacencyBegin[i + 1] += adjacencyBegin[i];
+
+    {
+        std::vector<size_t> fill(adjacencyBegin.begin(), adjacencyBegin.end() - 1);
+
+        for (size_t i = 0; i < corners.size(); ++i)
+            adjacency[fill[corners[i]]++] = i / 3;
+    }
+
+    std::vector<size_t> liveFaces(numberOfVertices);
+    std::vector<size_t> cacheTime(numberOfVertices, 0);
+    std::vector<bool>   emitted(numberOfFaces, false);
+    std::vector<size_t> deadEnds;
+    std::vector<size_t> candidates;
+    size_t              time   = cacheSize + 1;
+    size_t              cursor = 0;
+    size_t*             output = begin;
+
+    for (size_t i = 0; i < numberOfVertices; ++i)
+        liveFaces[i] = adjacencyBegin[i + 1] - adjacencyBegin[i];
+
+    size_t fanning = 0;
+
+    while (fanning < numberOfVertices) {
+        candidates.clear();
+
+        for (size_t i = adjacencyBegin[fanning]; i < adjacencyBegin[fanning + 1]; ++i) {
+            size_t face = adjacency[i];
+
+            if (!emitted[face]) {
+                for (size_t j = 0; j < 3; ++j) {
+                    size_t vertex = corners[3 * face + j];
+
+                    deadEnds.push_back(vertex);
+                    candidates.push_back(vertex);
+                    --liveFaces[vertex];
+
+                    if (time - cacheTime[vertex] > cacheSize)
+                        cacheTime[vertex] = time++;
+                }
+
+                emitted[face] = true;
+                *output++     = faces[face];
+            }
+        }
+
+        // next fanning vertex: the candidate which stays in the cache and was the longest there
+        size_t next         = numberOfVertices;
+        size_t bestPriority = 0;
+
+        for (size_t i = 0; i < candidates.size(); ++i) {
+            size_t vertex = candidates[i];
+
+            if (liveFaces[vertex] > 0) {
+                size_t priority = 1;
+
+                if (time - cacheTime[vertex] + 2 * liveFaces[vertex] <= cacheSize)
+                    priority += time - cacheTime[vertex];
+
+                if (priority > bestPriority) {
+                    next         = vertex;
+                    bestPriority = priority;
+                }
+            }
+        }
+
+        // dead end: recently used vertex with open faces, or the next one in input order
+        while ((next == numberOfVertices) && !deadEnds.empty()) {
+            size_t vertex = deadEnds.back();
+
+            deadEnds.pop_back();
+
+            if (liveFaces[vertex] > 0)
+                next = vertex;
+        }
+
+        if (next == numberOfVertices) {
+            while ((cursor < numberOfVertices) && (liveFaces[cursor] == 0))
+                ++cursor;
+
+            next = cursor;
+        }
+
+        fanning = next;
+    }
+
+    assert(output == end);
+}
+
+
+static void ReorderBot
+(
+    rt_bot_internal& bot,
+    bool             optimizeVertexCache
+) {
+    size_t numberOfFaces    = bot.num_faces;
+    size_t numberOfVertices = bot.num_vertices;
+
+    if (numberOfFaces == 0)
+        return;
+
+    std::vector<size_t> faceOrder = MortonOrder(bot);
+
+    // the cache optimization works on spatially coherent clusters of faces
+    if (optimizeVertexCache) {
+        static const size_t ClusterSize = 65536;
+
+        ParallelFor((numberOfFaces + ClusterSize - 1) / ClusterSize, 1, [&bot, &faceOrder, numberOfFaces](size_t begin, size_t end, size_t) {
+            for (size_t cluster = begin; cluster < end; ++cluster)
+                OptimizeVertexCache(bot,
+                                    faceOrder.data() + cluster * ClusterSize,
+                                    faceOrder.data() + std::min((cluster + 1) * ClusterSize, numberOfFaces),
+                                    24);
+        });
+    }
+
+    // permute the per face data
+    if (bot.face_normals != nullptr)
+        EnsureFaceNormals(bot);
+
+    int*     faces       = static_cast<int*>(bu_malloc(3 * numberOfFaces * sizeof(int), "bot interface ReorderBot(): faces"));
+    fastf_t* thickness   = nullptr;
+    int*     faceNormals = nullptr;
+
+    if (bot.thickness != nullptr)
+        thickness = static_cast<fastf_t*>(bu_malloc(numberOfFaces * sizeof(fastf_t), "bot interface ReorderBot(): thickness"));
+
+    if (bot.face_normals != nullptr)
+        faceNormals = static_cast<int*>(bu_malloc(3 * numberOfFaces * sizeof(int), "bot interface ReorderBot(): face_normals"));
+
+    ParallelFor(numberOfFaces, 16384, [&bot, &faceOrder, faces, thickness, faceNormals](size_t begin, size_t end, size_t) {
+        for (size_t i = begin; i < end; ++i) {
+            size_t face = faceOrder[i];
+
+            VMOVE(faces + 3 * i, bot.faces + 3 * face);
+
+            if (thickness != nullptr)
+                thickness[i] = bot.thickness[face];
+
+            if (faceNormals != nullptr)
+                VMOVE(faceNormals + 3 * i, bot.face_normals + 3 * face);
+        }
+    });
+
+    if (bot.face_mode != nullptr) {
+        bu_bitv* faceMode = bu_bitv_new(numberOfFaces);
+
+        for (size_t i = 0; i < numberOfFaces; ++i) {
+            if (BU_BITTEST(bot.face_mode, faceOrder[i]))
+                BU_BITSET(faceMode, i);
+            else
+                BU_BITCLR(faceMode, i);
+        }
+
+        bu_bitv_free(bot.face_mode);
+        bot.face_mode = faceMode;
+    }
+
+    bu_free(bot.faces, "bot interface ReorderBot(): faces");
+    bot.faces = faces;
+
+    if (thickness != nullptr) {
+        bu_free(bot.thickness, "bot interface ReorderBot(): thickness");
+        bot.thickness = thickness;
+    }
+
+    if (faceNormals != nullptr) {
+        bu_free(bot.face_normals, "bot interface ReorderBot(): face_normals");
+        bot.face_normals = faceNormals;
+    }
+
+    // renumber the vertices in order of their first use, unused ones go to the end
+    std::vector<int> newVertexIndex(numberOfVertices, -1);
+    int              vertexCount = 0;
+
+    for (size_t i = 0; i < 3 * numberOfFaces; ++i) {
+        if (newVertexIndex[bot.faces[i]] < 0)
+            newVertexIndex[bot.faces[i]] = vertexCount++;
+    }
+
+    for (size_t i = 0; i < numberOfVertices; ++i) {
+        if (newVertexIndex[i] < 0)
+            newVertexIndex[i] = vertexCount++;
+    }
+
+    fastf_t* vertices = static_cast<fastf_t*>(bu_malloc(3 * numberOfVertices * sizeof(fastf_t), "bot interface ReorderBot(): vertices"));
+
+    ParallelFor(numberOfVertices, 16384, [&bot, &newVertexIndex, vertices](size_t begin, size_t end, size_t) {
+        for (size_t i = begin; i < end; ++i)
+            VMOVE(vertices + 3 * newVertexIndex[i], bot.vertices + 3 * i);
+    });
+
+    ParallelFor(3 * numberOfFaces, 16384, [&bot, &newVertexIndex](size_t begin, size_t end, size_t) {
+        for (size_t i = begin; i < end; ++i)
+            bot.faces[i] = newVertexIndex[bot.faces[i]];
+    });
+
+    bu_free(bot.vertices, "bot interface ReorderBot(): vertices");
+    bot.vertices = vertices;
+
+    // the same for the normals
+    if ((bot.normals != nullptr) && (bot.face_normals != nullptr)) {
+        size_t           numberOfNormals = bot.num_normals;
+        std::vector<int> newNormalIndex(numberOfNormals, -1);
+        int              normalCount = 0;
+
+        for (size_t i = 0; i < 3 * bot.num_face_normals; ++i) {
+            if (newNormalIndex[bot.face_normals[i]] < 0)
+                newNormalIndex[bot.face_normals[i]] = normalCount++;
+        }
+
+        for (size_t i = 0; i < numberOfNormals; ++i) {
+            if (newNormalIndex[i] < 0)
+                newNormalIndex[i] = normalCount++;
+        }
+
+        fastf_t* normals = static_cast<fastf_t*>(bu_malloc(3 * numberOfNormals * sizeof(fastf_t), "bot interface ReorderBot(): normals"));
+
+        ParallelFor(numberOfNormals, 16384, [&bot, &newNormalIndex, normals](size_t begin, size_t end, size_t) {
+            for (size_t i = begin; i < end; ++i)
+                VMOVE(normals + 3 * newNormalIndex[i], bot.normals + 3 * i);
+        });
+
+        ParallelFor(3 * bot.num_face_normals, 16384, [&bot, &newNormalIndex](size_t begin, size_t end, size_t) {
+            for (size_t i = begin; i < end; ++i)
+                bot.face_normals[i] = newNormalIndex[bot.face_normals[i]];
+        });
+
+        bu_free(bot.normals, "bot interface ReorderBot(): normals");
+        bot.normals = normals;
+    }
+}
+
+
+/// symmetric 4x4 matrix of a quadric error metric: a00 a01 a02 a03 a11 a12 a13 a22 a23 a33
+/** The planes are weighted, \a weight is the sum of their weights. */
+struct Quadric {
+    double a[10];
+    double weight;
+
+    Quadric(void) : weight(0.) {
+        std::fill(a, a + 10, 0.);
+    }
+
+    void AddPlane
+    (
+        const vect_t& normal,
+        double        distance,
+        double        weight
+    ) {
+        a[0] += weight * normal[X] * normal[X];
+        a[1] += weight * normal[X] * normal[Y];
+        a[2] += weight * normal[X] * normal[Z];
+        a[3] += weight * normal[X] * distance;
+        a[4] += weight * normal[Y] * normal[Y];
+        a[5] += weight * normal[Y] * normal[Z];
+        a[6] += weight * normal[Y] * distance;
+        a[7] += weight * normal[Z] * normal[Z];
+        a[8] += weight * normal[Z] * distance;
+        a[9] += weight * distance * distance;
+
+        this->weight += weight;
+    }
+
+    void Add
+    (
+        const Quadric& other
+    ) {
+        for (size_t i = 0; i < 10; ++i)
+            a[i] += other.a[i];
+
+        weight += other.weight;
+    }
+
+    double Error
+    (
+        const fastf_t* point
+    ) const {
+        double x = point[X];
+        double y = point[Y];
+        double z = point[Z];
+
+        return a[0] * x * x + 2. * a[1] * x * y + 2. * a[2] * x * z + 2. * a[3] * x
+               + a[4] * y * y + 2. * a[5] * y * z + 2. * a[6] * y
+               + a[7] * z * z + 2. * a[8] * z
+               + a[9];
+    }
+
+    /// the weighted mean of the squared distances of \a point to the planes
+    /** In contrast to Error() it doesn't depend on the size of the faces. */
+    double MeanError
+    (
+        const fastf_t* point
+    ) const {
+        double ret = 0.;
+
+        if (weight > 0.)
+            ret = std::max(Error(point) / weight, 0.);
+
+        return ret;
+    }
+
+    /// the point with the minimal error, if the system is well conditioned
+    bool Minimum
+    (
+        fastf_t* point
+    ) const {
+        double determinant = a[0] * (a[4] * a[7] - a[5] * a[5]) - a[1] * (a[1] * a[7] - a[5] * a[2]) + a[2] * (a[1] * a[5] - a[4] * a[2]);
+        double scale       = std::max(a[0], std::max(a[4], a[7]));
+
+        if (fabs(determinant) <= 1e-12 * scale * scale * scale)
+            return false;
+
+        // Cramer's rule for A x = -b
+        double b[3] = {-a[3], -a[6], -a[8]};
+
+        point[X] = (b[0] * (a[4] * a[7] - a[5] * a[5]) - a[1] * (b[1] * a[7] - a[5] * b[2]) + a[2] * (b[1] * a[5] - a[4] * b[2])) / determinant;
+        point[Y] = (a[0] * (b[1] * a[7] - a[5] * b[2]) - b[0] * (a[1] * a[7] - a[5] * a[2]) + a[2] * (a[1] * b[2] - b[1] * a[2])) / determinant;
+        point[Z] = (a[0] * (a[4] * b[2] - b[1] * a[5]) - a[1] * (a[1] * b[2] - b[1] * a[2]) + b[0] * (a[1] * a[5] - a[4] * a[2])) / determinant;
+
+        return true;
+    }
+};
+
+
+struct EdgeCollapse {
+    double  cost;
+    size_t  keep;
+    size_t  remove;
+    size_t  keepVersion;
+    size_t  removeVersion;
+    point_t position;
+
+    bool operator>
+    (
+        const EdgeCollapse& other
+    ) const {
+        return cost > other.cost;
+    }
+};
+
+
+/// vertices which must not be moved or removed by the decimation of the partitions
+/** These are the vertices on boundary or non-manifold edges, or on edges between faces with different thickness or mode (1),
+    and the ones shared by partitions (2). */
+static std::vector<char> LockedVertices
+(
+    const rt_bot_internal&     bot,
+    const std::vector<size_t>& facePartition
+) {
+    size_t              numberOfVertices = bot.num_vertices;
+    size_t              numberOfFaces    = bot.num_faces;
+    std::vector<size_t> vertexFacesBegin(numberOfVertices + 1, 0);
+    std::vector<size_t> vertexFaces(3 * numberOfFaces);
+    std::vector<char>   ret(numberOfVertices, 0);
+
+    for (size_t i = 0; i < 3 * numberOfFaces; ++i)
+        ++vertexFacesBegin[bot.faces[i] + 1];
+
+    for (size_t i = 0; i < numberOfVertices; ++i)
+        vertexFacesBegin[i + 1] += vertexFacesBegin[i];
+
+    {
+        std::vector<size_t> fill(vertexFacesBegin.begin(), vertexFacesBegin.end() - 1);
+
+        for (size_t i = 0; i < 3 * numberOfFaces; ++i)
+            vertexFaces[fill[bot.faces[i]]++] = i / 3;
+    }
+
+    ParallelFor(numberOfVertices, 4096, [&](size_t begin, size_t end, size_t) {
+        for (size_t vertex = begin; vertex < end; ++vertex) {
+            bool locked = false;
+            bool shared = false;
+
+            for (size_t i = vertexFacesBegin[vertex]; i < vertexFacesBegin[vertex + 1]; ++i) {
+                if (facePartition[vertexFaces[i]] != facePartition[vertexFaces[vertexFacesBegin[vertex]]]) {
+                    shared = true;
+                    break;
+                }
+            }
+
+            for (size_t i = vertexFacesBegin[vertex]; (i < vertexFacesBegin[vertex + 1]) && !locked && !shared; ++i) {
+                size_t face = vertexFaces[i];
+
+                // the edges of this vertex in the face
+                for (size_t corner = 0; (corner < 3) && !locked; ++corner) {
+                    int other = bot.faces[3 * face + corner];
+
+                    if (other == static_cast<int>(vertex))
+                        continue;
+
+                    size_t edgeFaces = 0;
+                    size_t lastFace  = face;
+
+                    for (size_t j = vertexFacesBegin[vertex]; j < vertexFacesBegin[vertex + 1]; ++j) {
+                        size_t otherFace = vertexFaces[j];
+
+                        if ((bot.faces[3 * otherFace] == other) || (bot.faces[3 * otherFace + 1] == other) || (bot.faces[3 * otherFace + 2] == other)) {
+                            ++edgeFaces;
+
+                            if (otherFace != face)
+                                lastFace = otherFace;
+                        }
+                    }
+
+                    if (edgeFaces != 2)
+                        locked = true;
+                    else if ((bot.thickness != nullptr) && (bot.thickness[face] != bot.thickness[lastFace]))
+                        locked = true;
+                    else if ((bot.face_mode != nullptr) && ((BU_BITTEST(bot.face_mode, face) != 0) != (BU_BITTEST(bot.face_mode, lastFace) != 0)))
+                        locked = true;
+                }
+            }
+
+            ret[vertex] = shared ? 2 : (locked ? 1 : 0);
+        }
+    });
+
+    return ret;
+}
+
+
+/// edge collapse decimation of the faces in [begin, end) of \a faces
+/** Only unlocked vertices are moved or removed, they are exclusively used by the faces of this partition.
+    Therefore, the results can be written directly into the vertices and faces of \a bot. */
+static void DecimatePartition
+(
+    rt_bot_internal&         bot,
+    const size_t*            begin,
+    const size_t*            end,
+    const std::vector<char>& locked,
+    size_t                   targetFaces,
+    double                   maxError,
+    std::vector<char>&       faceAlive
+) {
+    size_t           numberOfFaces = end - begin;
+    std::vector<int> globalVertices;
+
+    globalVertices.reserve(3 * numberOfFaces);
+
+    for (const size_t* face = begin; face != end; ++face)
+        globalVertices.insert(globalVertices.end(), bot.faces + 3 * *face, bot.faces + 3 * *face + 3);
+
+    std::sort(globalVertices.begin(), globalVertices.end());
+    globalVertices.erase(std::unique(globalVertices.begin(), globalVertices.end()), globalVertices.end());
+
+    size_t                            numberOfVertices = globalVertices.size();
+    std::vector<size_t>               corners(3 * numberOfFaces);
+    std::vector<double>               positions(3 * numberOfVertices);
+    std::vector<Quadric>              quadrics(numberOfVertices);
+    std::vector<std::vector<size_t> > vertexFaces(numberOfVertices);
+    std::vector<size_t>               versions(numberOfVertices, 0);
+    std::vector<char>                 vertexAlive(numberOfVertices, 1);
+    std::vector<char>                 alive(numberOfFaces, 1);
+    std::vector<double>               facePlanes(4 * numberOfFaces, 0.);
+
+    for (size_t i = 0; i < numberOfVertices; ++i)
+        VMOVE(positions.data() + 3 * i, bot.vertices + 3 * globalVertices[i]);
+
+    for (size_t face = 0; face < numberOfFaces; ++face) {
+        for (size_t corner = 0; corner < 3; ++corner) {
+            size_t vertex = std::lower_bound(globalVertices.begin(), globalVertices.end(), bot.faces[3 * begin[face] + corner]) - globalVertices.begin();
+
+            corners[3 * face + corner] = vertex;
+            vertexFaces[vertex].push_back(face);
+        }
+
+        const double* points[3] = {positions.data() + 3 * corners[3 * face],
+                                   positions.data() + 3 * corners[3 * face + 1],
+                                   positions.data() + 3 * corners[3 * face + 2]};
+        vect_t        edge1;
+        vect_t        edge2;
+        vect_t        normal;
+
+        VSUB2(edge1, points[1], points[0]);
+        VSUB2(edge2, points[2], points[0]);
+        VCROSS(normal, edge1, edge2);
+
+        double length = MAGNITUDE(normal);
+
+        if (length > SMALL_FASTF) {
+            VSCALE(normal, normal, 1. / length);
+
+            Quadric facePlane;
+
+            facePlane.AddPlane(normal, -VDOT(normal, points[0]), length / 2.);
+
+            for (size_t corner = 0; corner < 3; ++corner)
+                quadrics[corners[3 * face + corner]].Add(facePlane);
+
+            VMOVE(facePlanes.data() + 4 * face, normal);
+            facePlanes[4 * face + 3] = -VDOT(normal, points[0]);
+        }
+    }
+
+    // the original faces represented by a vertex, their planes bound the movement of the vertex
+    std::vector<std::vector<size_t> > originalFaces;
+
+    if (maxError >= 0.)
+        originalFaces = vertexFaces;
+
+    auto withinError = [&](const EdgeCollapse& collapse) {
+        bool ret = true;
+
+        for (size_t v = 0; (v < 2) && ret; ++v) {
+            const std::vector<size_t>& faces = originalFaces[(v == 0) ? collapse.keep : collapse.remove];
+
+            for (size_t i = 0; (i < faces.size()) && ret; ++i) {
+                const double* plane = facePlanes.data() + 4 * faces[i];
+
+                if (fabs(VDOT(plane, collapse.position) + plane[3]) > maxError)
+                    ret = false;
+            }
+        }
+
+        return ret;
+    };
+
+    std::priority_queue<EdgeCollapse, std::vector<EdgeCollapse>, std::greater<EdgeCollapse> > candidates;
+
+    auto pushCandidate = [&](size_t vertex1, size_t vertex2) {
+        char lock1   = locked[globalVertices[vertex1]];
+        char lock2   = locked[globalVertices[vertex2]];
+        bool locked1 = lock1 != 0;
+        bool locked2 = lock2 != 0;
+
+        // vertices shared with other partitions are not even collapse targets, their neighborhood isn't known here
+        if ((locked1 && locked2) || (lock1 == 2) || (lock2 == 2))
+            return;
+
+        EdgeCollapse collapse;
+        Quadric      quadric = quadrics[vertex1];
+
+        quadric.Add(quadrics[vertex2]);
+
+        if (locked2 || (!locked1 && (vertex1 < vertex2))) {
+            collapse.keep   = vertex2;
+            collapse.remove = vertex1;
+        }
+        else {
+            collapse.keep   = vertex1;
+            collapse.remove = vertex2;
+        }
+
+        if (locked1 || locked2) {
+            VMOVE(collapse.position, positions.data() + 3 * collapse.keep);
+            collapse.cost = quadric.MeanError(collapse.position);
+        }
+        else if (quadric.Minimum(collapse.position))
+            collapse.cost = quadric.MeanError(collapse.position);
+        else {
+            point_t middle;
+
+            VADD2(middle, positions.data() + 3 * vertex1, positions.data() + 3 * vertex2);
+            VSCALE(middle, middle, 0.5);
+
+            VMOVE(collapse.position, middle);
+            collapse.cost = quadric.MeanError(middle);
+
+            const double* ends[2] = {positions.data() + 3 * vertex1, positions.data() + 3 * vertex2};
+
+            for (size_t i = 0; i < 2; ++i) {
+                double cost = quadric.MeanError(ends[i]);
+
+                if (cost < collapse.cost) {
+                    VMOVE(collapse.position, ends[i]);
+                    collapse.cost = cost;
+                }
+            }
+        }
+
+        collapse.keepVersion   = versions[collapse.keep];
+        collapse.removeVersion = versions[collapse.remove];
+        candidates.push(collapse);
+    };
+
+    for (size_t face = 0; face < numberOfFaces; ++face) {
+        for (size_t corner = 0; corner < 3; ++corner)
+            pushCandidate(corners[3 * face + corner], corners[3 * face + (corner + 1) % 3]);
+    }
+
+    size_t              faceCount = numberOfFaces;
+    double              maxCost   = (maxError < 0.) ? INFINITY : maxError * maxError;
+    std::vector<size_t> neighbors1;
+    std::vector<size_t> neighbors2;
+
+    while (!candidates.empty() && (faceCount > targetFaces)) {
+        EdgeCollapse collapse = candidates.top();
+
+        candidates.pop();
+
+        // the mean squared distance is a lower bound of the squared maximal distance
+        if (collapse.cost > maxCost)
+            break;
+
+        size_t keep   = collapse.keep;
+        size_t remove = collapse.remove;
+
+        if (!vertexAlive[keep] || !vertexAlive[remove] || (versions[keep] != collapse.keepVersion) || (versions[remove] != collapse.removeVersion))
+            continue;
+
+        // link condition: the common neighbors are the opposite vertices of the shared faces
+        size_t sharedFaces = 0;
+
+        neighbors1.clear();
+        neighbors2.clear();
+
+        for (size_t i = 0; i < vertexFaces[keep].size(); ++i) {
+            size_t face = vertexFaces[keep][i];
+
+            if (alive[face]) {
+                for (size_t corner = 0; corner < 3; ++corner) {
+                    if (corners[3 * face + corner] == remove)
+                        ++sharedFaces;
+                    else if (corners[3 * face + corner] != keep)
+                        neighbors1.push_back(corners[3 * face + corner]);
+                }
+            }
+        }
+
+        for (size_t i = 0; i < vertexFaces[remove].size(); ++i) {
+            size_t face = vertexFaces[remove][i];
+
+            if (alive[face]) {
+                for (size_t corner = 0; corner < 3; ++corner) {
+                    if ((corners[3 * face + corner] != keep) && (corners[3 * face + corner] != remove))
+                        neighbors2.push_back(corners[3 * face + corner]);
+                }
+            }
+        }
+
+        std::sort(neighbors1.begin(), neighbors1.end());
+        neighbors1.erase(std::unique(neighbors1.begin(), neighbors1.end()), neighbors1.end());
+        std::sort(neighbors2.begin(), neighbors2.end());
+        neighbors2.erase(std::unique(neighbors2.begin(), neighbors2.end()), neighbors2.end());
+
+        size_t commonNeighbors = 0;
+
+        for (size_t i = 0, j = 0; (i < neighbors1.size()) && (j < neighbors2.size());) {
+            if (neighbors1[i] < neighbors2[j])
+                ++i;
+            else if (neighbors2[j] < neighbors1[i])
+                ++j;
+            else {
+                ++commonNeighbors;
+                ++i;
+                ++j;
+            }
+        }
+
+        if ((sharedFaces != 2) || (commonNeighbors != 2))
+            continue;
+
+        if ((maxError >= 0.) && !withinError(collapse))
+            continue;
+
+        // the remaining faces must not flip or degenerate
+        bool valid = true;
+
+        for (size_t v = 0; (v < 2) && valid; ++v) {
+            size_t moved = (v == 0) ? keep : remove;
+
+            for (size_t i = 0; (i < vertexFaces[moved].size()) && valid; ++i) {
+                size_t face = vertexFaces[moved][i];
+
+                if (!alive[face])
+                    continue;
+
+                const size_t* faceCorners = corners.data() + 3 * face;
+
+                if (((faceCorners[0] == keep) || (faceCorners[1] == keep) || (faceCorners[2] == keep)) &&
+                    ((faceCorners[0] == remove) || (faceCorners[1] == remove) || (faceCorners[2] == remove)))
+                    continue;
+
+                const double* oldPoints[3];
+                const double* newPoints[3];
+
+                for (size_t corner = 0; corner < 3; ++corner) {
+                    oldPoints[corner] = positions.data() + 3 * faceCorners[corner];
+                    newPoints[corner] = (faceCorners[corner] == moved) ? collapse.position : oldPoints[corner];
+                }
+
+                vect_t edge1;
+                vect_t edge2;
+                vect_t oldNormal;
+                vect_t newNormal;
+
+                VSUB2(edge1, oldPoints[1], oldPoints[0]);
+                VSUB2(edge2, oldPoints[2], oldPoints[0]);
+                VCROSS(oldNormal, edge1, edge2);
+                VSUB2(edge1, newPoints[1], newPoints[0]);
+                VSUB2(edge2, newPoints[2], newPoints[0]);
+                VCROSS(newNormal, edge1, edge2);
+
+                if ((MAGNITUDE(newNormal) <= SMALL_FASTF) || (VDOT(oldNormal, newNormal) <= 0.))
+                    valid = false;
+            }
+        }
+
+        if (!valid)
+            continue;
+
+        // collapse remove into keep
+        for (size_t i = 0; i < vertexFaces[remove].size(); ++i) {
+            size_t face = vertexFaces[remove][i];
+
+            if (!alive[face])
+                continue;
+
+            size_t* faceCorners = corners.data() + 3 * face;
+
+            if ((faceCorners[0] == keep) || (faceCorners[1] == keep) || (faceCorners[2] == keep)) {
+                alive[face] = 0;
+                --faceCount;
+            }
+            else {
+                for (size_t corner = 0; corner < 3; ++corner) {
+                    if (faceCorners[corner] == remove)
+                        faceCorners[corner] = keep;
+                }
+
+                vertexFaces[keep].push_back(face);
+            }
+        }
+
+        VMOVE(positions.data() + 3 * keep, collapse.position);
+        quadrics[keep].Add(quadrics[remove]);
+        vertexAlive[remove] = 0;
+
+        if (maxError >= 0.) {
+            std::vector<size_t>& keepOriginals = originalFaces[keep];
+
+            keepOriginals.insert(keepOriginals.end(), originalFaces[remove].begin(), originalFaces[remove].end());
+            std::sort(keepOriginals.begin(), keepOriginals.end());
+            keepOriginals.erase(std::unique(keepOriginals.begin(), keepOriginals.end()), keepOriginals.end());
+            std::vector<size_t>().swap(originalFaces[remove]);
+        }
+        vertexFaces[remove].clear();
+        ++versions[keep];
+
+        // compact the adjacency and consider the new edges
+        std::vector<size_t>& keepFaces = vertexFaces[keep];
+
+        keepFaces.erase(std::remove_if(keepFaces.begin(), keepFaces.end(), [&alive](size_t face) {return !alive[face];}), keepFaces.end());
+
+        for (size_t i = 0; i < keepFaces.size(); ++i) {
+            for (size_t corner = 0; corner < 3; ++corner) {
+                size_t other = corners[3 * keepFaces[i] + corner];
+
+                if (other != keep)
+                    pushCandidate(keep, other);
+            }
+        }
+    }
+
+    // write back: the moved vertices are owned by this partition
+    for (size_t i = 0; i < numberOfVertices; ++i) {
+        if (vertexAlive[i] && !locked[globalVertices[i]])
+            VMOVE(bot.vertices + 3 * globalVertices[i], positions.data() + 3 * i);
+    }
+
+    for (size_t face = 0; face < numberOfFaces; ++face) {
+        if (alive[face]) {
+            for (size_t corner = 0; corner < 3; ++corner)
+                bot.faces[3 * begin[face] + corner] = globalVertices[corners[3 * face + corner]];
+        }
+        else
+            faceAlive[begin[face]] = 0;
+    }
+}
+
+
+/// removes the dead faces and the then unused vertices
+/** The bag of triangles mustn't have normals. */
+static void CompactBot
+(
+    rt_bot_internal&         bot,
+    const std::vector<char>& faceAlive
+) {
+    size_t numberOfFaces = 0;
+
+    for (size_t i = 0; i < bot.num_faces; ++i) {
+        if (faceAlive[i]) {
+            if (numberOfFaces != i) {
+                VMOVE(bot.faces + 3 * numberOfFaces, bot.faces + 3 * i);
+
+                if (bot.thickness != nullptr)
+                    bot.thickness[numberOfFaces] = bot.thickness[i];
+
+                if (bot.face_mode != nullptr) {
+                    if (BU_BITTEST(bot.face_mode, i))
+                        BU_BITSET(bot.face_mode, numberOfFaces);
+                    else
+                        BU_BITCLR(bot.face_mode, numberOfFaces);
+                }
+            }
+
+            ++numberOfFaces;
+        }
+    }
+
+    bot.num_faces = numberOfFaces;
+
+    if (numberOfFaces > 0) {
+        bot.faces = static_cast<int*>(bu_realloc(bot.faces, 3 * numberOfFaces * sizeof(int), "bot interface CompactBot(): faces"));
+
+        if (bot.thickness != nullptr)
+            bot.thickness = static_cast<fastf_t*>(bu_realloc(bot.thickness, numberOfFaces * sizeof(fastf_t), "bot interface CompactBot(): thickness"));
+
+        if (bot.face_mode != nullptr) {
+            bu_bitv* faceMode = bu_bitv_new(numberOfFaces);
+
+            for (size_t i = 0; i < numberOfFaces; ++i) {
+                if (BU_BITTEST(bot.face_mode, i))
+                    BU_BITSET(faceMode, i);
+                else
+                    BU_BITCLR(faceMode, i);
+            }
+
+            bu_bitv_free(bot.face_mode);
+            bot.face_mode = faceMode;
+        }
+    }
+
+    // vertices
+    std::vector<char> vertexUsed(bot.num_vertices, 0);
+    std::vector<int>  newVertexIndex(bot.num_vertices, -1);
+    size_t            numberOfVertices = 0;
+
+    for (size_t i = 0; i < 3 * numberOfFaces; ++i)
+        vertexUsed[bot.faces[i]] = 1;
+
+    for (size_t i = 0; i < bot.num_vertices; ++i) {
+        if (vertexUsed[i]) {
+            newVertexIndex[i] = static_cast<int>(numberOfVertices);
+            VMOVE(bot.vertices + 3 * numberOfVertices, bot.vertices + 3 * i);
+            ++numberOfVertices;
+        }
+    }
+
+    ParallelFor(3 * numberOfFaces, 16384, [&bot, &newVertexIndex](size_t begin, size_t end, size_t) {
+        for (size_t i = begin; i < end; ++i)
+            bot.faces[i] = newVertexIndex[bot.faces[i]];
+    });
+
+    bot.num_vertices = numberOfVertices;
+
+    if (numberOfVertices > 0)
+        bot.vertices = static_cast<fastf_t*>(bu_realloc(bot.vertices, 3 * numberOfVertices * sizeof(fastf_t), "bot interface CompactBot(): vertices"));
+}
+
+
+static void DecimateBot
+(
+    rt_bot_internal& bot,
+    size_t           targetFaces,
+    double           maxError
+) {
+    size_t numberOfFaces = bot.num_faces;
+
+    if (numberOfFaces <= targetFaces)
+        return;
+
+    // spatially coherent partitions along the Morton curve
+    std::vector<size_t> faceOrder      = MortonOrder(bot);
+    size_t              partitions     = std::max(size_t(1), std::min(2 * ParallelThreads(numberOfFaces, 32768), numberOfFaces / 1024));
+    size_t              partitionSize  = (numberOfFaces + partitions - 1) / partitions;
+    std::vector<size_t> facePartition(numberOfFaces);
+
+    for (size_t i = 0; i < numberOfFaces; ++i)
+        facePartition[faceOrder[i]] = i / partitionSize;
+
+    std::vector<char> locked = LockedVertices(bot, facePartition);
+    std::vector<char> faceAlive(numberOfFaces, 1);
+
+    ParallelFor(partitions, 1, [&](size_t begin, size_t end, size_t) {
+        for (size_t partition = begin; partition < end; ++partition) {
+            size_t first = std::min(partition * partitionSize, numberOfFaces);
+            size_t last  = std::min(first + partitionSize, numberOfFaces);
+
+            // every partition gets its share of the target
+            size_t partitionTarget = (targetFaces * (last - first) + numberOfFaces - 1) / numberOfFaces;
+
+            DecimatePartition(bot, faceOrder.data() + first, faceOrder.data() + last, locked, partitionTarget, maxError, faceAlive);
+        }
+    });
+
+    // the vertex normals don't fit to the moved vertices any more
+    if (bot.normals != nullptr) {
+        bu_free(bot.normals, "bot interface DecimateBot(): normals");
+        bot.normals     = nullptr;
+        bot.num_normals = 0;
+    }
+
+    if (bot.face_normals != nullptr) {
+        bu_free(bot.face_normals, "bot interface DecimateBot(): face_normals");
+        bot.face_normals     = nullptr;
+        bot.num_face_normals = 0;
+    }
+
+    bot.bot_flags &= ~(RT_BOT_HAS_SURFACE_NORMALS | RT_BOT_USE_NORMALS);
+
+    CompactBot(bot, faceAlive);
+}
+
+
 static void CleanBotInternal
 (
     rt_bot_internal* bot
@@ -847,6 +2053,46 @@ void BagOfTriangles::SetUseFloats
 }
 
 
+void BagOfTriangles::ComputeVertexNormals
+(
+    double creaseAngle
+) {
+    if (!BU_SETJUMP)
+        SmoothNormals(*Internal(), creaseAngle);
+    else
+        BU_UNSETJUMP;
+
+    BU_UNSETJUMP;
+}
+
+
+void BagOfTriangles::Reorder
+(
+    bool optimizeVertexCache
+) {
+    if (!BU_SETJUMP)
+        ReorderBot(*Internal(), optimizeVertexCache);
+    else
+        BU_UNSETJUMP;
+
+    BU_UNSETJUMP;
+}
+
+
+void BagOfTriangles::Decimate
+(
+    size_t targetFaces,
+    double maxError
+) {
+    if (!BU_SETJUMP)
+        DecimateBot(*Internal(), targetFaces, maxError);
+    else
+        BU_UNSETJUMP;
+
+    BU_UNSETJUMP;
+}
+
+
 size_t BagOfTriangles::NumberOfFaces(void) const {
     return Internal()->num_faces;
 }
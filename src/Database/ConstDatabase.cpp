@@ -26,9 +26,32 @@
 #include <cstdlib>
 #include <cstring>
 #include <cassert>
+#include <cstdio>
+#include <cstdint>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <list>
+#include <set>
+#include <map>
+#include <unordered_map>
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <thread>
 
 #include "raytrace.h"
+#include "bu/file.h"
 #include "bu/parallel.h"
+#include "bv/vlist.h"
+
+#ifdef HAVE_MANIFOLD
+#include <atomic>
+
+#include "manifold/manifold.h"
+#endif
+
+#include "private.h"
 
 #include <brlcad/Database/Torus.h>
 #include <brlcad/Database/Cone.h>
@@ -46,6 +69,7 @@
 #include <brlcad/Database/EllipticalTorus.h>
 #include <brlcad/Database/Sketch.h>
 #include <brlcad/Database/BagOfTriangles.h>
+#include <brlcad/Database/MappedBagOfTriangles.h>
 #include <brlcad/Database/Combination.h>
 #include <brlcad/Database/Unknown.h>
 #include <brlcad/Database/ConstDatabase.h>
@@ -60,7 +84,7 @@
 using namespace BRLCAD;
 
 
-ConstDatabase::ConstDatabase(void) : m_rtip(nullptr), m_resp(nullptr), m_changeSignalHandlers(nullptr), m_selfUpdateNref(false) {
+ConstDatabase::ConstDatabase(void) : m_rtip(nullptr), m_resp(nullptr), m_selfModification(false), m_changeSignalHandlers(nullptr), m_selfUpdateNref(false), m_facetizationCache(nullptr), m_plotCache(nullptr), m_boundingBoxCache(nullptr), m_booleanBackend(BooleanBackend::NonManifold), m_parallelNmg(false) {
     assert(rt_uniresource.re_magic == RESOURCE_MAGIC);
 
     if (!BU_SETJUMP) {
@@ -79,6 +103,8 @@ ConstDatabase::~ConstDatabase(void) {
     if (m_changeSignalHandlers != nullptr)
         free(m_changeSignalHandlers);
 
+    DeleteCaches();
+
     if (m_rtip != nullptr) {
         if (!BU_SETJUMP) {
             DeRegisterCoreCallbacks();
@@ -106,323 +132,4372 @@ bool ConstDatabase::Load
                 rt_free_rti(m_rtip);
             }
 
-            BU_UNSETJUMP;
+            BU_UNSETJUMP;
+
+            m_rtip = nullptr;
+        }
+
+        if (!BU_SETJUMP)
+            m_rtip = rt_dirbuild(fileName, nullptr, 0);
+
+        BU_UNSETJUMP;
+
+        if (m_rtip != nullptr) {
+            if (!BU_SETJUMP) {
+                rt_init_resource(m_resp, 0, m_rtip);
+                RegisterCoreCallbacks();
+            }
+            else {
+                BU_UNSETJUMP;
+
+                if (!BU_SETJUMP) {
+                    DeRegisterCoreCallbacks();
+                    rt_free_rti(m_rtip);
+                }
+
+                m_rtip = nullptr;
+            }
+
+            BU_UNSETJUMP;
+        }
+    }
+
+    return (m_rtip != nullptr);
+}
+
+
+const char* ConstDatabase::Title(void) const {
+    const char* ret = nullptr;
+
+    if (m_rtip != nullptr)
+        ret = m_rtip->rti_dbip->dbi_title;
+
+    return ret;
+}
+
+
+const ConstDatabase::TopObjectIterator& ConstDatabase::TopObjectIterator::operator++(void) {
+    if (m_pDir != nullptr) {
+        const directory* oldPDir = m_pDir;
+
+        for (const directory* pDir = m_pDir->d_forw; pDir != RT_DIR_NULL; pDir = pDir->d_forw) {
+            if (pDir->d_nref == 0) {
+                m_pDir = pDir;
+                break;
+            }
+        }
+
+        if (m_pDir == oldPDir) {
+            for (size_t i = m_hashTablePosition + 1; (i < RT_DBNHASH) && (m_pDir == oldPDir); ++i) {
+                for (const directory* pDir = db_dirptr(m_rtip->rti_dbip, i); pDir != RT_DIR_NULL; pDir = pDir->d_forw) {
+                    if (pDir->d_nref == 0) {
+                        m_hashTablePosition = i;
+                        m_pDir              = pDir;
+                        break;
+                    }
+                }
+            }
+        }
+
+        if (m_pDir == oldPDir)
+            m_pDir = nullptr;
+    }
+
+    return *this;
+}
+
+
+bool ConstDatabase::TopObjectIterator::Good(void) const {
+    return (m_pDir != nullptr);
+}
+
+
+const char* ConstDatabase::TopObjectIterator::Name(void) const {
+    assert(m_pDir != nullptr);
+
+    const char* ret = nullptr;
+
+    if (m_pDir != nullptr)
+        ret = m_pDir->d_namep;
+
+    return ret;
+}
+
+
+ConstDatabase::TopObjectIterator::TopObjectIterator
+(
+    size_t           hashTablePosition,
+    const directory* pDir,
+    const rt_i*      rtip
+) : m_hashTablePosition(hashTablePosition), m_pDir(pDir), m_rtip(rtip) {}
+
+
+ConstDatabase::TopObjectIterator ConstDatabase::FirstTopObject(void) const {
+    size_t           hashTablePosition = 0;
+    const directory* pDirectory        = nullptr;
+
+    if (m_rtip != nullptr) {
+        if (!BU_SETJUMP) {
+            m_selfUpdateNref = true;
+            db_update_nref(m_rtip->rti_dbip);
+            m_selfUpdateNref = false;
+
+            for (size_t i = 0; (i < RT_DBNHASH) && (pDirectory == nullptr); ++i) {
+                for (const directory* pDir = db_dirptr(m_rtip->rti_dbip, i); pDir != RT_DIR_NULL; pDir = pDir->d_forw) {
+                    if (pDir->d_nref == 0) {
+                        hashTablePosition = i;
+                        pDirectory        = pDir;
+                        break;
+                    }
+                }
+            }
+        }
+
+        BU_UNSETJUMP;
+    }
+
+    return ConstDatabase::TopObjectIterator(hashTablePosition, pDirectory, m_rtip);
+}
+
+
+void ConstDatabase::Get
+(
+    const char*                                      objectName,
+    const std::function<void(const Object& object)>& callback
+) const {
+    if (m_rtip != nullptr) {
+        if (!BU_SETJUMP) {
+            if ((objectName != nullptr) && (strlen(objectName) > 0)) {
+                directory* pDir = db_lookup(m_rtip->rti_dbip, objectName, LOOKUP_NOISE);
+
+                GetInternal(pDir, callback);
+            }
+        }
+
+        BU_UNSETJUMP;
+    }
+}
+
+
+Object* ConstDatabase::Get
+(
+    const char* objectName
+) const {
+    Object* ret = nullptr;
+
+    Get(objectName, [&ret](const Object& object){try{ret = object.Clone();}catch(std::bad_alloc&){}});
+
+    return ret;
+}
+
+
+MappedBagOfTriangles* ConstDatabase::MapBagOfTriangles
+(
+    const char* objectName,
+    size_t      workingSetSize
+) const {
+    MappedBagOfTriangles* ret = nullptr;
+
+    if (m_rtip != nullptr) {
+        if (!BU_SETJUMP) {
+            if ((objectName != nullptr) && (strlen(objectName) > 0)) {
+                directory*  pDir = db_lookup(m_rtip->rti_dbip, objectName, LOOKUP_NOISE);
+                const void* keptData;
+                size_t      keptSize;
+
+                // the view reads the geometry from the database
+                if ((pDir != RT_DIR_NULL) && !KeptContent(pDir, keptData, keptSize))
+                    ret = MappedBagOfTriangles::Create(m_rtip->rti_dbip, pDir, workingSetSize);
+            }
+        }
+        else
+            BU_UNSETJUMP;
+
+        BU_UNSETJUMP;
+    }
+
+    return ret;
+}
+
+
+/// completes the objects which a derived class keeps outside of the database, see ConstDatabase::CompleteInternal()
+typedef std::function<void(const directory* pDir, const fastf_t* matrix, rt_db_internal& intern)> InternalCompletion;
+
+
+struct FacetizeSolid {
+    tree*              node;      ///< OP_NMG_TESS placeholder in the region tree, gets the tessellation
+    directory*         pDir;      ///< the solid's database object
+    rt_db_internal     internal;  ///< the solid, already transformed, only for prototypes
+    const bg_tess_tol* ttol;
+    const bn_tol*      tol;
+    size_t             prototype; ///< index of the leaf whose tessellation is reused, or the own index
+    mat_t              matrix;    ///< for prototypes the accumulated matrix, otherwise the transformation of the prototype's tessellation
+    bool               exact;     ///< the tessellation doesn't depend on the tessellation tolerances
+};
+
+
+struct FacetizeData {
+    std::vector<FacetizeSolid>                 leaves;
+    std::vector<tree*>                         regions;
+    std::vector<std::string>                   regionNames;
+    std::map<directory*, std::vector<size_t> > prototypes;
+    const InternalCompletion&                  completion;
+    bool                                       deferImport; ///< the tree walk doesn't keep the internals, see ImportLeafInternal()
+
+    FacetizeData
+    (
+        const InternalCompletion& internalCompletion,
+        bool                      deferInternalImport = false
+    ) : completion(internalCompletion), deferImport(deferInternalImport) {}
+};
+
+
+static tree* FacetizeRegionEnd
+(
+    db_tree_state*      tsp,
+    const db_full_path* pathp,
+    tree*               curtree,
+    void*               clientData
+) {
+    tree* ret = TREE_NULL;
+
+    if (tsp != nullptr)
+        RT_CK_DBTS(tsp);
+
+    if (pathp != nullptr)
+        RT_CK_FULL_PATH(pathp);
+
+    FacetizeData* facetizeData = static_cast<FacetizeData*>(clientData);
+
+    if (curtree->tr_op == OP_NOP)
+        ret = curtree;
+    else {
+        facetizeData->regions.push_back(curtree);
+        facetizeData->regionNames.push_back((pathp != nullptr) ? DB_FULL_PATH_CUR_DIR(pathp)->d_namep : "");
+    }
+
+    return ret;
+}
+
+
+/// tests if \a matrix is a motion of a rigid body, i.e. a rotation and translation without scaling, shearing or mirroring
+/** The tessellation tolerances are given in absolute units, therefore only tessellations transformed this way are equivalent. */
+static bool IsRigidMotion
+(
+    const mat_t matrix
+) {
+    const double tolerance = 1.0e-9;
+    bool         ret       = NEAR_ZERO(matrix[12], tolerance) && NEAR_ZERO(matrix[13], tolerance) && NEAR_ZERO(matrix[14], tolerance) && NEAR_EQUAL(matrix[15], 1., tolerance);
+
+    for (size_t i = 0; ret && (i < 3); ++i) {
+        for (size_t j = 0; ret && (j < 3); ++j) {
+            double dot = matrix[4 * i] * matrix[4 * j] + matrix[4 * i + 1] * matrix[4 * j + 1] + matrix[4 * i + 2] * matrix[4 * j + 2];
+
+            ret = NEAR_EQUAL(dot, (i == j) ? 1. : 0., tolerance);
+        }
+    }
+
+    if (ret)
+        ret = (bn_mat_det3(matrix) > 0.);
+
+    return ret;
+}
+
+
+/// tests if the tessellation of a primitive of type \a minorType doesn't depend on the tessellation tolerances
+/** These primitives are bounded by planar faces. */
+static bool TessellationIsExact
+(
+    int minorType
+) {
+    bool ret = false;
+
+    switch (minorType) {
+        case ID_ARB8:
+        case ID_ARBN:
+        case ID_ARS:
+        case ID_POLY:
+        case ID_NMG:
+        case ID_BOT:
+        case ID_EBM:
+        case ID_VOL:
+            ret = true;
+    }
+
+    return ret;
+}
+
+
+/// records the solid for a later tessellation
+/** The internal of the first instance of a solid is taken over from db_walk_tree(), i.e. the solid is read only once.
+    Further instances which differ only by a rigid motion get the transformed tessellation of this prototype. */
+static tree* FacetizeLeaf
+(
+    db_tree_state*      tsp,
+    const db_full_path* pathp,
+    rt_db_internal*     ip,
+    void*               clientData
+) {
+    tree*         ret          = TREE_NULL;
+    FacetizeData* facetizeData = static_cast<FacetizeData*>(clientData);
+    directory*    pDir         = DB_FULL_PATH_CUR_DIR(pathp);
+
+    RT_CK_DB_INTERNAL(ip);
+
+    if ((ip->idb_meth != nullptr) && (ip->idb_meth->ft_tessellate != nullptr)) {
+        FacetizeSolid        leaf;
+        std::vector<size_t>& prototypes = facetizeData->prototypes[pDir];
+
+        BU_GET(ret, tree);
+        RT_TREE_INIT(ret);
+        ret->tr_op        = OP_NMG_TESS;
+        ret->tr_d.td_name = bu_strdup(pDir->d_namep);
+        ret->tr_d.td_r    = nullptr;
+
+        leaf.node      = ret;
+        leaf.pDir      = pDir;
+        leaf.ttol      = tsp->ts_ttol;
+        leaf.tol       = tsp->ts_tol;
+        leaf.prototype = facetizeData->leaves.size();
+        leaf.exact     = (ip->idb_major_type == DB5_MAJORTYPE_BRLCAD) && TessellationIsExact(ip->idb_minor_type);
+
+        RT_DB_INTERNAL_INIT(&leaf.internal);
+
+        for (size_t i = 0; i < prototypes.size(); ++i) {
+            mat_t inverse;
+
+            if (bn_mat_inverse(inverse, facetizeData->leaves[prototypes[i]].matrix) != 0) {
+                bn_mat_mul(leaf.matrix, tsp->ts_mat, inverse);
+
+                if (IsRigidMotion(leaf.matrix)) {
+                    leaf.prototype = prototypes[i];
+                    break;
+                }
+            }
+        }
+
+        if (leaf.prototype == facetizeData->leaves.size()) {
+            MAT_COPY(leaf.matrix, tsp->ts_mat);
+
+            if (!facetizeData->deferImport) {
+                facetizeData->completion(pDir, tsp->ts_mat, *ip);
+
+                leaf.internal = *ip;
+                bu_avs_init_empty(&leaf.internal.idb_avs);
+
+                // db_walk_tree() frees the attributes only
+                ip->idb_ptr = nullptr;
+            }
+
+            prototypes.push_back(leaf.prototype);
+        }
+
+        facetizeData->leaves.push_back(leaf);
+    }
+
+    return ret;
+}
+
+
+/// imports the internal of a prototype leaf which was skipped by a tree walk with FacetizeData::deferImport
+/** If the import fails the internal remains empty and the leaf won't be tessellated. */
+static void ImportLeafInternal
+(
+    FacetizeSolid&            leaf,
+    db_i*                     dbip,
+    resource*                 resp,
+    const InternalCompletion& completion
+) {
+    RT_DB_INTERNAL_INIT(&leaf.internal);
+
+    if (!BU_SETJUMP) {
+        if (rt_db_get_internal(&leaf.internal, leaf.pDir, dbip, leaf.matrix, resp) >= 0)
+            completion(leaf.pDir, leaf.matrix, leaf.internal);
+        else
+            RT_DB_INTERNAL_INIT(&leaf.internal);
+    }
+    else {
+        BU_UNSETJUMP;
+        RT_DB_INTERNAL_INIT(&leaf.internal);
+    }
+
+    BU_UNSETJUMP;
+}
+
+
+/// a librt resource for every thread of NonManifoldFor(), rt_uniresource may not be shared between threads
+class ThreadResources {
+public:
+    ThreadResources
+    (
+        size_t count,
+        bool   parallelNmg
+    ) : m_resources(parallelNmg ? std::max(size_t(1), ParallelThreads(count, 1)) : 1) {
+        for (size_t i = 0; i < m_resources.size(); ++i) {
+            if (!BU_SETJUMP)
+                rt_init_resource(&m_resources[i], static_cast<int>(i), nullptr);
+            else
+                BU_UNSETJUMP;
+
+            BU_UNSETJUMP;
+        }
+    }
+
+    ~ThreadResources(void) {
+        for (size_t i = 0; i < m_resources.size(); ++i) {
+            if (!BU_SETJUMP)
+                rt_clean_resource_basic(nullptr, &m_resources[i]);
+            else
+                BU_UNSETJUMP;
+
+            BU_UNSETJUMP;
+        }
+    }
+
+    resource* Get
+    (
+        size_t thread
+    ) {
+        return &m_resources[thread];
+    }
+
+private:
+    std::vector<resource> m_resources;
+};
+
+
+/// tessellates every prototype leaf into a model of its own and copies the tessellations to the other instances
+/** Leaves without a tree node are skipped. */
+static void TessellateLeaves
+(
+    std::vector<FacetizeSolid>& leaves,
+    db_i*                       dbip,
+    bool                        parallelNmg
+) {
+    std::vector<size_t> prototypes;
+    std::vector<size_t> instances;
+
+    for (size_t i = 0; i < leaves.size(); ++i) {
+        if (leaves[i].node == nullptr)
+            continue;
+
+        if (leaves[i].prototype == i)
+            prototypes.push_back(i);
+        else
+            instances.push_back(i);
+    }
+
+    NonManifoldFor(prototypes.size(), parallelNmg, [&leaves, &prototypes](size_t begin, size_t end, size_t) {
+        for (size_t i = begin; i < end; ++i) {
+            FacetizeSolid& leaf       = leaves[prototypes[i]];
+            model*         leafModel  = nullptr;
+            nmgregion*     leafRegion = nullptr;
+
+            if (leaf.internal.idb_meth == nullptr) // the import failed
+                continue;
+
+            if (!BU_SETJUMP) {
+                leafModel = nmg_mm();
+
+                if ((leaf.internal.idb_meth->ft_tessellate(&leafRegion, leafModel, &leaf.internal, leaf.ttol, leaf.tol) == 0) && (leafRegion != nullptr)) {
+                    NMG_CK_REGION(leafRegion);
+                    leaf.node->tr_d.td_r = leafRegion;
+                }
+                else {
+                    nmg_km(leafModel);
+                    leafModel = nullptr;
+                }
+            }
+            else {
+                BU_UNSETJUMP;
+
+                // the model may be in an inconsistent state
+                leaf.node->tr_d.td_r = nullptr;
+            }
+
+            BU_UNSETJUMP;
+        }
+    });
+
+    if (!instances.empty()) {
+        // the instances are imported from the external form of their prototype's tessellation
+        std::map<size_t, bu_external> externals;
+
+        for (size_t i = 0; i < instances.size(); ++i) {
+            size_t prototype = leaves[instances[i]].prototype;
+
+            if (leaves[prototype].node->tr_d.td_r != nullptr)
+                BU_EXTERNAL_INIT(&externals[prototype]);
+        }
+
+        std::vector<std::pair<size_t, bu_external*> > exports(externals.size());
+        size_t                                          index = 0;
+
+        for (auto external = externals.begin(); external != externals.end(); ++external, ++index)
+            exports[index] = std::make_pair(external->first, &external->second);
+
+        ThreadResources exportResources(exports.size(), parallelNmg);
+
+        NonManifoldFor(exports.size(), parallelNmg, [&leaves, &exports, &exportResources, dbip](size_t begin, size_t end, size_t thread) {
+            for (size_t i = begin; i < end; ++i) {
+                rt_db_internal intern;
+
+                RT_DB_INTERNAL_INIT(&intern);
+                intern.idb_major_type = DB5_MAJORTYPE_BRLCAD;
+                intern.idb_minor_type = ID_NMG;
+                intern.idb_meth       = &OBJ[ID_NMG];
+                intern.idb_ptr        = leaves[exports[i].first].node->tr_d.td_r->m_p;
+
+                if (!BU_SETJUMP) {
+                    if (OBJ[ID_NMG].ft_export5(exports[i].second, &intern, 1., dbip, exportResources.Get(thread)) != 0)
+                        exports[i].second->ext_buf = nullptr;
+                }
+                else {
+                    BU_UNSETJUMP;
+                    exports[i].second->ext_buf = nullptr;
+                }
+
+                BU_UNSETJUMP;
+            }
+        });
+
+        ThreadResources importResources(instances.size(), parallelNmg);
+
+        NonManifoldFor(instances.size(), parallelNmg, [&leaves, &instances, &externals, &importResources, dbip](size_t begin, size_t end, size_t thread) {
+            for (size_t i = begin; i < end; ++i) {
+                FacetizeSolid& leaf     = leaves[instances[i]];
+                auto           external = externals.find(leaf.prototype);
+
+                if ((external != externals.end()) && (external->second.ext_buf != nullptr)) {
+                    rt_db_internal intern;
+
+                    RT_DB_INTERNAL_INIT(&intern);
+
+                    if (!BU_SETJUMP) {
+                        if (OBJ[ID_NMG].ft_import5(&intern, &external->second, leaf.matrix, dbip, importResources.Get(thread)) == 0) {
+                            model* leafModel = static_cast<model*>(intern.idb_ptr);
+
+                            NMG_CK_MODEL(leafModel);
+
+                            if (BU_LIST_NON_EMPTY(&leafModel->r_hd))
+                                leaf.node->tr_d.td_r = BU_LIST_FIRST(nmgregion, &leafModel->r_hd);
+                            else
+                                nmg_km(leafModel);
+                        }
+                    }
+                    else {
+                        BU_UNSETJUMP;
+                        leaf.node->tr_d.td_r = nullptr;
+                    }
+
+                    BU_UNSETJUMP;
+                }
+            }
+        });
+
+        for (auto external = externals.begin(); external != externals.end(); ++external) {
+            if (external->second.ext_buf != nullptr)
+                bu_free_external(&external->second);
+        }
+    }
+}
+
+
+static void FreeLeafInternals
+(
+    std::vector<FacetizeSolid>& leaves
+) {
+    for (size_t i = 0; i < leaves.size(); ++i) {
+        if (leaves[i].prototype == i)
+            rt_db_free_internal(&leaves[i].internal);
+    }
+}
+
+
+/// removes the leaves without tessellation from a boolean tree
+static tree* PruneFailedLeaves
+(
+    tree* tp
+) {
+    tree* ret = tp;
+
+    if (tp != TREE_NULL) {
+        switch (tp->tr_op) {
+            case OP_NMG_TESS:
+                if (tp->tr_d.td_r == nullptr) {
+                    db_free_tree(tp);
+                    ret = TREE_NULL;
+                }
+                break;
+
+            case OP_UNION:
+            case OP_SUBTRACT:
+            case OP_INTERSECT: {
+                tree* left  = PruneFailedLeaves(tp->tr_b.tb_left);
+                tree* right = PruneFailedLeaves(tp->tr_b.tb_right);
+
+                tp->tr_b.tb_left  = left;
+                tp->tr_b.tb_right = right;
+
+                if ((left == TREE_NULL) || (right == TREE_NULL)) {
+                    if ((tp->tr_op == OP_UNION) && (left == TREE_NULL))
+                        ret = right;
+                    else if ((tp->tr_op != OP_INTERSECT) && (right == TREE_NULL))
+                        ret = left;
+                    else {
+                        ret = TREE_NULL;
+
+                        if (left != TREE_NULL)
+                            db_free_tree(left);
+
+                        if (right != TREE_NULL)
+                            db_free_tree(right);
+                    }
+
+                    BU_PUT(tp, tree);
+                }
+                break;
+            }
+
+            default:
+                db_free_tree(tp);
+                ret = TREE_NULL;
+        }
+    }
+
+    return ret;
+}
+
+
+static void CollectLeafModels
+(
+    tree*                tp,
+    std::vector<model*>& models
+) {
+    if (tp->tr_op == OP_NMG_TESS)
+        models.push_back(tp->tr_d.td_r->m_p);
+    else {
+        CollectLeafModels(tp->tr_b.tb_left, models);
+        CollectLeafModels(tp->tr_b.tb_right, models);
+    }
+}
+
+
+/// evaluates a boolean tree whose leaves are tessellated into models of their own
+/** \a failed is set if the evaluation fails, an empty result isn't a failure.
+    \return an OP_NMG_TESS node with the resulting region in a model of its own, or TREE_NULL */
+static tree* EvaluateTree
+(
+    tree*         tp,
+    const bn_tol* tol,
+    bool&         failed
+) {
+    tree* ret = PruneFailedLeaves(tp);
+
+    if (ret != TREE_NULL) {
+        std::vector<model*> models;
+
+        CollectLeafModels(ret, models);
+
+        // nmg_boolean() needs all regions in one model
+        for (size_t i = 1; i < models.size(); ++i)
+            nmg_merge_models(models[0], models[i]);
+
+        bu_list vlfree;
+        bool    evaluated = false;
+
+        BU_LIST_INIT(&vlfree);
+
+        if (!BU_SETJUMP) {
+            nmg_boolean(ret, models[0], &vlfree, tol);
+            evaluated = true;
+        }
+        else
+            BU_UNSETJUMP;
+
+        BU_UNSETJUMP;
+
+        bv_vlist_cleanup(&vlfree);
+
+        if (!evaluated || (ret->tr_op != OP_NMG_TESS) || (ret->tr_d.td_r == nullptr)) {
+            // nmg_boolean() leaves an OP_NOP node for an empty result
+            if (!evaluated || ((ret->tr_op != OP_NOP) && (ret->tr_op != OP_NMG_TESS)))
+                failed = true;
+
+            db_free_tree(ret);
+            nmg_km(models[0]);
+            ret = TREE_NULL;
+        }
+    }
+
+    return ret;
+}
+
+
+static void FreeResults
+(
+    std::vector<tree*>& results
+) {
+    for (size_t i = 0; i < results.size(); ++i) {
+        if (results[i] != TREE_NULL)
+            db_free_tree(results[i]);
+    }
+
+    results.clear();
+}
+
+
+/// evaluates the region trees, in parallel if \a parallelNmg is set
+/** \a failed is set if the evaluation of a region fails.
+    \return the results in the order of \a regions, TREE_NULL where the evaluation failed or the region is empty */
+static std::vector<tree*> EvaluateRegions
+(
+    std::vector<tree*>& regions,
+    const bn_tol*       tol,
+    bool                parallelNmg,
+    bool&               failed
+) {
+    std::vector<tree*> ret(regions.size(), TREE_NULL);
+    std::vector<char>  regionFailed(regions.size(), 0);
+
+    NonManifoldFor(regions.size(), parallelNmg, [&regions, &ret, &regionFailed, tol](size_t begin, size_t end, size_t) {
+        for (size_t i = begin; i < end; ++i) {
+            bool evaluationFailed = false;
+
+            ret[i]          = EvaluateTree(regions[i], tol, evaluationFailed);
+            regionFailed[i] = evaluationFailed;
+        }
+    });
+
+    regions.clear();
+
+    if (std::find(regionFailed.begin(), regionFailed.end(), 1) != regionFailed.end())
+        failed = true;
+
+    return ret;
+}
+
+
+/// unites the results of the region evaluations pairwise, the pairs are evaluated in parallel if \a parallelNmg is set
+/** If a union fails the whole union fails, the model wouldn't contain all regions otherwise.
+    \return the model of the union, or nullptr if there is nothing or a union failed */
+static model* UniteResults
+(
+    std::vector<tree*>& results,
+    const bn_tol*       tol,
+    bool                parallelNmg
+) {
+    bool failed = false;
+
+    results.erase(std::remove(results.begin(), results.end(), TREE_NULL), results.end());
+
+    while (!failed && (results.size() > 1)) {
+        size_t            pairs = results.size() / 2;
+        std::vector<char> pairFailed(pairs, 0);
+
+        NonManifoldFor(pairs, parallelNmg, [&results, &pairFailed, tol](size_t begin, size_t end, size_t) {
+            for (size_t i = begin; i < end; ++i) {
+                tree* unionTree;
+                bool  unionFailed = false;
+
+                BU_GET(unionTree, tree);
+                RT_TREE_INIT(unionTree);
+                unionTree->tr_op           = OP_UNION;
+                unionTree->tr_b.tb_regionp = REGION_NULL;
+                unionTree->tr_b.tb_left    = results[2 * i];
+                unionTree->tr_b.tb_right   = results[2 * i + 1];
+
+                results[2 * i]     = EvaluateTree(unionTree, tol, unionFailed);
+                results[2 * i + 1] = TREE_NULL;
+                pairFailed[i]      = unionFailed;
+            }
+        });
+
+        failed = (std::find(pairFailed.begin(), pairFailed.end(), 1) != pairFailed.end());
+        results.erase(std::remove(results.begin(), results.end(), TREE_NULL), results.end());
+    }
+
+    model* ret = nullptr;
+
+    if (!failed && !results.empty()) {
+        // the tree node shouldn't take the region with it
+        ret                   = results[0]->tr_d.td_r->m_p;
+        results[0]->tr_d.td_r = nullptr;
+        db_free_tree(results[0]);
+        results.clear();
+    }
+
+    FreeResults(results);
+
+    return ret;
+}
+
+
+/// evaluates the region trees and unites their results pairwise
+/** \return the model of the union, or nullptr if there is nothing or an evaluation failed */
+static model* FacetizeRegions
+(
+    std::vector<tree*>& regions,
+    const bn_tol*       tol,
+    bool                parallelNmg
+) {
+    model*             ret     = nullptr;
+    bool               failed  = false;
+    std::vector<tree*> results = EvaluateRegions(regions, tol, parallelNmg, failed);
+
+    if (failed)
+        FreeResults(results);
+    else
+        ret = UniteResults(results, tol, parallelNmg);
+
+    return ret;
+}
+
+
+/// facetizes the tree of \a objectName with the tolerances of \a rtip
+/** \return the model of the result, or nullptr */
+static model* FacetizeTree
+(
+    rt_i*                     rtip,
+    const char*               objectName,
+    const InternalCompletion& completion,
+    bool                      parallelNmg
+) {
+    model*        ret = nullptr;
+    FacetizeData  facetizeData(completion);
+    db_tree_state initState;
+
+    db_init_db_tree_state(&initState, rtip->rti_dbip);
+    initState.ts_ttol = &rtip->rti_ttol;
+    initState.ts_tol  = &rtip->rti_tol;
+
+    // the database is read serially, the tessellation and the booleans may run in parallel
+    int walkResult = db_walk_tree(rtip->rti_dbip,
+                                  1,
+                                  &objectName,
+                                  1,
+                                  &initState,
+                                  nullptr,
+                                  FacetizeRegionEnd,
+                                  FacetizeLeaf,
+                                  &facetizeData);
+
+    if (walkResult == 0) {
+        TessellateLeaves(facetizeData.leaves, rtip->rti_dbip, parallelNmg);
+        FreeLeafInternals(facetizeData.leaves);
+
+        ret = FacetizeRegions(facetizeData.regions, &rtip->rti_tol, parallelNmg);
+    }
+    else {
+        // nothing is tessellated yet, i.e. the leaves have no models which the trees don't free
+        FreeLeafInternals(facetizeData.leaves);
+
+        for (size_t i = 0; i < facetizeData.regions.size(); ++i)
+            db_free_tree(facetizeData.regions[i]);
+    }
+
+    return ret;
+}
+
+
+static tree* NewLeafNode
+(
+    const char* name
+) {
+    tree* ret;
+
+    BU_GET(ret, tree);
+    RT_TREE_INIT(ret);
+    ret->tr_op        = OP_NMG_TESS;
+    ret->tr_d.td_name = bu_strdup(name);
+    ret->tr_d.td_r    = nullptr;
+
+    return ret;
+}
+
+
+/// tessellates the leaves which have a tree node
+/** Prototypes without a node get a temporary one for the tessellation of their instances. */
+static void TessellateLeafSubset
+(
+    std::vector<FacetizeSolid>& leaves,
+    db_i*                       dbip,
+    bool                        parallelNmg
+) {
+    std::vector<tree*> prototypeNodes;
+
+    for (size_t i = 0; i < leaves.size(); ++i) {
+        FacetizeSolid& prototype = leaves[leaves[i].prototype];
+
+        if ((leaves[i].node != nullptr) && (prototype.node == nullptr)) {
+            prototype.node = NewLeafNode(leaves[i].node->tr_d.td_name);
+            prototypeNodes.push_back(prototype.node);
+        }
+    }
+
+    TessellateLeaves(leaves, dbip, parallelNmg);
+
+    for (size_t i = 0; i < prototypeNodes.size(); ++i)
+        db_free_tree(prototypeNodes[i]);
+}
+
+
+/// copies a region tree for an other level of detail, the copies of the leaves are recorded in \a leafCopies
+static tree* CopyRegionTree
+(
+    const tree*                             tp,
+    std::unordered_map<const tree*, tree*>& leafCopies
+) {
+    tree* ret = TREE_NULL;
+
+    switch (tp->tr_op) {
+        case OP_NMG_TESS:
+            ret            = NewLeafNode(tp->tr_d.td_name);
+            leafCopies[tp] = ret;
+            break;
+
+        case OP_UNION:
+        case OP_SUBTRACT:
+        case OP_INTERSECT:
+            BU_GET(ret, tree);
+            RT_TREE_INIT(ret);
+            ret->tr_op           = tp->tr_op;
+            ret->tr_b.tb_regionp = REGION_NULL;
+            ret->tr_b.tb_left    = CopyRegionTree(tp->tr_b.tb_left, leafCopies);
+            ret->tr_b.tb_right   = CopyRegionTree(tp->tr_b.tb_right, leafCopies);
+            break;
+
+        default:
+            // will be pruned by EvaluateTree()
+            BU_GET(ret, tree);
+            RT_TREE_INIT(ret);
+            ret->tr_op = OP_NOP;
+    }
+
+    return ret;
+}
+
+
+/// tests if the evaluation of a region tree doesn't depend on the tessellation tolerances
+static bool TreeIsExact
+(
+    const tree*                                    tp,
+    const std::vector<FacetizeSolid>&              leaves,
+    const std::unordered_map<const tree*, size_t>& leafIndices
+) {
+    bool ret = true;
+
+    switch (tp->tr_op) {
+        case OP_NMG_TESS: {
+            auto leafIndex = leafIndices.find(tp);
+
+            ret = (leafIndex != leafIndices.end()) && leaves[leafIndex->second].exact;
+            break;
+        }
+
+        case OP_UNION:
+        case OP_SUBTRACT:
+        case OP_INTERSECT:
+            ret = TreeIsExact(tp->tr_b.tb_left, leaves, leafIndices) && TreeIsExact(tp->tr_b.tb_right, leaves, leafIndices);
+    }
+
+    return ret;
+}
+
+
+/// copies the result of a region evaluation into a model of its own
+static tree* CloneResult
+(
+    const tree* result
+) {
+    tree*  ret  = TREE_NULL;
+    model* copy = nmg_clone_model(result->tr_d.td_r->m_p);
+
+    if (BU_LIST_NON_EMPTY(&copy->r_hd)) {
+        ret            = NewLeafNode(result->tr_d.td_name);
+        ret->tr_d.td_r = BU_LIST_FIRST(nmgregion, &copy->r_hd);
+    }
+    else
+        nmg_km(copy);
+
+    return ret;
+}
+
+
+static bool SameTessellationTolerance
+(
+    const bg_tess_tol& first,
+    const bg_tess_tol& second
+) {
+    return (first.abs == second.abs) && (first.rel == second.rel) && (first.norm == second.norm);
+}
+
+
+/// facetizes the tree of \a objectName once per level of detail
+/** The tree is walked and the solids are read only once.
+    The levels get copies of the region trees.
+    Regions which don't depend on the tessellation tolerances are evaluated on the first level only, the other levels get copies of the results.
+    \a results gets the models of the levels, nullptr where there is nothing. */
+static void FacetizeTreeLevels
+(
+    rt_i*                     rtip,
+    const char*               objectName,
+    const InternalCompletion& completion,
+    bool                      parallelNmg,
+    size_t                    numberOfLevels,
+    const bg_tess_tol*        levelTolerances,
+    model**                   results
+) {
+    FacetizeData  facetizeData(completion);
+    db_tree_state initState;
+
+    for (size_t i = 0; i < numberOfLevels; ++i)
+        results[i] = nullptr;
+
+    db_init_db_tree_state(&initState, rtip->rti_dbip);
+    initState.ts_ttol = &levelTolerances[0];
+    initState.ts_tol  = &rtip->rti_tol;
+
+    int walkResult = db_walk_tree(rtip->rti_dbip,
+                                  1,
+                                  &objectName,
+                                  1,
+                                  &initState,
+                                  nullptr,
+                                  FacetizeRegionEnd,
+                                  FacetizeLeaf,
+                                  &facetizeData);
+
+    if (walkResult == 0) {
+        const std::vector<FacetizeSolid>&       leaves  = facetizeData.leaves;
+        const std::vector<tree*>&               regions = facetizeData.regions;
+        std::unordered_map<const tree*, size_t> leafIndices;
+        std::vector<bool>                       exactRegions(regions.size());
+        std::vector<size_t>                     sameLevel(numberOfLevels);
+
+        for (size_t i = 0; i < leaves.size(); ++i)
+            leafIndices[leaves[i].node] = i;
+
+        for (size_t i = 0; i < regions.size(); ++i)
+            exactRegions[i] = TreeIsExact(regions[i], leaves, leafIndices);
+
+        for (size_t i = 0; i < numberOfLevels; ++i) {
+            sameLevel[i] = i;
+
+            for (size_t j = 0; j < i; ++j) {
+                if (SameTessellationTolerance(levelTolerances[i], levelTolerances[j])) {
+                    sameLevel[i] = j;
+                    break;
+                }
+            }
+        }
+
+        // the further levels get copies of the trees, made before the booleans consume them
+        std::vector<std::vector<FacetizeSolid> > levelLeaves(numberOfLevels);
+        std::vector<std::vector<tree*> >         levelRegions(numberOfLevels);
+        std::vector<std::vector<tree*> >         levelResults(numberOfLevels);
+
+        levelLeaves[0]  = leaves;
+        levelRegions[0] = regions;
+
+        for (size_t i = 1; i < numberOfLevels; ++i) {
+            if (sameLevel[i] != i)
+                continue;
+
+            std::unordered_map<const tree*, tree*> leafCopies;
+
+            levelRegions[i].resize(regions.size(), TREE_NULL);
+
+            for (size_t j = 0; j < regions.size(); ++j) {
+                if (!exactRegions[j])
+                    levelRegions[i][j] = CopyRegionTree(regions[j], leafCopies);
+            }
+
+            levelLeaves[i] = leaves;
+
+            for (size_t j = 0; j < leaves.size(); ++j) {
+                auto leafCopy = leafCopies.find(leaves[j].node);
+
+                levelLeaves[i][j].node = (leafCopy != leafCopies.end()) ? leafCopy->second : nullptr;
+                levelLeaves[i][j].ttol = &levelTolerances[i];
+            }
+        }
+
+        // the exact regions of the further levels fail with the ones of the first level
+        bool firstLevelFailed = false;
+
+        for (size_t i = 0; i < numberOfLevels; ++i) {
+            if (sameLevel[i] != i)
+                continue;
+
+            TessellateLeafSubset(levelLeaves[i], rtip->rti_dbip, parallelNmg);
+
+            bool               failed        = false;
+            std::vector<tree*> regionResults = EvaluateRegions(levelRegions[i], &rtip->rti_tol, parallelNmg, failed);
+
+            if (i == 0) {
+                firstLevelFailed = failed;
+
+                // the results of the regions which don't depend on the tolerances are copied to the other levels
+                for (size_t j = 1; j < numberOfLevels; ++j) {
+                    if (sameLevel[j] == j) {
+                        levelResults[j].resize(regions.size(), TREE_NULL);
+
+                        for (size_t k = 0; k < regions.size(); ++k) {
+                            if (exactRegions[k] && (regionResults[k] != TREE_NULL))
+                                levelResults[j][k] = CloneResult(regionResults[k]);
+                        }
+                    }
+                }
+            }
+            else {
+                for (size_t j = 0; j < regions.size(); ++j) {
+                    if (exactRegions[j]) {
+                        regionResults[j] = levelResults[i][j];
+
+                        if (firstLevelFailed)
+                            failed = true;
+                    }
+                }
+            }
+
+            if (failed)
+                FreeResults(regionResults);
+            else
+                results[i] = UniteResults(regionResults, &rtip->rti_tol, parallelNmg);
+        }
+
+        for (size_t i = 1; i < numberOfLevels; ++i) {
+            if ((sameLevel[i] != i) && (results[sameLevel[i]] != nullptr))
+                results[i] = nmg_clone_model(results[sameLevel[i]]);
+        }
+    }
+    else {
+        for (size_t i = 0; i < facetizeData.regions.size(); ++i)
+            db_free_tree(facetizeData.regions[i]);
+    }
+
+    FreeLeafInternals(facetizeData.leaves);
+}
+
+
+static void AppendUint32
+(
+    std::vector<unsigned char>& data,
+    uint32_t                    value
+) {
+    for (size_t i = 0; i < 4; ++i)
+        data.push_back(static_cast<unsigned char>((value >> (8 * i)) & 0xff));
+}
+
+
+/// appends \a value as little endian IEEE 754 single precision number
+static void AppendFloat
+(
+    std::vector<unsigned char>& data,
+    double                      value
+) {
+    float    single = static_cast<float>(value);
+    uint32_t bits;
+
+    memcpy(&bits, &single, sizeof(bits));
+    AppendUint32(data, bits);
+}
+
+
+static void AppendText
+(
+    std::vector<unsigned char>& data,
+    const char*                 text
+) {
+    data.insert(data.end(), text, text + strlen(text));
+}
+
+
+/// the header of the export file with fixed size, i.e. it can be overwritten with the final counts
+static std::vector<unsigned char> ExportHeader
+(
+    ConstDatabase::MeshFormat format,
+    size_t                    numberOfVertices,
+    size_t                    numberOfFaces
+) {
+    std::vector<unsigned char> ret;
+
+    switch (format) {
+        case ConstDatabase::MeshFormat::BinaryStl:
+            // mustn't start with "solid", which would indicate an ASCII STL file
+            AppendText(ret, "binary STL, facetized by BRL-CAD");
+            ret.resize(80, ' ');
+            AppendUint32(ret, static_cast<uint32_t>(numberOfFaces));
+            break;
+
+        case ConstDatabase::MeshFormat::BinaryPly: {
+            char counts[128];
+
+            AppendText(ret, "ply\nformat binary_little_endian 1.0\ncomment facetized by BRL-CAD\n");
+            snprintf(counts, sizeof(counts), "element vertex %010llu\n", static_cast<unsigned long long>(numberOfVertices));
+            AppendText(ret, counts);
+            AppendText(ret, "property float x\nproperty float y\nproperty float z\n");
+            snprintf(counts, sizeof(counts), "element face %010llu\n", static_cast<unsigned long long>(numberOfFaces));
+            AppendText(ret, counts);
+            AppendText(ret, "property list uchar int vertex_indices\nend_header\n");
+            break;
+        }
+
+        case ConstDatabase::MeshFormat::Obj:
+            AppendText(ret, "# facetized by BRL-CAD\n");
+    }
+
+    return ret;
+}
+
+
+/// a region's facetization serialized for the export
+struct ExportChunk {
+    rt_bot_internal*           bot;
+    size_t                     firstVertex; ///< index of the first vertex in the whole export
+    std::vector<unsigned char> data;        ///< STL triangles, PLY vertices or OBJ text
+    std::vector<unsigned char> faces;       ///< PLY faces
+};
+
+
+static void SerializeChunk
+(
+    ExportChunk&              chunk,
+    ConstDatabase::MeshFormat format,
+    const std::string&        regionName
+) {
+    const rt_bot_internal& bot     = *chunk.bot;
+    bool                   flipped = (bot.orientation == RT_BOT_CW);
+
+    switch (format) {
+        case ConstDatabase::MeshFormat::BinaryStl:
+            chunk.data.reserve(50 * bot.num_faces);
+
+            for (size_t i = 0; i < bot.num_faces; ++i) {
+                const fastf_t* corners[3];
+                vect_t         edge1;
+                vect_t         edge2;
+                vect_t         normal;
+
+                for (size_t j = 0; j < 3; ++j)
+                    corners[j] = bot.vertices + 3 * bot.faces[3 * i + j];
+
+                if (flipped)
+                    std::swap(corners[1], corners[2]);
+
+                VSUB2(edge1, corners[1], corners[0]);
+                VSUB2(edge2, corners[2], corners[0]);
+                VCROSS(normal, edge1, edge2);
+
+                if (MAGNITUDE(normal) > SMALL_FASTF)
+                    VUNITIZE(normal);
+                else
+                    VSETALL(normal, 0.);
+
+                for (size_t j = 0; j < 3; ++j)
+                    AppendFloat(chunk.data, normal[j]);
+
+                for (size_t j = 0; j < 3; ++j) {
+                    for (size_t k = 0; k < 3; ++k)
+                        AppendFloat(chunk.data, corners[j][k]);
+                }
+
+                // attribute byte count
+                chunk.data.push_back(0);
+                chunk.data.push_back(0);
+            }
+            break;
+
+        case ConstDatabase::MeshFormat::BinaryPly:
+            chunk.data.reserve(12 * bot.num_vertices);
+            chunk.faces.reserve(13 * bot.num_faces);
+
+            for (size_t i = 0; i < 3 * bot.num_vertices; ++i)
+                AppendFloat(chunk.data, bot.vertices[i]);
+
+            for (size_t i = 0; i < bot.num_faces; ++i) {
+                chunk.faces.push_back(3);
+
+                for (size_t j = 0; j < 3; ++j) {
+                    size_t corner = (flipped && (j > 0)) ? (3 - j) : j;
+
+                    AppendUint32(chunk.faces, static_cast<uint32_t>(chunk.firstVertex + bot.faces[3 * i + corner]));
+                }
+            }
+            break;
+
+        case ConstDatabase::MeshFormat::Obj: {
+            char line[256];
+
+            AppendText(chunk.data, "o ");
+            AppendText(chunk.data, regionName.c_str());
+            AppendText(chunk.data, "\n");
+
+            for (size_t i = 0; i < bot.num_vertices; ++i) {
+                snprintf(line, sizeof(line), "v %.9g %.9g %.9g\n", bot.vertices[3 * i], bot.vertices[3 * i + 1], bot.vertices[3 * i + 2]);
+                AppendText(chunk.data, line);
+            }
+
+            // relative indices, i.e. the chunk doesn't depend on the vertices before
+            for (size_t i = 0; i < bot.num_faces; ++i) {
+                long long corners[3];
+
+                for (size_t j = 0; j < 3; ++j) {
+                    size_t corner = (flipped && (j > 0)) ? (3 - j) : j;
+
+                    corners[j] = static_cast<long long>(bot.faces[3 * i + corner]) - static_cast<long long>(bot.num_vertices);
+                }
+
+                snprintf(line, sizeof(line), "f %lld %lld %lld\n", corners[0], corners[1], corners[2]);
+                AppendText(chunk.data, line);
+            }
+        }
+    }
+}
+
+
+static void FreeBot
+(
+    rt_bot_internal* bot
+) {
+    rt_db_internal intern;
+
+    RT_DB_INTERNAL_INIT(&intern);
+    intern.idb_major_type = DB5_MAJORTYPE_BRLCAD;
+    intern.idb_minor_type = ID_BOT;
+    intern.idb_meth       = &OBJ[ID_BOT];
+    intern.idb_ptr        = bot;
+
+    rt_db_free_internal(&intern);
+}
+
+
+static void CollectLeafIndices
+(
+    const tree*                                    tp,
+    const std::unordered_map<const tree*, size_t>& leafIndices,
+    std::vector<size_t>&                           indices
+) {
+    switch (tp->tr_op) {
+        case OP_NMG_TESS: {
+            auto leafIndex = leafIndices.find(tp);
+
+            if (leafIndex != leafIndices.end())
+                indices.push_back(leafIndex->second);
+            break;
+        }
+
+        case OP_UNION:
+        case OP_SUBTRACT:
+        case OP_INTERSECT:
+            CollectLeafIndices(tp->tr_b.tb_left, leafIndices, indices);
+            CollectLeafIndices(tp->tr_b.tb_right, leafIndices, indices);
+    }
+}
+
+
+/// facetizes the regions of the tree of \a objectName in batches and writes them to \a sink in the order of the tree
+/** Only the solids and facetizations of the current batch are held in memory, the solids are freed after their last use.
+    \a numberOfVertices and \a numberOfFaces are increased by the written vertices and faces.
+    The faces of a PLY file are written to \a plyFaces.
+    \return false if writing failed */
+static bool ExportTree
+(
+    rt_i*                            rtip,
+    resource*                        resp,
+    const char*                      objectName,
+    const InternalCompletion&        completion,
+    bool                             parallelNmg,
+    ConstDatabase::MeshFormat        format,
+    const ConstDatabase::ExportSink& sink,
+    size_t&                          position,
+    FILE*                            plyFaces,
+    size_t&                          numberOfVertices,
+    size_t&                          numberOfFaces
+) {
+    bool          ret = true;
+    FacetizeData  facetizeData(completion, true);
+    db_tree_state initState;
+
+    db_init_db_tree_state(&initState, rtip->rti_dbip);
+    initState.ts_ttol = &rtip->rti_ttol;
+    initState.ts_tol  = &rtip->rti_tol;
+
+    int walkResult = db_walk_tree(rtip->rti_dbip,
+                                  1,
+                                  &objectName,
+                                  1,
+                                  &initState,
+                                  nullptr,
+                                  FacetizeRegionEnd,
+                                  FacetizeLeaf,
+                                  &facetizeData);
+
+    std::vector<FacetizeSolid>& leaves    = facetizeData.leaves;
+    std::vector<tree*>&         regions   = facetizeData.regions;
+    size_t                      batchSize = std::max(size_t(1), 2 * ParallelThreads(regions.size(), 1));
+
+    if (walkResult == 0) {
+        std::unordered_map<const tree*, size_t> leafIndices;
+        std::vector<std::vector<size_t> >       regionLeaves(regions.size());
+        std::vector<size_t>                     firstBatch(leaves.size(), SIZE_MAX);
+        std::vector<size_t>                     lastBatch(leaves.size(), 0);
+
+        for (size_t i = 0; i < leaves.size(); ++i)
+            leafIndices[leaves[i].node] = i;
+
+        for (size_t i = 0; i < regions.size(); ++i) {
+            CollectLeafIndices(regions[i], leafIndices, regionLeaves[i]);
+
+            for (size_t j = 0; j < regionLeaves[i].size(); ++j) {
+                size_t prototype = leaves[regionLeaves[i][j]].prototype;
+
+                firstBatch[prototype] = std::min(firstBatch[prototype], i / batchSize);
+                lastBatch[prototype]  = i / batchSize;
+            }
+        }
+
+        size_t batch = 0;
+
+        for (; ret && (batch * batchSize < regions.size()); ++batch) {
+            size_t begin = batch * batchSize;
+            size_t end   = std::min(begin + batchSize, regions.size());
+
+            // the solids are held in memory from the first to the last batch which needs them
+            for (size_t i = 0; i < leaves.size(); ++i) {
+                if ((leaves[i].prototype == i) && (firstBatch[i] == batch))
+                    ImportLeafInternal(leaves[i], rtip->rti_dbip, resp, completion);
+            }
+
+            std::vector<FacetizeSolid> batchLeaves(leaves);
+
+            for (size_t i = 0; i < batchLeaves.size(); ++i)
+                batchLeaves[i].node = nullptr;
+
+            for (size_t i = begin; i < end; ++i) {
+                for (size_t j = 0; j < regionLeaves[i].size(); ++j)
+                    batchLeaves[regionLeaves[i][j]].node = leaves[regionLeaves[i][j]].node;
+            }
+
+            TessellateLeafSubset(batchLeaves, rtip->rti_dbip, parallelNmg);
+
+            for (size_t i = 0; i < leaves.size(); ++i) {
+                if ((leaves[i].prototype == i) && (lastBatch[i] == batch))
+                    rt_db_free_internal(&leaves[i].internal);
+            }
+
+            bool                     failed = false;
+            std::vector<tree*>       batchRegions(regions.begin() + begin, regions.begin() + end);
+            std::vector<tree*>       results = EvaluateRegions(batchRegions, &rtip->rti_tol, parallelNmg, failed);
+
+            // the file mustn't miss a region silently
+            if (failed) {
+                FreeResults(results);
+                ret = false;
+            }
+
+            std::vector<ExportChunk> chunks(results.size());
+
+            NonManifoldFor(results.size(), parallelNmg, [&results, &chunks, rtip](size_t chunkBegin, size_t chunkEnd, size_t) {
+                for (size_t i = chunkBegin; i < chunkEnd; ++i) {
+                    chunks[i].bot = nullptr;
+
+                    if (results[i] != TREE_NULL) {
+                        bu_list vlfree;
+
+                        BU_LIST_INIT(&vlfree);
+
+                        if (!BU_SETJUMP)
+                            chunks[i].bot = nmg_mdl_to_bot(results[i]->tr_d.td_r->m_p, &vlfree, &rtip->rti_tol);
+                        else
+                            BU_UNSETJUMP;
+
+                        BU_UNSETJUMP;
+
+                        bv_vlist_cleanup(&vlfree);
+                        db_free_tree(results[i]);
+                    }
+                }
+            });
+
+            for (size_t i = 0; i < chunks.size(); ++i) {
+                if (chunks[i].bot != nullptr) {
+                    chunks[i].firstVertex = numberOfVertices;
+                    numberOfVertices     += chunks[i].bot->num_vertices;
+                    numberOfFaces        += chunks[i].bot->num_faces;
+                }
+            }
+
+            ParallelFor(chunks.size(), 1, [&chunks, &facetizeData, format, begin](size_t chunkBegin, size_t chunkEnd, size_t) {
+                for (size_t i = chunkBegin; i < chunkEnd; ++i) {
+                    if (chunks[i].bot != nullptr) {
+                        SerializeChunk(chunks[i], format, facetizeData.regionNames[begin + i]);
+                        FreeBot(chunks[i].bot);
+                        chunks[i].bot = nullptr;
+                    }
+                }
+            });
+
+            for (size_t i = 0; ret && (i < chunks.size()); ++i) {
+                if (!chunks[i].data.empty()) {
+                    ret       = sink(position, chunks[i].data.data(), chunks[i].data.size());
+                    position += chunks[i].data.size();
+                }
+
+                if (ret && !chunks[i].faces.empty())
+                    ret = (fwrite(chunks[i].faces.data(), 1, chunks[i].faces.size(), plyFaces) == chunks[i].faces.size());
+            }
+
+            if (!ret) {
+                for (size_t i = end; i < regions.size(); ++i)
+                    db_free_tree(regions[i]);
+            }
+        }
+
+        // the solids of the batches which were processed when an error occurred
+        for (size_t i = 0; i < leaves.size(); ++i) {
+            if ((leaves[i].prototype == i) && (firstBatch[i] < batch) && (lastBatch[i] >= batch))
+                rt_db_free_internal(&leaves[i].internal);
+        }
+    }
+    else {
+        // no internal was imported
+        for (size_t i = 0; i < regions.size(); ++i)
+            db_free_tree(regions[i]);
+    }
+
+    return ret;
+}
+
+
+#ifdef HAVE_MANIFOLD
+/// converts a bag of triangles to a mesh of the manifold library
+/** The vertices are transformed by \a matrix if it isn't nullptr.
+    \a mirrored inverts the orientation of the faces, e.g. if the vertices were transformed by a mirroring matrix on import.
+    \return false if the orientation of the faces is unknown */
+static bool BotToMesh
+(
+    const rt_bot_internal& bot,
+    const fastf_t*         matrix,
+    bool                   mirrored,
+    manifold::MeshGL64&    mesh
+) {
+    bool ret = (bot.orientation == RT_BOT_CCW) || (bot.orientation == RT_BOT_CW);
+
+    if (ret) {
+        mesh.numProp = 3;
+        mesh.vertProperties.resize(3 * bot.num_vertices);
+        mesh.triVerts.resize(3 * bot.num_faces);
+
+        for (size_t i = 0; i < bot.num_vertices; ++i) {
+            point_t vertex;
+
+            if (matrix != nullptr)
+                MAT4X3PNT(vertex, matrix, bot.vertices + 3 * i);
+            else
+                VMOVE(vertex, bot.vertices + 3 * i);
+
+            mesh.vertProperties[3 * i]     = vertex[X];
+            mesh.vertProperties[3 * i + 1] = vertex[Y];
+            mesh.vertProperties[3 * i + 2] = vertex[Z];
+        }
+
+        // the manifold library expects counter-clockwise faces
+        bool flip = (bot.orientation == RT_BOT_CW) != mirrored;
+
+        for (size_t i = 0; i < bot.num_faces; ++i) {
+            mesh.triVerts[3 * i]     = bot.faces[3 * i];
+            mesh.triVerts[3 * i + 1] = bot.faces[3 * i + (flip ? 2 : 1)];
+            mesh.triVerts[3 * i + 2] = bot.faces[3 * i + (flip ? 1 : 2)];
+        }
+    }
+
+    return ret;
+}
+
+
+static rt_bot_internal* MeshToBot
+(
+    const manifold::MeshGL64& mesh
+) {
+    rt_bot_internal* ret;
+    size_t           numberOfVertices = mesh.NumVert();
+    size_t           numberOfFaces    = mesh.NumTri();
+
+    BU_ALLOC(ret, rt_bot_internal);
+    ret->magic        = RT_BOT_INTERNAL_MAGIC;
+    ret->mode         = RT_BOT_SOLID;
+    ret->orientation  = RT_BOT_CCW;
+    ret->num_vertices = numberOfVertices;
+    ret->num_faces    = numberOfFaces;
+
+    if (numberOfVertices > 0) {
+        ret->vertices = static_cast<fastf_t*>(bu_malloc(3 * numberOfVertices * sizeof(fastf_t), "ConstDatabase MeshToBot(): vertices"));
+
+        for (size_t i = 0; i < numberOfVertices; ++i) {
+            for (size_t j = 0; j < 3; ++j)
+                ret->vertices[3 * i + j] = mesh.vertProperties[mesh.numProp * i + j];
+        }
+    }
+
+    if (numberOfFaces > 0) {
+        ret->faces = static_cast<int*>(bu_malloc(3 * numberOfFaces * sizeof(int), "ConstDatabase MeshToBot(): faces"));
+
+        for (size_t i = 0; i < 3 * numberOfFaces; ++i)
+            ret->faces[i] = static_cast<int>(mesh.triVerts[i]);
+    }
+
+    return ret;
+}
+
+
+/// tessellates a prototype leaf to a mesh, bags of triangles in solid mode are taken as they are
+static bool TessellateLeafToMesh
+(
+    FacetizeSolid&      leaf,
+    manifold::MeshGL64& mesh
+) {
+    bool ret = false;
+
+    // the import transforms the vertices only, a mirroring matrix turns the faces inside out
+    if ((leaf.internal.idb_minor_type == ID_BOT) && (static_cast<rt_bot_internal*>(leaf.internal.idb_ptr)->mode == RT_BOT_SOLID))
+        ret = BotToMesh(*static_cast<rt_bot_internal*>(leaf.internal.idb_ptr), nullptr, bn_mat_det3(leaf.matrix) < 0., mesh);
+
+    if (!ret) {
+        model*     leafModel  = nmg_mm();
+        nmgregion* leafRegion = nullptr;
+
+        if (!BU_SETJUMP) {
+            if ((leaf.internal.idb_meth->ft_tessellate(&leafRegion, leafModel, &leaf.internal, leaf.ttol, leaf.tol) == 0) && (leafRegion != nullptr)) {
+                bu_list vlfree;
+
+                BU_LIST_INIT(&vlfree);
+
+                rt_bot_internal* bot = nmg_mdl_to_bot(leafModel, &vlfree, leaf.tol);
+
+                bv_vlist_cleanup(&vlfree);
+
+                if (bot != nullptr) {
+                    ret = BotToMesh(*bot, nullptr, false, mesh);
+
+                    rt_db_internal intern;
+
+                    RT_DB_INTERNAL_INIT(&intern);
+                    intern.idb_major_type = DB5_MAJORTYPE_BRLCAD;
+                    intern.idb_minor_type = ID_BOT;
+                    intern.idb_meth       = &OBJ[ID_BOT];
+                    intern.idb_ptr        = bot;
+
+                    rt_db_free_internal(&intern);
+                }
+            }
+        }
+        else
+            BU_UNSETJUMP;
+
+        BU_UNSETJUMP;
+
+        nmg_km(leafModel);
+    }
+
+    return ret;
+}
+
+
+/// evaluates a boolean tree on the manifolds of its leaves
+/** \return false if the tree is empty */
+static bool EvaluateManifoldTree
+(
+    const tree*                                     tp,
+    const std::unordered_map<const tree*, size_t>& leafIndices,
+    const std::vector<manifold::Manifold>&          solids,
+    const std::vector<char>&                        tessellated,
+    manifold::Manifold&                             result
+) {
+    bool ret = false;
+
+    switch (tp->tr_op) {
+        case OP_NMG_TESS: {
+            size_t index = leafIndices.at(tp);
+
+            ret = (tessellated[index] != 0);
+
+            if (ret)
+                result = solids[index];
+
+            break;
+        }
+
+        case OP_UNION:
+        case OP_SUBTRACT:
+        case OP_INTERSECT: {
+            manifold::Manifold left;
+            manifold::Manifold right;
+            bool               hasLeft  = EvaluateManifoldTree(tp->tr_b.tb_left, leafIndices, solids, tessellated, left);
+            bool               hasRight = EvaluateManifoldTree(tp->tr_b.tb_right, leafIndices, solids, tessellated, right);
+
+            if (tp->tr_op == OP_UNION) {
+                ret = hasLeft || hasRight;
+
+                if (hasLeft && hasRight)
+                    result = left + right;
+                else if (hasLeft)
+                    result = left;
+                else if (hasRight)
+                    result = right;
+            }
+            else if (tp->tr_op == OP_SUBTRACT) {
+                ret = hasLeft;
+
+                if (hasLeft && hasRight)
+                    result = left - right;
+                else if (hasLeft)
+                    result = left;
+            }
+            else {
+                ret = hasLeft && hasRight;
+
+                if (ret)
+                    result = left ^ right;
+            }
+        }
+    }
+
+    return ret;
+}
+
+
+/// facetizes the tree of \a objectName with the tolerances of \a rtip, the booleans are evaluated by the manifold library
+/** \return false if the evaluation failed, e.g. because a leaf doesn't give a closed manifold mesh, otherwise \a bot is set to the result or nullptr if there is nothing */
+static bool FacetizeTreeManifold
+(
+    rt_i*                     rtip,
+    const char*               objectName,
+    const InternalCompletion& completion,
+    bool                      parallelNmg,
+    rt_bot_internal*&         bot
+) {
+    bool          ret = false;
+    FacetizeData  facetizeData(completion);
+    db_tree_state initState;
+
+    bot = nullptr;
+
+    db_init_db_tree_state(&initState, rtip->rti_dbip);
+    initState.ts_ttol = &rtip->rti_ttol;
+    initState.ts_tol  = &rtip->rti_tol;
+
+    int walkResult = db_walk_tree(rtip->rti_dbip,
+                                  1,
+                                  &objectName,
+                                  1,
+                                  &initState,
+                                  nullptr,
+                                  FacetizeRegionEnd,
+                                  FacetizeLeaf,
+                                  &facetizeData);
+
+    std::vector<FacetizeSolid>&      leaves = facetizeData.leaves;
+    std::vector<manifold::MeshGL64>  meshes(leaves.size());
+    std::vector<manifold::Manifold>  solids(leaves.size());
+    std::vector<char>                tessellated(leaves.size(), 0);
+    std::atomic<bool>                manifoldFailed(false);
+
+    // the prototypes first, they may be tessellated with non-manifold geometry, then their instances
+    for (size_t pass = 0; pass < 2; ++pass) {
+        NonManifoldFor(leaves.size(), parallelNmg || (pass == 1), [&leaves, &meshes, &tessellated, pass](size_t begin, size_t end, size_t) {
+            for (size_t i = begin; i < end; ++i) {
+                FacetizeSolid& leaf = leaves[i];
+
+                if ((pass == 0) && (leaf.prototype == i)) {
+                    tessellated[i] = TessellateLeafToMesh(leaf, meshes[i]) ? 1 : 0;
+                    rt_db_free_internal(&leaf.internal);
+                }
+                else if ((pass == 1) && (leaf.prototype != i) && (tessellated[leaf.prototype] != 0)) {
+                    const manifold::MeshGL64& prototype = meshes[leaf.prototype];
+
+                    meshes[i] = prototype;
+
+                    if (bn_mat_det3(leaf.matrix) < 0.) {
+                        for (size_t j = 0; j < prototype.NumTri(); ++j)
+                            std::swap(meshes[i].triVerts[3 * j + 1], meshes[i].triVerts[3 * j + 2]);
+                    }
+
+                    for (size_t j = 0; j < prototype.NumVert(); ++j) {
+                        point_t vertex;
+                        point_t transformed;
+
+                        VSET(vertex, prototype.vertProperties[3 * j], prototype.vertProperties[3 * j + 1], prototype.vertProperties[3 * j + 2]);
+                        MAT4X3PNT(transformed, leaf.matrix, vertex);
+
+                        meshes[i].vertProperties[3 * j]     = transformed[X];
+                        meshes[i].vertProperties[3 * j + 1] = transformed[Y];
+                        meshes[i].vertProperties[3 * j + 2] = transformed[Z];
+                    }
+
+                    tessellated[i] = 1;
+                }
+            }
+        });
+    }
+
+    // a leaf without a mesh would be dropped from the booleans, the non-manifold geometry can handle it better
+    ParallelFor(leaves.size(), 1, [&meshes, &solids, &tessellated, &manifoldFailed](size_t begin, size_t end, size_t) {
+        for (size_t i = begin; i < end; ++i) {
+            if (tessellated[i] == 0)
+                manifoldFailed = true;
+            else {
+                try {
+                    meshes[i].Merge();
+                    solids[i] = manifold::Manifold(meshes[i]);
+
+                    if (solids[i].Status() != manifold::Manifold::Error::NoError)
+                        manifoldFailed = true;
+                }
+                catch (...) {
+                    manifoldFailed = true;
+                }
+
+                meshes[i] = manifold::MeshGL64();
+            }
+        }
+    });
+
+    if ((walkResult == 0) && !manifoldFailed) {
+        std::unordered_map<const tree*, size_t> leafIndices;
+        std::vector<manifold::Manifold>         results(facetizeData.regions.size());
+        std::vector<char>                       hasResult(facetizeData.regions.size(), 0);
+
+        for (size_t i = 0; i < leaves.size(); ++i)
+            leafIndices[leaves[i].node] = i;
+
+        ParallelFor(facetizeData.regions.size(), 1, [&](size_t begin, size_t end, size_t) {
+            for (size_t i = begin; i < end; ++i) {
+                try {
+                    hasResult[i] = EvaluateManifoldTree(facetizeData.regions[i], leafIndices, solids, tessellated, results[i]) ? 1 : 0;
+
+                    if (hasResult[i] != 0)
+                        results[i].Status(); // forces the evaluation in this thread
+                }
+                catch (...) {
+                    manifoldFailed = true;
+                }
+            }
+        });
+
+        if (!manifoldFailed) {
+            std::vector<manifold::Manifold> regionResults;
+
+            for (size_t i = 0; i < results.size(); ++i) {
+                if (hasResult[i] != 0)
+                    regionResults.push_back(results[i]);
+            }
+
+            try {
+                if (!regionResults.empty()) {
+                    manifold::Manifold facetized = manifold::Manifold::BatchBoolean(regionResults, manifold::OpType::Add);
+
+                    if (facetized.Status() == manifold::Manifold::Error::NoError) {
+                        if (!facetized.IsEmpty())
+                            bot = MeshToBot(facetized.GetMeshGL64());
+
+                        ret = true;
+                    }
+                }
+                else
+                    ret = true;
+            }
+            catch (...) {
+                ret = false;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < facetizeData.regions.size(); ++i)
+        db_free_tree(facetizeData.regions[i]);
+
+    return ret;
+}
+
+
+/// converts the result of FacetizeTreeManifold() to a non-manifold geometry model, \a bot will be freed
+static model* BotToModel
+(
+    rt_i*            rtip,
+    rt_bot_internal* bot
+) {
+    model*         ret        = nmg_mm();
+    nmgregion*     botRegion  = nullptr;
+    rt_db_internal intern;
+
+    RT_DB_INTERNAL_INIT(&intern);
+    intern.idb_major_type = DB5_MAJORTYPE_BRLCAD;
+    intern.idb_minor_type = ID_BOT;
+    intern.idb_meth       = &OBJ[ID_BOT];
+    intern.idb_ptr        = bot;
+
+    if (OBJ[ID_BOT].ft_tessellate(&botRegion, ret, &intern, &rtip->rti_ttol, &rtip->rti_tol) != 0) {
+        nmg_km(ret);
+        ret = nullptr;
+    }
+
+    rt_db_free_internal(&intern);
+
+    return ret;
+}
+#endif // HAVE_MANIFOLD
+
+
+/// facetizes the tree of \a objectName to a non-manifold geometry model
+/** If \a useManifold is set the booleans are evaluated by the manifold library if possible. */
+static model* FacetizeTreeToModel
+(
+    rt_i*                     rtip,
+    const char*               objectName,
+    const InternalCompletion& completion,
+    bool                      parallelNmg,
+    bool                      useManifold
+) {
+    model* ret  = nullptr;
+    bool   done = false;
+
+    if (useManifold) {
+#ifdef HAVE_MANIFOLD
+        rt_bot_internal* bot = nullptr;
+
+        done = FacetizeTreeManifold(rtip, objectName, completion, parallelNmg, bot);
+
+        if (bot != nullptr)
+            ret = BotToModel(rtip, bot);
+#endif
+    }
+
+    if (!done)
+        ret = FacetizeTree(rtip, objectName, completion, parallelNmg);
+
+    return ret;
+}
+
+
+/// facetizes the tree of \a objectName to a bag of triangles
+/** If \a useManifold is set the booleans are evaluated by the manifold library if possible. */
+static rt_bot_internal* FacetizeTreeToBot
+(
+    rt_i*                     rtip,
+    const char*               objectName,
+    const InternalCompletion& completion,
+    bool                      parallelNmg,
+    bool                      useManifold
+) {
+    rt_bot_internal* ret  = nullptr;
+    bool             done = false;
+
+    if (useManifold) {
+#ifdef HAVE_MANIFOLD
+        done = FacetizeTreeManifold(rtip, objectName, completion, parallelNmg, ret);
+#endif
+    }
+
+    if (!done) {
+        model* facetizedModel = FacetizeTree(rtip, objectName, completion, parallelNmg);
+
+        if (facetizedModel != nullptr) {
+            bu_list vlfree;
+
+            BU_LIST_INIT(&vlfree);
+
+            ret = nmg_mdl_to_bot(facetizedModel, &vlfree, &rtip->rti_tol);
+
+            bv_vlist_cleanup(&vlfree);
+            nmg_km(facetizedModel);
+        }
+    }
+
+    return ret;
+}
+
+
+/// SHA-256 digest of a sequence of byte streams, identifies the content of the facetization cache
+/** Every stream is followed by its length, i.e. the concatenation of the streams is unambiguous. */
+class ContentHash {
+public:
+    ContentHash(void) : m_bufferSize(0), m_length(0) {
+        static const uint32_t initialState[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+
+        memcpy(m_state, initialState, sizeof(m_state));
+    }
+
+    void Add
+    (
+        const void* data,
+        size_t      size
+    ) {
+        unsigned char length[8];
+
+        Update(static_cast<const unsigned char*>(data), size);
+
+        for (size_t i = 0; i < 8; ++i)
+            length[i] = static_cast<unsigned char>(static_cast<uint64_t>(size) >> (8 * i));
+
+        Update(length, sizeof(length));
+    }
+
+    /// the 32 bytes of the digest of the streams added so far
+    void Digest
+    (
+        unsigned char digest[32]
+    ) const {
+        ContentHash   final = *this;
+        uint64_t      bits  = 8 * m_length;
+        unsigned char padding[72] = {0x80};
+        size_t        paddingSize = ((m_bufferSize < 56) ? 56 : 120) - m_bufferSize;
+
+        for (size_t i = 0; i < 8; ++i)
+            padding[paddingSize + i] = static_cast<unsigned char>(bits >> (56 - 8 * i));
+
+        final.Update(padding, paddingSize + 8);
+
+        for (size_t i = 0; i < 32; ++i)
+            digest[i] = static_cast<unsigned char>(final.m_state[i / 4] >> (24 - 8 * (i % 4)));
+    }
+
+    std::string Hex(void) const {
+        static const char digits[] = "0123456789abcdef";
+        unsigned char     digest[32];
+        std::string       ret;
+
+        Digest(digest);
+
+        for (size_t i = 0; i < 32; ++i) {
+            ret += digits[digest[i] >> 4];
+            ret += digits[digest[i] & 0xf];
+        }
+
+        return ret;
+    }
+
+private:
+    uint32_t      m_state[8];
+    unsigned char m_buffer[64];
+    size_t        m_bufferSize;
+    uint64_t      m_length;
+
+    static uint32_t Rotate
+    (
+        uint32_t value,
+        int      bits
+    ) {
+        return (value >> bits) | (value << (32 - bits));
+    }
+
+    void Update
+    (
+        const unsigned char* data,
+        size_t               size
+    ) {
+        m_length += size;
+
+        while (size > 0) {
+            size_t count = std::min(size, sizeof(m_buffer) - m_bufferSize);
+
+            memcpy(m_buffer + m_bufferSize, data, count);
+            m_bufferSize += count;
+            data         += count;
+            size         -= count;
+
+            if (m_bufferSize == sizeof(m_buffer)) {
+                Compress();
+                m_bufferSize = 0;
+            }
+        }
+    }
+
+    void Compress(void) {
+        static const uint32_t k[64] = {
+            0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+            0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+            0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+            0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+            0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+            0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+            0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+            0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+        };
+
+        uint32_t w[64];
+
+        for (size_t i = 0; i < 16; ++i)
+            w[i] = (static_cast<uint32_t>(m_buffer[4 * i]) << 24) | (static_cast<uint32_t>(m_buffer[4 * i + 1]) << 16) |
+                   (static_cast<uint32_t>(m_buffer[4 * i + 2]) << 8) | static_cast<uint32_t>(m_buffer[4 * i + 3]);
+
+        for (size_t i = 16; i < 64; ++i) {
+            uint32_t s0 = Rotate(w[i - 15], 7) ^ Rotate(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            uint32_t s1 = Rotate(w[i - 2], 17) ^ Rotate(w[i - 2], 19) ^ (w[i - 2] >> 10);
+
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+
+        uint32_t v[8];
+
+        memcpy(v, m_state, sizeof(v));
+
+        for (size_t i = 0; i < 64; ++i) {
+            uint32_t s1 = Rotate(v[4], 6) ^ Rotate(v[4], 11) ^ Rotate(v[4], 25);
+            uint32_t t1 = v[7] + s1 + ((v[4] & v[5]) ^ (~v[4] & v[6])) + k[i] + w[i];
+            uint32_t s0 = Rotate(v[0], 2) ^ Rotate(v[0], 13) ^ Rotate(v[0], 22);
+            uint32_t t2 = s0 + ((v[0] & v[1]) ^ (v[0] & v[2]) ^ (v[1] & v[2]));
+
+            memmove(v + 1, v, 7 * sizeof(uint32_t));
+            v[4] += t1;
+            v[0]  = t1 + t2;
+        }
+
+        for (size_t i = 0; i < 8; ++i)
+            m_state[i] += v[i];
+    }
+};
+
+
+/// provides the content of an object which isn't in the database, see ConstDatabase::KeptContent()
+typedef std::function<bool(const directory* pDir, const void*& data, size_t& size)> KeptContentQuery;
+
+
+struct TreeHashData {
+    db_i*                    dbip;
+    KeptContentQuery         keptContent;
+    ContentHash              hash;
+    std::set<directory*>     visited;
+    std::vector<std::string> members;
+};
+
+
+/// adds the external form of an object to the hash of a tree, every object is taken once
+static void HashObject
+(
+    db_i*      UNUSED(dbip),
+    directory* pDir,
+    void*      clientData
+) {
+    TreeHashData* hashData = static_cast<TreeHashData*>(clientData);
+
+    if (hashData->visited.insert(pDir).second) {
+        bu_external external;
+
+        BU_EXTERNAL_INIT(&external);
+
+        hashData->hash.Add(pDir->d_namep, strlen(pDir->d_namep) + 1);
+
+        if (db_get_external(&external, pDir, hashData->dbip) == 0) {
+            hashData->hash.Add(external.ext_buf, external.ext_nbytes);
+            bu_free_external(&external);
+        }
+
+        const void* keptData;
+        size_t      keptSize;
+
+        if (hashData->keptContent(pDir, keptData, keptSize))
+            hashData->hash.Add(keptData, keptSize);
+
+        hashData->members.push_back(pDir->d_namep);
+    }
+}
+
+
+class ConstDatabase::FacetizationCache {
+public:
+    FacetizationCache
+    (
+        const ConstDatabase& database,
+        const char*          cacheDirectory,
+        size_t               memoryLimit
+    ) : m_database(database), m_directory((cacheDirectory != nullptr) ? cacheDirectory : ""), m_memoryLimit(memoryLimit), m_memorySize(0) {}
+
+    /// looks for a result of \a kind for the tree of \a objectName
+    /** If \a hashTree is false only a tree whose hash is already known is considered.
+        Otherwise, the tree is read and hashed if necessary.
+        \a key will be set to the key of the result, or an empty string if the tree can't be identified.
+        \return true if \a data was set to a stored result */
+    bool Find
+    (
+        const rt_i*                 rtip,
+        resource*                   resp,
+        const char*                 objectName,
+        char                        kind,
+        bool                        hashTree,
+        std::string&                key,
+        std::vector<unsigned char>& data
+    ) {
+        bool        ret = false;
+        ContentHash hash;
+        bool        hashKnown;
+
+        key.clear();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto                        tree = m_trees.find(objectName);
+
+            hashKnown = (tree != m_trees.end());
+
+            if (hashKnown)
+                hash = tree->second.hash;
+        }
+
+        if (!hashKnown && hashTree) {
+            directory* pDir = db_lookup(rtip->rti_dbip, objectName, LOOKUP_QUIET);
+
+            if (pDir != RT_DIR_NULL) {
+                TreeHashData hashData;
+
+                hashData.dbip        = rtip->rti_dbip;
+                hashData.keptContent = [this](const directory* pMember, const void*& data, size_t& size) {
+                    return m_database.KeptContent(pMember, data, size);
+                };
+
+                db_functree(rtip->rti_dbip, pDir, HashObject, HashObject, resp, &hashData);
+
+                std::sort(hashData.members.begin(), hashData.members.end());
+
+                std::lock_guard<std::mutex> lock(m_mutex);
+                Tree&                       tree = m_trees[objectName];
+
+                tree.hash    = hashData.hash;
+                tree.members.swap(hashData.members);
+                hash         = tree.hash;
+                hashKnown    = true;
+            }
+        }
+
+        if (hashKnown) {
+            const char format = 2; // to be incremented if the form of the stored results changes
+            double     tolerances[5] = {rtip->rti_ttol.abs, rtip->rti_ttol.rel, rtip->rti_ttol.norm, rtip->rti_tol.dist, rtip->rti_tol.perp};
+
+            hash.Add(&format, 1);
+            hash.Add(&kind, 1);
+            hash.Add(tolerances, sizeof(tolerances));
+
+            key = hash.Hex();
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                auto                        result = m_results.find(key);
+
+                if (result != m_results.end()) {
+                    m_usage.splice(m_usage.begin(), m_usage, result->second.usage);
+                    data = result->second.data;
+                    ret  = true;
+                }
+            }
+
+            if (!ret && !m_directory.empty()) {
+                FILE* file = fopen(FileName(key).c_str(), "rb");
+
+                if (file != nullptr) {
+                    std::vector<unsigned char> record;
+                    unsigned char              buffer[65536];
+                    size_t                     count;
+
+                    while ((count = fread(buffer, 1, sizeof(buffer), file)) > 0)
+                        record.insert(record.end(), buffer, buffer + count);
+
+                    if ((ferror(file) == 0) && RecordIsValid(key, record)) {
+                        data.assign(record.begin() + RecordHeaderSize, record.end());
+                        Remember(key, data);
+                        ret = true;
+                    }
+
+                    fclose(file);
+                }
+            }
+        }
+
+        return ret;
+    }
+
+    void Store
+    (
+        const std::string&                key,
+        const std::vector<unsigned char>& data
+    ) {
+        Remember(key, data);
+
+        if (!m_directory.empty()) {
+            // written to a temporary file first, because other processes may read the directory concurrently
+            std::string fileName = FileName(key);
+            std::string tempName = fileName + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + "."
+                                   + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) + ".tmp";
+            FILE*       file     = fopen(tempName.c_str(), "wb");
+
+            if (file != nullptr) {
+                std::vector<unsigned char> header = RecordHeader(key, data);
+                bool                       success = (fwrite(header.data(), 1, header.size(), file) == header.size());
+
+                success = (fwrite(data.data(), 1, data.size(), file) == data.size()) && success;
+
+                success = (fclose(file) == 0) && success;
+
+                if (!success || (std::rename(tempName.c_str(), fileName.c_str()) != 0))
+                    std::remove(tempName.c_str());
+            }
+        }
+    }
+
+    /// forgets the hashes of the trees which contain \a objectName
+    /** The stored results stay valid for their content. */
+    void Invalidate
+    (
+        const char* objectName,
+        ChangeType  changeType
+    ) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if (changeType == ChangeType::References)
+            ; // only the reference counters were updated
+        else if ((objectName == nullptr) || (changeType == ChangeType::Addition)) // an addition may complete a tree
+            m_trees.clear();
+        else {
+            for (auto tree = m_trees.begin(); tree != m_trees.end();) {
+                if (std::binary_search(tree->second.members.begin(), tree->second.members.end(), std::string(objectName)))
+                    tree = m_trees.erase(tree);
+                else
+                    ++tree;
+            }
+        }
+    }
+
+    void ForgetTrees(void) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        m_trees.clear();
+    }
+
+private:
+    struct Tree {
+        ContentHash              hash;
+        std::vector<std::string> members; ///< sorted names of the objects in the tree
+    };
+
+    struct Result {
+        std::vector<unsigned char>       data;
+        std::list<std::string>::iterator usage;
+    };
+
+    const ConstDatabase&          m_database;    ///< provides the content which isn't in the database
+    std::mutex                    m_mutex;
+    const std::string             m_directory;
+    const size_t                  m_memoryLimit;
+    size_t                        m_memorySize;
+    std::map<std::string, Tree>   m_trees;
+    std::map<std::string, Result> m_results;
+    std::list<std::string>        m_usage; ///< keys of m_results, the most recently used first
+
+    std::string FileName
+    (
+        const std::string& key
+    ) const {
+        return m_directory + "/" + key;
+    }
+
+    /// a file in the cache directory starts with a magic number, the key of the result and the digest of the result
+    /** The key and the digest reject files which were renamed, truncated or edited. */
+    static const size_t RecordHeaderSize = 8 + 64 + 32;
+
+    static std::vector<unsigned char> RecordHeader
+    (
+        const std::string&                key,
+        const std::vector<unsigned char>& data
+    ) {
+        static const char          magic[8] = {'M', 'O', 'O', 'S', 'E', 'F', 'C', '1'};
+        std::vector<unsigned char> ret(magic, magic + sizeof(magic));
+        ContentHash                hash;
+        unsigned char              digest[32];
+
+        ret.insert(ret.end(), key.begin(), key.end());
+
+        hash.Add(data.data(), data.size());
+        hash.Digest(digest);
+        ret.insert(ret.end(), digest, digest + sizeof(digest));
+
+        return ret;
+    }
+
+    static bool RecordIsValid
+    (
+        const std::string&                key,
+        const std::vector<unsigned char>& record
+    ) {
+        bool ret = (key.size() == 64) && (record.size() >= RecordHeaderSize);
+
+        if (ret) {
+            std::vector<unsigned char> data(record.begin() + RecordHeaderSize, record.end());
+            std::vector<unsigned char> header = RecordHeader(key, data);
+
+            ret = std::equal(header.begin(), header.end(), record.begin());
+        }
+
+        return ret;
+    }
+
+    /// keeps the result in memory and discards the least recently used ones if the limit is exceeded
+    /** A result with the same key is replaced, e.g. one which turned out to be invalid. */
+    void Remember
+    (
+        const std::string&                key,
+        const std::vector<unsigned char>& data
+    ) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto                        previous = m_results.find(key);
+
+        if (previous != m_results.end()) {
+            m_memorySize -= previous->second.data.size();
+            m_usage.erase(previous->second.usage);
+            m_results.erase(previous);
+        }
+
+        if (data.size() <= m_memoryLimit) {
+            m_usage.push_front(key);
+
+            Result& result = m_results[key];
+
+            result.data  = data;
+            result.usage = m_usage.begin();
+            m_memorySize += data.size();
+
+            while (m_memorySize > m_memoryLimit) {
+                auto leastRecent = m_results.find(m_usage.back());
+
+                m_memorySize -= leastRecent->second.data.size();
+                m_results.erase(leastRecent);
+                m_usage.pop_back();
+            }
+        }
+    }
+};
+
+
+/// writes the external form of a geometry in the database format to \a data
+static void InternalToCache
+(
+    int                         type,
+    void*                       geometry,
+    db_i*                       dbip,
+    resource*                   resp,
+    std::vector<unsigned char>& data
+) {
+    rt_db_internal intern;
+    bu_external    external;
+
+    RT_DB_INTERNAL_INIT(&intern);
+    intern.idb_major_type = DB5_MAJORTYPE_BRLCAD;
+    intern.idb_minor_type = type;
+    intern.idb_meth       = &OBJ[type];
+    intern.idb_ptr        = geometry;
+
+    BU_EXTERNAL_INIT(&external);
+
+    data.clear();
+
+    if (!BU_SETJUMP) {
+        if (rt_db_cvt_to_external5(&external, "facetization", &intern, 1., dbip, resp, DB5_MAJORTYPE_BRLCAD) == 0) {
+            data.assign(external.ext_buf, external.ext_buf + external.ext_nbytes);
+            bu_free_external(&external);
+        }
+    }
+    else
+        BU_UNSETJUMP;
+
+    BU_UNSETJUMP;
+}
+
+
+/// checks the indices of a bag of triangles read from the cache, the import doesn't do it
+static bool BotIndicesAreValid
+(
+    const rt_bot_internal* bot
+) {
+    bool ret = true;
+
+    for (size_t i = 0; ret && (i < 3 * bot->num_faces); ++i)
+        ret = (bot->faces[i] >= 0) && (static_cast<size_t>(bot->faces[i]) < bot->num_vertices);
+
+    if (bot->face_normals != nullptr) {
+        for (size_t i = 0; ret && (i < 3 * bot->num_face_normals); ++i)
+            ret = (bot->face_normals[i] >= 0) && (static_cast<size_t>(bot->face_normals[i]) < bot->num_normals);
+    }
+
+    return ret;
+}
+
+
+/// reads a geometry of \a type from its external form in \a data
+/** \return the geometry, or nullptr if \a data doesn't contain a valid object of this type */
+static void* InternalFromCache
+(
+    int                               type,
+    const std::vector<unsigned char>& data,
+    db_i*                             dbip,
+    resource*                         resp
+) {
+    void*          ret = nullptr;
+    rt_db_internal intern;
+    bu_external    external;
+
+    RT_DB_INTERNAL_INIT(&intern);
+    BU_EXTERNAL_INIT(&external);
+    external.ext_buf    = const_cast<uint8_t*>(data.data());
+    external.ext_nbytes = data.size();
+
+    if (!BU_SETJUMP) {
+        if (rt_db_external5_to_internal5(&intern, &external, "facetization", dbip, nullptr, resp) >= 0) {
+            if ((intern.idb_major_type == DB5_MAJORTYPE_BRLCAD) && (intern.idb_minor_type == type) &&
+                ((type != ID_BOT) || BotIndicesAreValid(static_cast<const rt_bot_internal*>(intern.idb_ptr)))) {
+                // the geometry is taken over, only the attributes remain to be freed
+                ret            = intern.idb_ptr;
+                intern.idb_ptr = nullptr;
+            }
+
+            rt_db_free_internal(&intern);
+        }
+    }
+    else
+        BU_UNSETJUMP;
+
+    BU_UNSETJUMP;
+
+    return ret;
+}
+
+
+static void VectorListToCache
+(
+    bu_list*                    vlist,
+    std::vector<unsigned char>& data
+) {
+    bv_vlist* chunk;
+
+    data.clear();
+
+    for (BU_LIST_FOR(chunk, bv_vlist, vlist)) {
+        for (size_t i = 0; i < chunk->nused; ++i) {
+            int32_t command  = chunk->cmd[i];
+            double  point[3] = {chunk->pt[i][X], chunk->pt[i][Y], chunk->pt[i][Z]};
+            size_t  offset   = data.size();
+
+            data.resize(offset + sizeof(command) + sizeof(point));
+            memcpy(data.data() + offset, &command, sizeof(command));
+            memcpy(data.data() + offset + sizeof(command), point, sizeof(point));
+        }
+    }
+}
+
+
+static bool IsVectorListCommand
+(
+    int32_t command
+) {
+    bool ret = false;
+
+    switch (command) {
+        case BV_VLIST_LINE_MOVE:
+        case BV_VLIST_LINE_DRAW:
+        case BV_VLIST_POLY_START:
+        case BV_VLIST_POLY_MOVE:
+        case BV_VLIST_POLY_DRAW:
+        case BV_VLIST_POLY_END:
+        case BV_VLIST_POLY_VERTNORM:
+        case BV_VLIST_TRI_START:
+        case BV_VLIST_TRI_MOVE:
+        case BV_VLIST_TRI_DRAW:
+        case BV_VLIST_TRI_END:
+        case BV_VLIST_TRI_VERTNORM:
+        case BV_VLIST_POINT_DRAW:
+        case BV_VLIST_POINT_SIZE:
+        case BV_VLIST_LINE_WIDTH:
+        case BV_VLIST_DISPLAY_MAT:
+        case BV_VLIST_MODEL_MAT:
+            ret = true;
+    }
+
+    return ret;
+}
+
+
+/// appends the plot stored in \a data to \a vlist
+/** \return false if \a data isn't a sequence of valid records, \a vlist is unchanged then */
+static bool VectorListFromCache
+(
+    const std::vector<unsigned char>& data,
+    bu_list*                          freeChunks,
+    bu_list*                          vlist
+) {
+    const size_t recordSize = sizeof(int32_t) + 3 * sizeof(double);
+    bool         ret        = ((data.size() % recordSize) == 0);
+
+    for (size_t offset = 0; ret && (offset < data.size()); offset += recordSize) {
+        int32_t command;
+
+        memcpy(&command, data.data() + offset, sizeof(command));
+
+        ret = IsVectorListCommand(command);
+    }
+
+    if (ret) {
+        for (size_t offset = 0; offset < data.size(); offset += recordSize) {
+            int32_t command;
+            double  coordinates[3];
+            point_t point;
+
+            memcpy(&command, data.data() + offset, sizeof(command));
+            memcpy(coordinates, data.data() + offset + sizeof(command), sizeof(coordinates));
+            VSET(point, coordinates[X], coordinates[Y], coordinates[Z]);
+
+            BV_ADD_VLIST(freeChunks, vlist, point, command);
+        }
+    }
+
+    return ret;
+}
+
+
+NonManifoldGeometry* ConstDatabase::Facetize
+(
+    const char* objectName
+) const {
+    NonManifoldGeometry* ret = new NonManifoldGeometry;
+
+    if (m_rtip != nullptr) {
+        model*                     facetizedModel = nullptr;
+        const char                 kind           = (m_booleanBackend == BooleanBackend::Manifold) ? 'N' : 'n';
+        std::string                key;
+        std::vector<unsigned char> cached;
+
+        if ((m_facetizationCache != nullptr) && m_facetizationCache->Find(m_rtip, m_resp, objectName, kind, false, key, cached))
+            facetizedModel = static_cast<model*>(InternalFromCache(ID_NMG, cached, m_rtip->rti_dbip, m_resp));
+
+        if (facetizedModel == nullptr) {
+            if ((m_facetizationCache != nullptr) && m_facetizationCache->Find(m_rtip, m_resp, objectName, kind, true, key, cached))
+                facetizedModel = static_cast<model*>(InternalFromCache(ID_NMG, cached, m_rtip->rti_dbip, m_resp));
+
+            if (facetizedModel == nullptr) {
+                if (!BU_SETJUMP) {
+                    facetizedModel = FacetizeTreeToModel(m_rtip, objectName, Completion(), m_parallelNmg, m_booleanBackend == BooleanBackend::Manifold);
+
+                    if ((facetizedModel != nullptr) && !key.empty()) {
+                        InternalToCache(ID_NMG, facetizedModel, m_rtip->rti_dbip, m_resp, cached);
+
+                        if (!cached.empty())
+                            m_facetizationCache->Store(key, cached);
+                    }
+                }
+                else {
+                    BU_UNSETJUMP;
+                }
+
+                BU_UNSETJUMP;
+            }
+        }
+
+        if (facetizedModel != nullptr) {
+            nmg_km(ret->m_internalp);
+            ret->m_internalp = facetizedModel;
+        }
+    }
+
+    return ret;
+}
+
+
+BagOfTriangles* ConstDatabase::FacetizeToBot
+(
+    const char* objectName
+) const {
+    BagOfTriangles* ret = new BagOfTriangles;
+
+    if (m_rtip != nullptr) {
+        rt_bot_internal*           bot  = nullptr;
+        const char                 kind = (m_booleanBackend == BooleanBackend::Manifold) ? 'B' : 'b';
+        std::string                key;
+        std::vector<unsigned char> cached;
+
+        if ((m_facetizationCache != nullptr) && m_facetizationCache->Find(m_rtip, m_resp, objectName, kind, false, key, cached))
+            bot = static_cast<rt_bot_internal*>(InternalFromCache(ID_BOT, cached, m_rtip->rti_dbip, m_resp));
+
+        if (bot == nullptr) {
+            if ((m_facetizationCache != nullptr) && m_facetizationCache->Find(m_rtip, m_resp, objectName, kind, true, key, cached))
+                bot = static_cast<rt_bot_internal*>(InternalFromCache(ID_BOT, cached, m_rtip->rti_dbip, m_resp));
+
+            if (bot == nullptr) {
+                if (!BU_SETJUMP) {
+                    bot = FacetizeTreeToBot(m_rtip, objectName, Completion(), m_parallelNmg, m_booleanBackend == BooleanBackend::Manifold);
+
+                    if ((bot != nullptr) && !key.empty()) {
+                        InternalToCache(ID_BOT, bot, m_rtip->rti_dbip, m_resp, cached);
+
+                        if (!cached.empty())
+                            m_facetizationCache->Store(key, cached);
+                    }
+                }
+                else {
+                    BU_UNSETJUMP;
+                }
+
+                BU_UNSETJUMP;
+            }
+        }
+
+        if (bot != nullptr) {
+            // the default constructed bag of triangles is empty, it takes over the arrays of bot
+            *ret->m_internalp = *bot;
+            bu_free(bot, "ConstDatabase::FacetizeToBot(): rt_bot_internal");
+        }
+    }
+
+    return ret;
+}
+
+
+bool ConstDatabase::ExportFacetization
+(
+    const char*       objectName,
+    MeshFormat        format,
+    const ExportSink& sink
+) const {
+    bool ret = false;
+
+    if (m_rtip != nullptr) {
+        size_t                     numberOfVertices = 0;
+        size_t                     numberOfFaces    = 0;
+        std::vector<unsigned char> header           = ExportHeader(format, 0, 0);
+        size_t                     position         = header.size();
+        FILE*                      plyFaces         = nullptr;
+
+        ret = sink(0, header.data(), header.size());
+
+        if (ret && (format == MeshFormat::BinaryPly)) {
+            // the faces have to follow all vertices
+            plyFaces = tmpfile();
+            ret      = (plyFaces != nullptr);
+        }
+
+        if (ret) {
+            if (!BU_SETJUMP)
+                ret = ExportTree(m_rtip, m_resp, objectName, Completion(), m_parallelNmg, format, sink, position, plyFaces, numberOfVertices, numberOfFaces);
+            else {
+                BU_UNSETJUMP;
+                ret = false;
+            }
+
+            BU_UNSETJUMP;
+        }
+
+        if (plyFaces != nullptr) {
+            if (ret) {
+                std::vector<unsigned char> buffer(1 << 20);
+                size_t                     bytesRead;
+
+                rewind(plyFaces);
+
+                while (ret && ((bytesRead = fread(buffer.data(), 1, buffer.size(), plyFaces)) > 0)) {
+                    ret       = sink(position, buffer.data(), bytesRead);
+                    position += bytesRead;
+                }
+
+                if (ferror(plyFaces) != 0)
+                    ret = false;
+            }
+
+            fclose(plyFaces);
+        }
+
+        if (ret) {
+            header = ExportHeader(format, numberOfVertices, numberOfFaces);
+            ret    = sink(0, header.data(), header.size());
+        }
+    }
+
+    return ret;
+}
+
+
+bool ConstDatabase::ExportFacetization
+(
+    const char* objectName,
+    MeshFormat  format,
+    const char* fileName
+) const {
+    bool  ret  = false;
+    FILE* file = fopen(fileName, "wb");
+
+    if (file != nullptr) {
+        size_t filePosition = 0;
+
+        ret = ExportFacetization(objectName, format, [file, &filePosition](size_t position, const void* data, size_t size) {
+            bool success = true;
+
+            // only the header is rewritten
+            if (position != filePosition)
+                success = (bu_fseek(file, static_cast<b_off_t>(position), SEEK_SET) == 0); // beyond 2 GB too
+
+            if (success) {
+                success      = (fwrite(data, 1, size, file) == size);
+                filePosition = position + size;
+            }
+
+            return success;
+        });
+
+        if (fclose(file) != 0)
+            ret = false;
+    }
+
+    return ret;
+}
+
+
+void ConstDatabase::FacetizeLevelsOfDetail
+(
+    const char*              objectName,
+    size_t                   numberOfLevels,
+    const FacetizeTolerance* levels,
+    NonManifoldGeometry**    results
+) const {
+    for (size_t i = 0; i < numberOfLevels; ++i)
+        results[i] = new NonManifoldGeometry;
+
+    if ((m_rtip != nullptr) && (numberOfLevels > 0)) {
+        std::vector<bg_tess_tol> tolerances(numberOfLevels);
+        std::vector<model*>      models(numberOfLevels, nullptr);
+
+        for (size_t i = 0; i < numberOfLevels; ++i) {
+            tolerances[i].magic = BG_TESS_TOL_MAGIC;
+            tolerances[i].abs   = levels[i].absolute;
+            tolerances[i].rel   = levels[i].relative;
+            tolerances[i].norm  = levels[i].normal;
+        }
+
+        if (!BU_SETJUMP)
+            FacetizeTreeLevels(m_rtip, objectName, Completion(), m_parallelNmg, numberOfLevels, tolerances.data(), models.data());
+        else {
+            BU_UNSETJUMP;
+        }
+
+        BU_UNSETJUMP;
+
+        for (size_t i = 0; i < numberOfLevels; ++i) {
+            if (models[i] != nullptr) {
+                nmg_km(results[i]->m_internalp);
+                results[i]->m_internalp = models[i];
+            }
+        }
+    }
+}
+
+
+struct PlotLeafPosition;
+
+
+class ConstDatabase::PlotCache {
+public:
+    /// identifies the wireframe of a solid
+    struct Key {
+        const directory* pDir;
+        mat_t            matrix;        ///< the accumulated transformation
+        double           tolerances[5]; ///< the tessellation and distance tolerances
+
+        bool operator==(const Key& other) const {
+            return (pDir == other.pDir) && (memcmp(matrix, other.matrix, sizeof(matrix)) == 0) && (memcmp(tolerances, other.tolerances, sizeof(tolerances)) == 0);
+        }
+    };
+
+    PlotCache
+    (
+        size_t memoryLimit
+    ) : m_memoryLimit(memoryLimit), m_memorySize(0) {
+        BU_LIST_INIT(&m_freeChunks);
+    }
+
+    ~PlotCache(void) {
+        Clear();
+        bv_vlist_cleanup(&m_freeChunks);
+    }
+
+    /// appends a copy of the wireframe for \a key to \a vlist
+    /** \return false if there is no wireframe for \a key */
+    bool Find
+    (
+        const Key& key,
+        bu_list*   vlist
+    ) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto                        entry = m_entries.find(key);
+        bool                        ret   = (entry != m_entries.end());
+
+        if (ret) {
+            m_usage.splice(m_usage.begin(), m_usage, entry->second.usage);
+            bv_vlist_copy(&m_freeChunks, vlist, &entry->second.plot);
+        }
+
+        return ret;
+    }
+
+    /// keeps a copy of \a vlist as the wireframe for \a key and discards the least recently used ones if the limit is exceeded
+    void Store
+    (
+        const Key&     key,
+        const bu_list* vlist
+    ) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        size_t                      size = sizeof(Entry);
+        bv_vlist*                   chunk;
+
+        for (BU_LIST_FOR(chunk, bv_vlist, vlist))
+            size += sizeof(bv_vlist);
+
+        if ((size <= m_memoryLimit) && (m_entries.find(key) == m_entries.end())) {
+            m_usage.push_front(key);
+
+            Entry& entry = m_entries[key];
+
+            entry.objectName = key.pDir->d_namep;
+            entry.size       = size;
+            entry.usage      = m_usage.begin();
+            BU_LIST_INIT(&entry.plot);
+            bv_vlist_copy(&m_freeChunks, &entry.plot, vlist);
+            m_memorySize += size;
+
+            while (m_memorySize > m_memoryLimit)
+                Erase(m_entries.find(m_usage.back()));
+        }
+    }
+
+    /// drops the wireframes of \a objectName
+    void Invalidate
+    (
+        const char* objectName,
+        ChangeType  changeType
+    ) {
+        if ((changeType == ChangeType::References) || (changeType == ChangeType::Addition))
+            ; // the existing solids are unchanged
+        else if ((objectName == nullptr) || (changeType == ChangeType::Unknown))
+            Clear();
+        else {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            for (auto entry = m_entries.begin(); entry != m_entries.end();) {
+                if (entry->second.objectName == objectName)
+                    entry = Erase(entry);
+                else
+                    ++entry;
+            }
+        }
+    }
+
+    void Clear(void) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        for (auto entry = m_entries.begin(); entry != m_entries.end();)
+            entry = Erase(entry);
+    }
+
+    /// plots the solids of the tree of \a objectName to \a plot, the wireframes are taken from and stored in the cache
+    /** \return false if the tree is incomplete */
+    bool Plot
+    (
+        const char*               objectName,
+        rt_i*                     rtip,
+        resource*                 resp,
+        const InternalCompletion& completion,
+        bu_list*                  plot
+    );
+
+    /// plots the solids at \a leaves to \a plot, the wireframes are taken from and stored in \a plotCache if it isn't nullptr
+    /** The solids which were read already by the filter of CollectPlotLeaves() are used and freed.
+        The other ones are read and completed in parallel, with resources of their own.
+        \return false if a solid can't be read */
+    static bool PlotLeaves
+    (
+        PlotCache*                           plotCache,
+        const std::vector<PlotLeafPosition>& leaves,
+        rt_i*                                rtip,
+        const InternalCompletion&            completion,
+        bu_list*                             plot
+    );
+
+private:
+    /// FNV-1a, the hash distributes the keys over the buckets only
+    struct KeyHash {
+        size_t operator()(const Key& key) const {
+            uint64_t ret = 0xcbf29ce484222325ULL;
+
+            Add(ret, &key.pDir, sizeof(key.pDir));
+            Add(ret, key.matrix, sizeof(key.matrix));
+            Add(ret, key.tolerances, sizeof(key.tolerances));
+
+            return static_cast<size_t>(ret);
+        }
+
+        static void Add
+        (
+            uint64_t&   hash,
+            const void* data,
+            size_t      size
+        ) {
+            const unsigned char* bytes = static_cast<const unsigned char*>(data);
+
+            for (size_t i = 0; i < size; ++i)
+                hash = (hash ^ bytes[i]) * 0x100000001b3ULL;
+        }
+    };
+
+    struct Entry {
+        std::string              objectName; ///< the name of the solid, its directory entry may be gone when the entry is invalidated
+        bu_list                  plot;
+        size_t                   size;
+        std::list<Key>::iterator usage;
+    };
+
+    typedef std::unordered_map<Key, Entry, KeyHash> Entries;
+
+    std::mutex     m_mutex;
+    const size_t   m_memoryLimit;
+    size_t         m_memorySize;
+    Entries        m_entries;
+    std::list<Key> m_usage;      ///< keys of m_entries, the most recently used first
+    bu_list        m_freeChunks; ///< the chunks of the erased wireframes, the global rt_vlfree isn't thread safe
+
+    Entries::iterator Erase
+    (
+        Entries::iterator entry
+    ) {
+        BV_FREE_VLIST(&m_freeChunks, &entry->second.plot);
+        m_memorySize -= entry->second.size;
+        m_usage.erase(entry->second.usage);
+
+        return m_entries.erase(entry);
+    }
+};
+
+
+struct PlotSolid {
+    rt_db_internal     internal; ///< the solid, already transformed
+    const bg_tess_tol* ttol;
+    const bn_tol*      tol;
+};
+
+
+struct PlotLeafData {
+    std::vector<PlotSolid>    solids;
+    const InternalCompletion& completion;
+
+    PlotLeafData
+    (
+        const InternalCompletion& internalCompletion
+    ) : completion(internalCompletion) {}
+};
+
+
+/// records the solid for PlotSolids()
+/** The internal is taken over from db_walk_tree(). */
+static tree* PlotLeaf
+(
+    db_tree_state*      tsp,
+    const db_full_path* pathp,
+    rt_db_internal*     ip,
+    void*               clientData
+) {
+    tree*         ret          = TREE_NULL;
+    PlotLeafData* plotLeafData = static_cast<PlotLeafData*>(clientData);
+
+    if (ip->idb_meth->ft_plot != nullptr) {
+        PlotSolid solid;
+
+        plotLeafData->completion(DB_FULL_PATH_CUR_DIR(pathp), tsp->ts_mat, *ip);
+
+        solid.internal = *ip;
+        solid.ttol     = tsp->ts_ttol;
+        solid.tol      = tsp->ts_tol;
+        bu_avs_init_empty(&solid.internal.idb_avs);
+
+        // db_walk_tree() frees the attributes only
+        ip->idb_ptr = nullptr;
+
+        plotLeafData->solids.push_back(solid);
+
+        // Indicate success by returning something other than TREE_NULL
+        BU_GET(ret, tree);
+        RT_TREE_INIT(ret);
+        ret->tr_op = OP_NOP;
+    }
+
+    return ret;
+}
+
+
+/// plots the solids to the initialized vector lists \a vlists, one per solid
+/** Solids without an internal are skipped.
+    ft_plot() takes its chunks from the global free list rt_vlfree, which isn't thread safe, therefore the solids are plotted serially.
+    The plots of all databases are serialized, the application must not use rt_vlfree in another thread meanwhile. */
+static void PlotSolids
+(
+    std::vector<PlotSolid>& solids,
+    std::vector<bu_list>&   vlists
+) {
+    // the plots of all databases share the free list
+    static std::mutex           plotMutex;
+    std::lock_guard<std::mutex> lock(plotMutex);
+
+    for (size_t i = 0; i < solids.size(); ++i) {
+        PlotSolid& solid = solids[i];
+
+        if (solid.internal.idb_ptr != nullptr) {
+            if (!BU_SETJUMP)
+                solid.internal.idb_meth->ft_plot(&vlists[i], &solid.internal, solid.ttol, solid.tol, nullptr);
+            else
+                BU_UNSETJUMP;
+
+            BU_UNSETJUMP;
+
+            rt_db_free_internal(&solid.internal);
+        }
+    }
+}
+
+
+/// the properties a solid inherits from the combinations on its path in a tree
+/** The color is inherited like in db_walk_tree(). */
+struct PlotAttributes {
+    bool   hasColor;
+    bool   inheritColor; ///< the color overrides the ones of the lower combinations
+    bool   inRegion;
+    bool   subtracted;   ///< the path goes through the right operand of a subtraction
+    double color[3];
+
+    PlotAttributes(void) : hasColor(false), inheritColor(false), inRegion(false), subtracted(false) {
+        VSETALL(color, 0.);
+    }
+};
+
+
+/// a solid in a tree and its accumulated transformation
+struct PlotLeafPosition {
+    directory*     pDir;
+    mat_t          matrix;
+    double         absoluteTolerance; ///< the tessellation tolerance for the solid, 0 for the tolerances of the database
+    PlotAttributes attributes;
+    rt_db_internal internal;          ///< the solid transformed by matrix if the filter has read it already, uninitialized otherwise
+};
+
+
+/// decides if an object at the accumulated transformation \a matrix is plotted
+/** \a absoluteTolerance may be set to a tessellation tolerance for a solid.
+    \a internal may be set to the completed solid read with \a matrix, which is taken over by its leaf or freed if the solid is culled. */
+typedef std::function<bool(directory*      pDir,
+                           const mat_t     matrix,
+                           double&         absoluteTolerance,
+                           rt_db_internal& internal)> PlotFilter;
+
+
+static bool CollectPlotLeaves
+(
+    db_i*                          dbip,
+    directory*                     pDir,
+    const mat_t                    matrix,
+    const PlotAttributes&          attributes,
+    const PlotFilter&              filter,
+    resource*                      resp,
+    std::vector<directory*>&       path,
+    std::vector<PlotLeafPosition>& leaves
+);
+
+
+static bool CollectPlotLeaves
+(
+    db_i*                          dbip,
+    const tree*                    node,
+    const mat_t                    matrix,
+    const PlotAttributes&          attributes,
+    const PlotFilter&              filter,
+    resource*                      resp,
+    std::vector<directory*>&       path,
+    std::vector<PlotLeafPosition>& leaves
+) {
+    bool ret = true;
+
+    switch (node->tr_op) {
+        case OP_DB_LEAF: {
+            directory* member = db_lookup(dbip, node->tr_l.tl_name, LOOKUP_QUIET);
+
+            if (member != RT_DIR_NULL) {
+                mat_t memberMatrix;
+
+                if (node->tr_l.tl_mat != nullptr)
+                    bn_mat_mul(memberMatrix, matrix, node->tr_l.tl_mat);
+                else
+                    MAT_COPY(memberMatrix, matrix);
+
+                ret = CollectPlotLeaves(dbip, member, memberMatrix, attributes, filter, resp, path, leaves);
+            }
+            else
+                ret = false;
+
+            break;
+        }
+
+        case OP_UNION:
+        case OP_INTERSECT:
+        case OP_XOR:
+            ret = CollectPlotLeaves(dbip, node->tr_b.tb_left, matrix, attributes, filter, resp, path, leaves);
+            ret = CollectPlotLeaves(dbip, node->tr_b.tb_right, matrix, attributes, filter, resp, path, leaves) && ret;
+            break;
+
+        case OP_SUBTRACT: {
+            PlotAttributes rightAttributes = attributes;
+
+            rightAttributes.subtracted = true;
+
+            ret = CollectPlotLeaves(dbip, node->tr_b.tb_left, matrix, attributes, filter, resp, path, leaves);
+            ret = CollectPlotLeaves(dbip, node->tr_b.tb_right, matrix, rightAttributes, filter, resp, path, leaves) && ret;
+            break;
+        }
+
+        case OP_NOT:
+        case OP_GUARD:
+        case OP_XNOP:
+            ret = CollectPlotLeaves(dbip, node->tr_b.tb_left, matrix, attributes, filter, resp, path, leaves);
+    }
+
+    return ret;
+}
+
+
+/// collects the solids of the tree of \a pDir in the order of db_walk_tree() without reading them
+/** Only the combinations are read, and only the ones accepted by \a filter.
+    \return false if a member is missing or can't be read, or the tree is cyclic */
+static bool CollectPlotLeaves
+(
+    db_i*                          dbip,
+    directory*                     pDir,
+    const mat_t                    matrix,
+    const PlotAttributes&          attributes,
+    const PlotFilter&              filter,
+    resource*                      resp,
+    std::vector<directory*>&       path,
+    std::vector<PlotLeafPosition>& leaves
+) {
+    bool           ret               = true;
+    double         absoluteTolerance = 0.;
+    rt_db_internal internal;
+
+    RT_DB_INTERNAL_INIT(&internal);
+
+    if (std::find(path.begin(), path.end(), pDir) != path.end())
+        ret = false;
+    else if (!filter(pDir, matrix, absoluteTolerance, internal))
+        ; // culled
+    else if (pDir->d_flags & RT_DIR_COMB) {
+        rt_db_internal intern;
+
+        if (rt_db_get_internal(&intern, pDir, dbip, nullptr, resp) >= 0) {
+            const rt_comb_internal* comb             = static_cast<const rt_comb_internal*>(intern.idb_ptr);
+            PlotAttributes          memberAttributes = attributes;
+
+            // a color within a region is ignored, and an inherited one overrides the lower ones
+            if ((comb->rgb_valid == 1) && !attributes.inRegion && !attributes.inheritColor) {
+                memberAttributes.hasColor     = true;
+                memberAttributes.inheritColor = (comb->inherit != 0);
+
+                for (size_t i = 0; i < 3; ++i)
+                    memberAttributes.color[i] = comb->rgb[i] / 255.;
+            }
+
+            if (comb->region_flag)
+                memberAttributes.inRegion = true;
+
+            if (comb->tree != TREE_NULL) {
+                path.push_back(pDir);
+                ret = CollectPlotLeaves(dbip, comb->tree, matrix, memberAttributes, filter, resp, path, leaves);
+                path.pop_back();
+            }
+
+            rt_db_free_internal(&intern);
+        }
+        else
+            ret = false;
+    }
+    else if (pDir->d_flags & RT_DIR_SOLID) {
+        PlotLeafPosition leaf;
+
+        leaf.pDir              = pDir;
+        MAT_COPY(leaf.matrix, matrix);
+        leaf.absoluteTolerance = absoluteTolerance;
+        leaf.attributes        = attributes;
+        leaf.internal          = internal;
+        leaves.push_back(leaf);
+        RT_DB_INTERNAL_INIT(&internal);
+    }
+
+    if (internal.idb_ptr != nullptr)
+        rt_db_free_internal(&internal);
+
+    return ret;
+}
+
+
+bool ConstDatabase::PlotCache::Plot
+(
+    const char*               objectName,
+    rt_i*                     rtip,
+    resource*                 resp,
+    const InternalCompletion& completion,
+    bu_list*                  plot
+) {
+    bool       ret  = false;
+    directory* pDir = db_lookup(rtip->rti_dbip, objectName, LOOKUP_QUIET);
+
+    if (pDir != RT_DIR_NULL) {
+        std::vector<directory*>       path;
+        std::vector<PlotLeafPosition> leaves;
+        mat_t                         identity;
+
+        MAT_IDN(identity);
+        ret = CollectPlotLeaves(rtip->rti_dbip, pDir, identity, PlotAttributes(), [](directory*, const mat_t, double&, rt_db_internal&) {return true;}, resp, path, leaves);
+        ret = PlotLeaves(this, leaves, rtip, completion, plot) && ret;
+    }
+
+    return ret;
+}
+
+
+bool ConstDatabase::PlotCache::PlotLeaves
+(
+    PlotCache*                           plotCache,
+    const std::vector<PlotLeafPosition>& leaves,
+    rt_i*                                rtip,
+    const InternalCompletion&            completion,
+    bu_list*                             plot
+) {
+    bool                     ret = true;
+    std::vector<PlotSolid>   solids(leaves.size());
+    std::vector<bg_tess_tol> tessellationTolerances(leaves.size(), rtip->rti_ttol);
+    std::vector<Key>         keys(leaves.size());
+    std::vector<char>        plotted(leaves.size(), 0);
+    std::vector<bu_list>     vlists(leaves.size());
+    std::vector<size_t>      reads;
+
+    // the cache is looked up serially
+    for (size_t i = 0; i < leaves.size(); ++i) {
+        bg_tess_tol& tessellationTolerance = tessellationTolerances[i];
+        Key&         key                   = keys[i];
+        PlotSolid&   solid                 = solids[i];
+
+        if (leaves[i].absoluteTolerance > 0.) {
+            tessellationTolerance.abs  = leaves[i].absoluteTolerance;
+            tessellationTolerance.rel  = 0.;
+            tessellationTolerance.norm = 0.;
+        }
+
+        key.pDir          = leaves[i].pDir;
+        MAT_COPY(key.matrix, leaves[i].matrix);
+        key.tolerances[0] = tessellationTolerance.abs;
+        key.tolerances[1] = tessellationTolerance.rel;
+        key.tolerances[2] = tessellationTolerance.norm;
+        key.tolerances[3] = rtip->rti_tol.dist;
+        key.tolerances[4] = rtip->rti_tol.perp;
+
+        BU_LIST_INIT(&vlists[i]);
+        RT_DB_INTERNAL_INIT(&solid.internal);
+        solid.ttol = &tessellationTolerance;
+        solid.tol  = &rtip->rti_tol;
+
+        if ((plotCache != nullptr) && plotCache->Find(key, &vlists[i])) {
+            if (leaves[i].internal.idb_ptr != nullptr) {
+                solid.internal = leaves[i].internal;
+                rt_db_free_internal(&solid.internal);
+                RT_DB_INTERNAL_INIT(&solid.internal);
+            }
+        }
+        else if (leaves[i].internal.idb_ptr != nullptr)
+            solid.internal = leaves[i].internal; // read and completed by the filter
+        else
+            reads.push_back(i);
+    }
+
+    // the missing solids are read and completed in parallel, they are plotted serially
+    ThreadResources   readResources(reads.size(), true);
+    std::vector<char> readFailed(reads.size(), 0);
+
+    ParallelFor(reads.size(), 1, [&leaves, &solids, &reads, &readResources, &readFailed, &completion, rtip](size_t begin, size_t end, size_t thread) {
+        for (size_t i = begin; i < end; ++i) {
+            const PlotLeafPosition& leaf  = leaves[reads[i]];
+            PlotSolid&              solid = solids[reads[i]];
+
+            if (!BU_SETJUMP) {
+                if (rt_db_get_internal(&solid.internal, leaf.pDir, rtip->rti_dbip, leaf.matrix, readResources.Get(thread)) >= 0)
+                    completion(leaf.pDir, leaf.matrix, solid.internal);
+                else {
+                    RT_DB_INTERNAL_INIT(&solid.internal);
+                    readFailed[i] = 1;
+                }
+            }
+            else {
+                BU_UNSETJUMP;
+                RT_DB_INTERNAL_INIT(&solid.internal);
+                readFailed[i] = 1;
+            }
+
+            BU_UNSETJUMP;
+        }
+    });
+
+    for (size_t i = 0; i < readFailed.size(); ++i) {
+        if (readFailed[i] != 0)
+            ret = false;
+    }
+
+    for (size_t i = 0; i < leaves.size(); ++i) {
+        PlotSolid& solid = solids[i];
+
+        if (solid.internal.idb_ptr != nullptr) {
+            if (solid.internal.idb_meth->ft_plot == nullptr) {
+                rt_db_free_internal(&solid.internal);
+                RT_DB_INTERNAL_INIT(&solid.internal);
+            }
+
+            plotted[i] = 1;
+        }
+    }
+
+    PlotSolids(solids, vlists);
+
+    for (size_t i = 0; i < leaves.size(); ++i) {
+        if ((plotCache != nullptr) && (plotted[i] != 0))
+            plotCache->Store(keys[i], &vlists[i]);
+
+        BU_LIST_APPEND_LIST(plot, &vlists[i]);
+    }
+
+    return ret;
+}
+
+
+/// axis aligned bounding box, empty if the minimum exceeds the maximum
+struct PlotBox {
+    double minimum[3];
+    double maximum[3];
+
+    PlotBox(void) {
+        VSETALL(minimum, INFINITY);
+        VSETALL(maximum, -INFINITY);
+    }
+
+    static PlotBox Unbounded(void) {
+        PlotBox ret;
+
+        VSETALL(ret.minimum, -INFINITY);
+        VSETALL(ret.maximum, INFINITY);
+
+        return ret;
+    }
+
+    bool Empty(void) const {
+        return (minimum[X] > maximum[X]) || (minimum[Y] > maximum[Y]) || (minimum[Z] > maximum[Z]);
+    }
+
+    bool Bounded(void) const {
+        return std::isfinite(minimum[X]) && std::isfinite(minimum[Y]) && std::isfinite(minimum[Z])
+               && std::isfinite(maximum[X]) && std::isfinite(maximum[Y]) && std::isfinite(maximum[Z]);
+    }
+
+    void Add
+    (
+        const double* point
+    ) {
+        VMIN(minimum, point);
+        VMAX(maximum, point);
+    }
+
+    void Add
+    (
+        const PlotBox& box
+    ) {
+        if (!box.Empty()) {
+            Add(box.minimum);
+            Add(box.maximum);
+        }
+    }
+
+    /// the box around the corners transformed by \a matrix
+    PlotBox Transformed
+    (
+        const mat_t matrix
+    ) const {
+        PlotBox ret;
+
+        if (Empty())
+            ; // stays empty
+        else if (!Bounded())
+            ret = Unbounded();
+        else {
+            for (int corner = 0; corner < 8; ++corner) {
+                point_t point;
+                point_t transformed;
+
+                VSET(point,
+                     (corner & 1) ? maximum[X] : minimum[X],
+                     (corner & 2) ? maximum[Y] : minimum[Y],
+                     (corner & 4) ? maximum[Z] : minimum[Z]);
+                MAT4X3PNT(transformed, matrix, point);
+                ret.Add(transformed);
+            }
+        }
+
+        return ret;
+    }
+};
+
+
+/// the bounding boxes of the objects in their own coordinates, used to cull the subtrees in the view dependent ConstDatabase::Plot()
+/** The boxes of the solids are taken from the solids read for the plot, the ones of the combinations are put together from the boxes of their members afterwards.
+    Therefore, no solid is read for its box alone. */
+class ConstDatabase::BoundingBoxCache {
+public:
+    /// sets \a box to the cached bounding box of \a pDir
+    /** \return false if the box isn't known yet */
+    bool Find
+    (
+        const directory* pDir,
+        PlotBox&         box
+    ) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto                        entry = m_boxes.find(pDir->d_namep);
+        bool                        ret   = (entry != m_boxes.end());
+
+        if (ret)
+            box = entry->second.box;
+
+        return ret;
+    }
+
+    /// reads the solid \a pDir transformed by \a matrix into \a internal and caches its bounding box
+    /** The box of a rotated solid is cached as the box around its rotated box, which is larger than necessary but still encloses the solid.
+        \a internal stays uninitialized if the solid can't be read.
+        \return the bounding box of the transformed solid, unbounded if it is unknown */
+    PlotBox ReadSolid
+    (
+        db_i*                     dbip,
+        directory*                pDir,
+        const mat_t               matrix,
+        const bn_tol*             tol,
+        resource*                 resp,
+        const InternalCompletion& completion,
+        rt_db_internal&           internal
+    ) {
+        PlotBox ret;
+
+        if (rt_db_get_internal(&internal, pDir, dbip, matrix, resp) >= 0) {
+            mat_t inverse;
+
+            completion(pDir, matrix, internal);
+
+            if (internal.idb_meth->ft_bbox != nullptr) {
+                point_t minimum;
+                point_t maximum;
+
+                if (internal.idb_meth->ft_bbox(&internal, &minimum, &maximum, tol) == 0) {
+                    ret.Add(minimum);
+                    ret.Add(maximum);
+                }
+                else
+                    ret = PlotBox::Unbounded();
+            }
+            else
+                ret = PlotBox::Unbounded();
+
+            if (bn_mat_inverse(inverse, matrix) != 0) {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                Entry&                      entry = m_boxes[pDir->d_namep];
+
+                entry.box         = ret.Transformed(inverse);
+                entry.combination = false;
+            }
+        }
+        else {
+            RT_DB_INTERNAL_INIT(&internal);
+            ret = PlotBox::Unbounded();
+        }
+
+        return ret;
+    }
+
+    /// caches the bounding boxes of \a pDir and the combinations below it whose members' boxes are known
+    void Update
+    (
+        db_i*      dbip,
+        directory* pDir,
+        resource*  resp
+    ) {
+        std::vector<directory*> path;
+        PlotBox                 box;
+
+        Get(dbip, pDir, resp, path, box);
+    }
+
+    void Invalidate
+    (
+        const char* objectName,
+        ChangeType  changeType
+    ) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if (changeType == ChangeType::References)
+            ; // only the reference counters were updated
+        else if ((objectName == nullptr) || (changeType == ChangeType::Unknown))
+            m_boxes.clear();
+        else {
+            m_boxes.erase(objectName);
+
+            // the boxes of the combinations may depend on the object
+            for (auto box = m_boxes.begin(); box != m_boxes.end();) {
+                if (box->second.combination)
+                    box = m_boxes.erase(box);
+                else
+                    ++box;
+            }
+        }
+    }
+
+    void Clear(void) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        m_boxes.clear();
+    }
+
+private:
+    struct Entry {
+        PlotBox box;
+        bool    combination;
+    };
+
+    std::mutex                   m_mutex;
+    std::map<std::string, Entry> m_boxes;
+
+    /// sets \a box to the bounding box of \a pDir, which is unbounded if it is unknown
+    /** Only combinations are read, the boxes of the solids have to be in the cache already.
+        \return false if the box is incomplete because a solid's box isn't known, a member is missing or the tree is cyclic */
+    bool Get
+    (
+        db_i*                    dbip,
+        directory*               pDir,
+        resource*                resp,
+        std::vector<directory*>& path,
+        PlotBox&                 box
+    ) {
+        bool ret = Find(pDir, box);
+
+        if (!ret) {
+            rt_db_internal intern;
+
+            box = PlotBox();
+
+            if (!(pDir->d_flags & RT_DIR_COMB) || (std::find(path.begin(), path.end(), pDir) != path.end()))
+                box = PlotBox::Unbounded();
+            else if (rt_db_get_internal(&intern, pDir, dbip, nullptr, resp) >= 0) {
+                const rt_comb_internal* comb = static_cast<const rt_comb_internal*>(intern.idb_ptr);
+
+                ret = true;
+
+                if (comb->tree != TREE_NULL) {
+                    path.push_back(pDir);
+                    ret = AddMembers(dbip, comb->tree, resp, path, box);
+                    path.pop_back();
+                }
+
+                rt_db_free_internal(&intern);
+            }
+            else
+                box = PlotBox::Unbounded();
+
+            if (ret) {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                Entry&                      entry = m_boxes[pDir->d_namep];
+
+                entry.box         = box;
+                entry.combination = true;
+            }
+        }
+
+        return ret;
+    }
+
+    /// adds the boxes of the members of a combination's tree to \a box
+    /** \return false if a member's box is incomplete */
+    bool AddMembers
+    (
+        db_i*                    dbip,
+        const tree*              node,
+        resource*                resp,
+        std::vector<directory*>& path,
+        PlotBox&                 box
+    ) {
+        bool ret = true;
+
+        switch (node->tr_op) {
+            case OP_DB_LEAF: {
+                directory* member = db_lookup(dbip, node->tr_l.tl_name, LOOKUP_QUIET);
+
+                if (member != RT_DIR_NULL) {
+                    PlotBox memberBox;
+
+                    ret = Get(dbip, member, resp, path, memberBox);
+
+                    if (node->tr_l.tl_mat != nullptr)
+                        memberBox = memberBox.Transformed(node->tr_l.tl_mat);
+
+                    box.Add(memberBox);
+                }
+                else
+                    ret = false;
+
+                break;
+            }
+
+            case OP_UNION:
+            case OP_INTERSECT:
+            case OP_SUBTRACT:
+            case OP_XOR:
+                ret = AddMembers(dbip, node->tr_b.tb_left, resp, path, box);
+                ret = AddMembers(dbip, node->tr_b.tb_right, resp, path, box) && ret;
+                break;
+
+            case OP_NOT:
+            case OP_GUARD:
+            case OP_XNOP:
+                ret = AddMembers(dbip, node->tr_b.tb_left, resp, path, box);
+        }
+
+        return ret;
+    }
+};
+
+
+struct PlotView {
+    mat_t  matrix;         ///< model to clip coordinates
+    double halfWidth;      ///< half of the viewport width in pixels
+    double halfHeight;     ///< half of the viewport height in pixels
+    double pixelTolerance;
+};
+
+
+/// tests \a box in model coordinates against \a view and sets \a absoluteTolerance to a coarser tessellation tolerance than \a tessellationTolerance if it is sufficient
+/** \return false if \a box is outside the view or smaller than the pixel tolerance */
+static bool InView
+(
+    const PlotView&    view,
+    const PlotBox&     box,
+    const bg_tess_tol& tessellationTolerance,
+    double&            absoluteTolerance
+) {
+    bool ret = !box.Empty();
+
+    absoluteTolerance = 0.;
+
+    if (ret && box.Bounded()) {
+        double clip[8][4];
+        bool   inFront = true;
+
+        for (int corner = 0; corner < 8; ++corner) {
+            point_t point;
+
+            VSET(point,
+                 (corner & 1) ? box.maximum[X] : box.minimum[X],
+                 (corner & 2) ? box.maximum[Y] : box.minimum[Y],
+                 (corner & 4) ? box.maximum[Z] : box.minimum[Z]);
+
+            // without the perspective division of MAT4X3PNT()
+            for (int row = 0; row < 4; ++row)
+                clip[corner][row] = view.matrix[4 * row] * point[X] + view.matrix[4 * row + 1] * point[Y] + view.matrix[4 * row + 2] * point[Z] + view.matrix[4 * row + 3];
+
+            if (clip[corner][W] <= 0.)
+                inFront = false;
+        }
+
+        // outside if all corners are beyond the same clipping plane
+        for (int axis = X; ret && (axis <= Z); ++axis) {
+            int below = 0;
+            int above = 0;
+
+            for (int corner = 0; corner < 8; ++corner) {
+                if (clip[corner][axis] < -clip[corner][W])
+                    ++below;
+                else if (clip[corner][axis] > clip[corner][W])
+                    ++above;
+            }
+
+            if ((below == 8) || (above == 8))
+                ret = false;
+        }
+
+        // the size on the screen is known only if the box is completely in front of the eye
+        if (ret && inFront) {
+            double minimum[2] = {INFINITY, INFINITY};
+            double maximum[2] = {-INFINITY, -INFINITY};
+
+            for (int corner = 0; corner < 8; ++corner) {
+                for (int axis = X; axis <= Y; ++axis) {
+                    double device = clip[corner][axis] / clip[corner][W];
+
+                    minimum[axis] = std::min(minimum[axis], device);
+                    maximum[axis] = std::max(maximum[axis], device);
+                }
+            }
+
+            double width  = (maximum[X] - minimum[X]) * view.halfWidth;
+            double height = (maximum[Y] - minimum[Y]) * view.halfHeight;
+
+            if (std::max(width, height) < view.pixelTolerance)
+                ret = false;
+            else if (view.pixelTolerance > 0.) {
+                // the model distance per pixel tolerance, rounded down to a power of 2 to keep the plot cache usable while zooming
+                double diameter          = DIST_PNT_PNT(box.minimum, box.maximum);
+                double tolerance         = exp2(floor(log2(view.pixelTolerance * diameter / sqrt(width * width + height * height))));
+                double databaseTolerance = tessellationTolerance.abs;
+
+                if ((tessellationTolerance.rel > 0.) && ((databaseTolerance <= 0.) || (tessellationTolerance.rel * diameter < databaseTolerance)))
+                    databaseTolerance = tessellationTolerance.rel * diameter;
+
+                if ((databaseTolerance <= 0.) || (tolerance > databaseTolerance))
+                    absoluteTolerance = tolerance;
+            }
+        }
+    }
+
+    return ret;
+}
+
+
+void ConstDatabase::Plot
+(
+    const char* objectName,
+    VectorList& vectorList
+) const {
+    if (m_rtip != nullptr) {
+        std::string                key;
+        std::vector<unsigned char> cached;
+        bool                       found = (m_facetizationCache != nullptr) && m_facetizationCache->Find(m_rtip, m_resp, objectName, 'p', false, key, cached) &&
+                                           VectorListFromCache(cached, vectorList.m_freeChunks, vectorList.m_vlist);
+
+        if (!found) {
+            found = (m_facetizationCache != nullptr) && m_facetizationCache->Find(m_rtip, m_resp, objectName, 'p', true, key, cached) &&
+                    VectorListFromCache(cached, vectorList.m_freeChunks, vectorList.m_vlist);
+
+            if (!found) {
+                const InternalCompletion completion = Completion();
+                bu_list                  plot;
+
+                BU_LIST_INIT(&plot);
+
+                if (!BU_SETJUMP) {
+                    bool complete;
+
+                    if (m_plotCache != nullptr)
+                        complete = m_plotCache->Plot(objectName, m_rtip, m_resp, completion, &plot);
+                    else {
+                        PlotLeafData  plotLeafData(completion);
+                        db_tree_state initState;
+
+                        db_init_db_tree_state(&initState, m_rtip->rti_dbip);
+                        initState.ts_ttol = &m_rtip->rti_ttol;
+                        initState.ts_tol  = &m_rtip->rti_tol;
+
+                        // the database is read and the solids are plotted serially
+                        int walkResult = db_walk_tree(m_rtip->rti_dbip,
+                                                      1,
+                                                      &objectName,
+                                                      1,
+                                                      &initState,
+                                                      nullptr,
+                                                      nullptr,
+                                                      PlotLeaf,
+                                                      &plotLeafData);
+
+                        std::vector<PlotSolid>& solids = plotLeafData.solids;
+                        std::vector<bu_list>    vlists(solids.size());
+
+                        for (size_t i = 0; i < vlists.size(); ++i)
+                            BU_LIST_INIT(&vlists[i]);
+
+                        PlotSolids(solids, vlists);
+
+                        for (size_t i = 0; i < vlists.size(); ++i)
+                            BU_LIST_APPEND_LIST(&plot, &vlists[i]);
+
+                        complete = (walkResult == 0);
+                    }
+
+                    if (complete && !key.empty()) {
+                        VectorListToCache(&plot, cached);
+                        m_facetizationCache->Store(key, cached);
+                    }
+                }
+                else
+                    BU_UNSETJUMP;
+
+                BU_UNSETJUMP;
+
+                BU_LIST_APPEND_LIST(vectorList.m_vlist, &plot);
+            }
+        }
+    }
+}
+
+
+void ConstDatabase::Plot
+(
+    const char*  objectName,
+    const double viewMatrix[16],
+    size_t       viewportWidth,
+    size_t       viewportHeight,
+    double       pixelTolerance,
+    VectorList&  vectorList
+) const {
+    if (m_rtip != nullptr) {
+        PlotView view;
+
+        MAT_COPY(view.matrix, viewMatrix);
+        view.halfWidth      = viewportWidth / 2.;
+        view.halfHeight     = viewportHeight / 2.;
+        view.pixelTolerance = pixelTolerance;
+
+        const InternalCompletion completion = Completion();
+        bu_list                  plot;
+
+        BU_LIST_INIT(&plot);
+
+        if (!BU_SETJUMP) {
+            directory* pDir = db_lookup(m_rtip->rti_dbip, objectName, LOOKUP_QUIET);
+
+            if (pDir != RT_DIR_NULL) {
+                std::vector<directory*>       path;
+                std::vector<PlotLeafPosition> leaves;
+                mat_t                         identity;
+
+                MAT_IDN(identity);
+
+                CollectPlotLeaves(m_rtip->rti_dbip,
+                                  pDir,
+                                  identity,
+                                  PlotAttributes(),
+                                  [this, &view, &completion](directory* pMember, const mat_t matrix, double& absoluteTolerance, rt_db_internal& internal) {
+                                      PlotBox box;
+
+                                      if (m_boundingBoxCache->Find(pMember, box))
+                                          box = box.Transformed(matrix);
+                                      else if (pMember->d_flags & RT_DIR_SOLID)
+                                          box = m_boundingBoxCache->ReadSolid(m_rtip->rti_dbip, pMember, matrix, &m_rtip->rti_tol, m_resp, completion, internal);
+                                      else
+                                          box = PlotBox::Unbounded(); // a combination is culled as soon as the boxes of its members are known
+
+                                      return InView(view, box, m_rtip->rti_ttol, absoluteTolerance);
+                                  },
+                                  m_resp,
+                                  path,
+                                  leaves);
+
+                m_boundingBoxCache->Update(m_rtip->rti_dbip, pDir, m_resp);
+
+                PlotCache::PlotLeaves(m_plotCache, leaves, m_rtip, completion, &plot);
+            }
+        }
+        else
+            BU_UNSETJUMP;
+
+        BU_UNSETJUMP;
+
+        BU_LIST_APPEND_LIST(vectorList.m_vlist, &plot);
+    }
+}
+
+
+/// a solid of PlotShaded() and its tessellation
+struct ShadedSolid {
+    rt_db_internal      internal; ///< the solid, untransformed
+    std::vector<double> vertices;
+    std::vector<size_t> triangles;
+};
+
+
+/// tessellates a solid to an indexed triangle mesh, bags of triangles are taken as they are
+static void TessellateShadedSolid
+(
+    ShadedSolid&       solid,
+    const bg_tess_tol* ttol,
+    const bn_tol*      tol
+) {
+    const rt_bot_internal* bot          = nullptr;
+    rt_bot_internal*       tessellation = nullptr;
+
+    if ((solid.internal.idb_major_type == DB5_MAJORTYPE_BRLCAD) && (solid.internal.idb_minor_type == ID_BOT))
+        bot = static_cast<const rt_bot_internal*>(solid.internal.idb_ptr);
+    else if (solid.internal.idb_meth->ft_tessellate != nullptr) {
+        model*     solidModel  = nmg_mm();
+        nmgregion* solidRegion = nullptr;
+
+        if (!BU_SETJUMP) {
+            if ((solid.internal.idb_meth->ft_tessellate(&solidRegion, solidModel, &solid.internal, ttol, tol) == 0) && (solidRegion != nullptr)) {
+                bu_list vlfree;
 
-            m_rtip = nullptr;
-        }
+                BU_LIST_INIT(&vlfree);
 
-        if (!BU_SETJUMP)
-            m_rtip = rt_dirbuild(fileName, nullptr, 0);
+                tessellation = nmg_mdl_to_bot(solidModel, &vlfree, tol);
+                bot          = tessellation;
+
+                bv_vlist_cleanup(&vlfree);
+            }
+        }
+        else
+            BU_UNSETJUMP;
 
         BU_UNSETJUMP;
 
-        if (m_rtip != nullptr) {
-            if (!BU_SETJUMP) {
-                rt_init_resource(m_resp, 0, m_rtip);
-                RegisterCoreCallbacks();
-            }
-            else {
-                BU_UNSETJUMP;
+        nmg_km(solidModel);
+    }
 
-                if (!BU_SETJUMP) {
-                    DeRegisterCoreCallbacks();
-                    rt_free_rti(m_rtip);
-                }
+    if (bot != nullptr) {
+        solid.vertices.assign(bot->vertices, bot->vertices + 3 * bot->num_vertices);
+        solid.triangles.reserve(3 * bot->num_faces);
 
-                m_rtip = nullptr;
-            }
+        for (size_t i = 0; i < bot->num_faces; ++i) {
+            const int* face = bot->faces + 3 * i;
 
-            BU_UNSETJUMP;
+            if (bot->orientation == RT_BOT_CW) {
+                solid.triangles.push_back(static_cast<size_t>(face[0]));
+                solid.triangles.push_back(static_cast<size_t>(face[2]));
+                solid.triangles.push_back(static_cast<size_t>(face[1]));
+            }
+            else {
+                for (size_t j = 0; j < 3; ++j)
+                    solid.triangles.push_back(static_cast<size_t>(face[j]));
+            }
         }
     }
 
-    return (m_rtip != nullptr);
+    if (tessellation != nullptr)
+        FreeBot(tessellation);
+
+    rt_db_free_internal(&solid.internal);
 }
 
 
-const char* ConstDatabase::Title(void) const {
-    const char* ret = nullptr;
+void ConstDatabase::PlotShaded
+(
+    const char*                                         objectName,
+    const std::function<void(const ShadedMesh& mesh)>& callback
+) const {
+    if (m_rtip != nullptr) {
+        std::vector<PlotLeafPosition>          leaves;
+        std::vector<size_t>                    solidIndices;
+        std::vector<ShadedSolid>               solids;
+        std::unordered_map<directory*, size_t> solidOfDirectory;
 
-    if (m_rtip != nullptr)
-        ret = m_rtip->rti_dbip->dbi_title;
+        if (!BU_SETJUMP) {
+            directory* pDir = db_lookup(m_rtip->rti_dbip, objectName, LOOKUP_QUIET);
 
-    return ret;
-}
+            if (pDir != RT_DIR_NULL) {
+                std::vector<directory*> path;
+                mat_t                   identity;
 
+                MAT_IDN(identity);
+                CollectPlotLeaves(m_rtip->rti_dbip, pDir, identity, PlotAttributes(), [](directory*, const mat_t, double&, rt_db_internal&) {return true;}, m_resp, path, leaves);
 
-const ConstDatabase::TopObjectIterator& ConstDatabase::TopObjectIterator::operator++(void) {
-    if (m_pDir != nullptr) {
-        const directory* oldPDir = m_pDir;
+                // the solids are read serially and untransformed, once for all of their occurrences
+                solidIndices.resize(leaves.size(), SIZE_MAX);
 
-        for (const directory* pDir = m_pDir->d_forw; pDir != RT_DIR_NULL; pDir = pDir->d_forw) {
-            if (pDir->d_nref == 0) {
-                m_pDir = pDir;
-                break;
-            }
-        }
+                for (size_t i = 0; i < leaves.size(); ++i) {
+                    if (leaves[i].attributes.subtracted)
+                        continue;
 
-        if (m_pDir == oldPDir) {
-            for (size_t i = m_hashTablePosition + 1; (i < RT_DBNHASH) && (m_pDir == oldPDir); ++i) {
-                for (const directory* pDir = db_dirptr(m_rtip->rti_dbip, i); pDir != RT_DIR_NULL; pDir = pDir->d_forw) {
-                    if (pDir->d_nref == 0) {
-                        m_hashTablePosition = i;
-                        m_pDir              = pDir;
-                        break;
+                    auto found = solidOfDirectory.find(leaves[i].pDir);
+
+                    if (found != solidOfDirectory.end())
+                        solidIndices[i] = found->second;
+                    else {
+                        ShadedSolid solid;
+
+                        if (rt_db_get_internal(&solid.internal, leaves[i].pDir, m_rtip->rti_dbip, nullptr, m_resp) >= 0) {
+                            CompleteInternal(leaves[i].pDir, nullptr, solid.internal);
+
+                            solidIndices[i] = solids.size();
+                            solidOfDirectory[leaves[i].pDir] = solids.size();
+                            solids.push_back(std::move(solid));
+                        }
                     }
                 }
+
+                NonManifoldFor(solids.size(), m_parallelNmg, [this, &solids](size_t begin, size_t end, size_t) {
+                    for (size_t i = begin; i < end; ++i)
+                        TessellateShadedSolid(solids[i], &m_rtip->rti_ttol, &m_rtip->rti_tol);
+                });
             }
         }
+        else
+            BU_UNSETJUMP;
 
-        if (m_pDir == oldPDir)
-            m_pDir = nullptr;
-    }
+        BU_UNSETJUMP;
 
-    return *this;
+        for (size_t i = 0; i < solidIndices.size(); ++i) {
+            if (solidIndices[i] < solids.size()) {
+                const PlotLeafPosition& leaf  = leaves[i];
+                const ShadedSolid&      solid = solids[solidIndices[i]];
+
+                if (!solid.triangles.empty()) {
+                    ShadedMesh mesh;
+
+                    mesh.solidName         = leaf.pDir->d_namep;
+                    mesh.matrix            = leaf.matrix;
+                    mesh.hasColor          = leaf.attributes.hasColor;
+                    mesh.red               = leaf.attributes.color[0];
+                    mesh.green             = leaf.attributes.color[1];
+                    mesh.blue              = leaf.attributes.color[2];
+                    mesh.numberOfVertices  = solid.vertices.size() / 3;
+                    mesh.vertices          = solid.vertices.data();
+                    mesh.numberOfTriangles = solid.triangles.size() / 3;
+                    mesh.triangles         = solid.triangles.data();
+
+                    callback(mesh);
+                }
+            }
+        }
+    }
 }
 
 
-bool ConstDatabase::TopObjectIterator::Good(void) const {
-    return (m_pDir != nullptr);
+ConstDatabase::BooleanBackend ConstDatabase::FacetizeBooleanBackend(void) const {
+    return m_booleanBackend;
 }
 
 
-const char* ConstDatabase::TopObjectIterator::Name(void) const {
-    assert(m_pDir != nullptr);
+bool ConstDatabase::SetFacetizeBooleanBackend
+(
+    BooleanBackend backend
+) {
+    bool ret = true;
 
-    const char* ret = nullptr;
+#ifndef HAVE_MANIFOLD
+    ret = (backend != BooleanBackend::Manifold);
+#endif
 
-    if (m_pDir != nullptr)
-        ret = m_pDir->d_namep;
+    if (ret)
+        m_booleanBackend = backend;
 
     return ret;
 }
 
 
-ConstDatabase::TopObjectIterator::TopObjectIterator
-(
-    size_t           hashTablePosition,
-    const directory* pDir,
-    const rt_i*      rtip
-) : m_hashTablePosition(hashTablePosition), m_pDir(pDir), m_rtip(rtip) {}
+bool ConstDatabase::ParallelNonManifoldGeometry(void) const {
+    return m_parallelNmg;
+}
 
 
-ConstDatabase::TopObjectIterator ConstDatabase::FirstTopObject(void) const {
-    size_t           hashTablePosition = 0;
-    const directory* pDirectory        = nullptr;
+void ConstDatabase::SetParallelNonManifoldGeometry
+(
+    bool parallel
+) {
+    m_parallelNmg = parallel;
+}
 
-    if (m_rtip != nullptr) {
-        if (!BU_SETJUMP) {
-            m_selfUpdateNref = true;
-            db_update_nref(m_rtip->rti_dbip);
-            m_selfUpdateNref = false;
 
-            for (size_t i = 0; (i < RT_DBNHASH) && (pDirectory == nullptr); ++i) {
-                for (const directory* pDir = db_dirptr(m_rtip->rti_dbip, i); pDir != RT_DIR_NULL; pDir = pDir->d_forw) {
-                    if (pDir->d_nref == 0) {
-                        hashTablePosition = i;
-                        pDirectory        = pDir;
-                        break;
-                    }
-                }
-            }
-        }
+double ConstDatabase::DistanceTolerance(void) const {
+    double ret = 0.0005; // BRL-CAD's default
 
-        BU_UNSETJUMP;
-    }
+    if (m_rtip != nullptr)
+        ret = m_rtip->rti_tol.dist;
 
-    return ConstDatabase::TopObjectIterator(hashTablePosition, pDirectory, m_rtip);
+    return ret;
 }
 
 
-void ConstDatabase::Get
+void ConstDatabase::EnableFacetizationCache
 (
-    const char*                                      objectName,
-    const std::function<void(const Object& object)>& callback
-) const {
-    if (m_rtip != nullptr) {
-        if (!BU_SETJUMP) {
-            if ((objectName != nullptr) && (strlen(objectName) > 0)) {
-                directory* pDir = db_lookup(m_rtip->rti_dbip, objectName, LOOKUP_NOISE);
+    const char* cacheDirectory,
+    size_t      memoryLimit
+) {
+    delete m_facetizationCache;
+    m_facetizationCache = new FacetizationCache(*this, cacheDirectory, memoryLimit);
+}
 
-                GetInternal(pDir, callback);
-            }
-        }
 
-        BU_UNSETJUMP;
-    }
+void ConstDatabase::DisableFacetizationCache(void) {
+    delete m_facetizationCache;
+    m_facetizationCache = nullptr;
 }
 
 
-Object* ConstDatabase::Get
+void ConstDatabase::EnablePlotCache
 (
-    const char* objectName
-) const {
-    Object* ret = nullptr;
+    size_t memoryLimit
+) {
+    delete m_plotCache;
+    m_plotCache = new PlotCache(memoryLimit);
+}
 
-    Get(objectName, [&ret](const Object& object){try{ret = object.Clone();}catch(std::bad_alloc&){}});
 
-    return ret;
+void ConstDatabase::DisablePlotCache(void) {
+    delete m_plotCache;
+    m_plotCache = nullptr;
 }
 
 
-static tree* FacetizeRegionEnd
-(
-    db_tree_state*      tsp,
-    const db_full_path* pathp,
-    tree*               curtree,
-    void*               clientData
-) {
-    tree* ret = TREE_NULL;
+void ConstDatabase::DeleteCaches(void) {
+    delete m_facetizationCache;
+    m_facetizationCache = nullptr;
 
-    if (tsp != nullptr)
-        RT_CK_DBTS(tsp);
+    delete m_plotCache;
+    m_plotCache = nullptr;
 
-    if (pathp != nullptr)
-        RT_CK_FULL_PATH(pathp);
+    delete m_boundingBoxCache;
+    m_boundingBoxCache = nullptr;
+}
 
-    tree**  facetizeTree = static_cast<tree**>(clientData);
-    bu_list vhead;
-    BU_LIST_INIT(&vhead);
 
-    if (curtree->tr_op == OP_NOP)
-        ret = curtree;
-    else {
-        if (*facetizeTree) {
-            tree *tr;
+static bool CollectSelectParts
+(
+    db_i*                     dbip,
+    directory*                pDir,
+    const std::string&        path,
+    resource*                 resp,
+    std::vector<directory*>&  stack,
+    std::vector<std::string>& parts
+);
 
-            BU_GET(tr, tree);
-            RT_TREE_INIT(tr);
 
-            tr->tr_op           = OP_UNION;
-            tr->tr_b.tb_regionp = REGION_NULL;
-            tr->tr_b.tb_left    = *facetizeTree;
-            tr->tr_b.tb_right   = curtree;
+static void CollectMemberNames
+(
+    const tree*               node,
+    std::vector<std::string>& names
+) {
+    switch (node->tr_op) {
+        case OP_DB_LEAF:
+            names.push_back(node->tr_l.tl_name);
+            break;
 
-            *facetizeTree = tr;
-        }
-        else
-            *facetizeTree = curtree;
-    }
+        case OP_UNION:
+        case OP_INTERSECT:
+        case OP_SUBTRACT:
+        case OP_XOR:
+            CollectMemberNames(node->tr_b.tb_left, names);
+            CollectMemberNames(node->tr_b.tb_right, names);
+            break;
 
-    return ret;
+        case OP_NOT:
+        case OP_GUARD:
+        case OP_XNOP:
+            CollectMemberNames(node->tr_b.tb_left, names);
+    }
 }
 
 
-NonManifoldGeometry* ConstDatabase::Facetize
+/// splits the tree of \a pDir at \a path into the paths of its regions and of the solids which aren't in a region
+/** rt_gettree() gives the same result for these paths one after the other as for \a path.
+    A combination which has a member more than once can't be split, because a path selects the first instance only.
+    \return false if a member is missing or can't be read, or the tree is cyclic */
+static bool CollectSelectParts
 (
-    const char* objectName
-) const {
-    NonManifoldGeometry* ret          = new NonManifoldGeometry;
+    db_i*                     dbip,
+    directory*                pDir,
+    const std::string&        path,
+    resource*                 resp,
+    std::vector<directory*>&  stack,
+    std::vector<std::string>& parts
+) {
+    bool ret = true;
 
-    if (m_rtip != nullptr) {
-        if (!BU_SETJUMP) {
-            tree*                facetizeTree = nullptr;
-            db_tree_state        initState;
+    if (std::find(stack.begin(), stack.end(), pDir) != stack.end())
+        ret = false;
+    else if ((pDir->d_flags & RT_DIR_COMB) && !(pDir->d_flags & RT_DIR_REGION)) {
+        rt_db_internal intern;
+
+        if (rt_db_get_internal(&intern, pDir, dbip, nullptr, resp) >= 0) {
+            const rt_comb_internal*  comb = static_cast<const rt_comb_internal*>(intern.idb_ptr);
+            std::vector<std::string> names;
 
-            db_init_db_tree_state(&initState, m_rtip->rti_dbip);
-            initState.ts_ttol = &m_rtip->rti_ttol;
-            initState.ts_tol  = &m_rtip->rti_tol;
-            initState.ts_m    = &ret->m_internalp;
+            if (comb->tree != TREE_NULL)
+                CollectMemberNames(comb->tree, names);
 
-            if (db_walk_tree(m_rtip->rti_dbip,
-                             1,
-                             &objectName,
-                             1,
-                             &initState,
-                             nullptr,
-                             FacetizeRegionEnd,
-                             rt_booltree_leaf_tess,
-                             &facetizeTree) == 0) {
-                if (facetizeTree != nullptr) {
-                    nmg_boolean(facetizeTree, ret->m_internalp, &rt_vlfree, &m_rtip->rti_tol);
+            std::vector<std::string> sortedNames = names;
 
-                    // ok, now we have a mess here: the model/region with the faces is both in ret and facetizeTree
-                    // freeing facetizeTree would destroy the ret too
-                    // therefore we make a copy and destroy facetizeTree and the old ret->m_internalp afterwards
-                    assert(ret->m_internalp == facetizeTree->tr_d.td_r->m_p);
+            std::sort(sortedNames.begin(), sortedNames.end());
+
+            if (std::adjacent_find(sortedNames.begin(), sortedNames.end()) != sortedNames.end())
+                parts.push_back(path);
+            else {
+                stack.push_back(pDir);
 
-                    model* messedModel = ret->m_internalp;
-                    ret->m_internalp   = nmg_clone_model(messedModel);
+                for (size_t i = 0; ret && (i < names.size()); ++i) {
+                    directory* member = db_lookup(dbip, names[i].c_str(), LOOKUP_QUIET);
 
-                    db_free_tree(facetizeTree);
-                    nmg_km(messedModel);
+                    if (member != RT_DIR_NULL)
+                        ret = CollectSelectParts(dbip, member, path + "/" + names[i], resp, stack, parts);
+                    else
+                        ret = false;
                 }
+
+                stack.pop_back();
             }
-        }
-        else {
-            BU_UNSETJUMP;
-        }
 
-        BU_UNSETJUMP;
+            rt_db_free_internal(&intern);
+        }
+        else
+            ret = false;
     }
+    else
+        parts.push_back(path);
 
     return ret;
 }
 
 
-static tree* PlotLeaf
+void ConstDatabase::Select
 (
-    db_tree_state*      tsp,
-    const db_full_path* pathp,
-    rt_db_internal*     ip,
-    void*               clientData
+    const char* objectName
 ) {
-    tree*    ret   = TREE_NULL;
-    bu_list* vlist = static_cast<bu_list*>(clientData);
+    if (m_rtip != nullptr) {
+        std::vector<std::string> parts;
 
-    if (ip->idb_meth->ft_plot != nullptr) {
-        if (ip->idb_meth->ft_plot(vlist, ip, tsp->ts_ttol, tsp->ts_tol, nullptr) == 0) {
-            // Indicate success by returning something other than TREE_NULL
-            BU_GET(ret, tree);
-            RT_TREE_INIT(ret);
-            ret->tr_op = OP_NOP;
-        }
-    }
+        // objects kept outside of the database are written to it for the time of the access, one region after the other
+        if (KeepsContent()) {
+            if (!BU_SETJUMP) {
+                directory* pDir = db_lookup(m_rtip->rti_dbip, objectName, LOOKUP_QUIET);
 
-    return ret;
-}
+                if (pDir != RT_DIR_NULL) {
+                    std::vector<directory*> stack;
 
+                    if (!CollectSelectParts(m_rtip->rti_dbip, pDir, objectName, m_resp, stack, parts))
+                        parts.clear();
+                }
+            }
+            else {
+                BU_UNSETJUMP;
+                parts.clear();
+            }
 
-void ConstDatabase::Plot
-(
-    const char* objectName,
-    VectorList& vectorList
-) const {
-    if (m_rtip != nullptr) {
-        if (!BU_SETJUMP) {
-            db_tree_state initState;
-
-            db_init_db_tree_state(&initState, m_rtip->rti_dbip);
-            initState.ts_ttol = &m_rtip->rti_ttol;
-            initState.ts_tol  = &m_rtip->rti_tol;
-
-            db_walk_tree(m_rtip->rti_dbip,
-                         1,
-                         &objectName,
-                         1,
-                         &initState,
-                         nullptr,
-                         nullptr,
-                         PlotLeaf,
-                         vectorList.m_vlist);
-        }
-        else
             BU_UNSETJUMP;
+        }
 
-        BU_UNSETJUMP;
-    }
-}
+        if (parts.empty())
+            parts.push_back(objectName);
 
+        for (size_t i = 0; i < parts.size(); ++i) {
+            // the solids are prepped during rt_gettree()
+            BeginTreeAccess(parts[i].c_str());
 
-void ConstDatabase::Select
-(
-    const char* objectName
-) {
-    if (m_rtip != nullptr) {
-        if (!BU_SETJUMP)
-            rt_gettree(m_rtip, objectName);
+            if (!BU_SETJUMP)
+                rt_gettree(m_rtip, parts[i].c_str());
 
-        BU_UNSETJUMP;
+            BU_UNSETJUMP;
+
+            EndTreeAccess(parts[i].c_str());
+        }
     }
 }
 
@@ -824,7 +4899,61 @@ public:
 };
 
 
+bool ConstDatabase::KeptContent
+(
+    const directory* UNUSED(pDir),
+    const void*&     UNUSED(data),
+    size_t&          UNUSED(size)
+) const {
+    return false;
+}
+
+
+bool ConstDatabase::KeepsContent(void) const {
+    return false;
+}
+
+
+void ConstDatabase::CompleteInternal
+(
+    const directory* UNUSED(pDir),
+    const double*    UNUSED(matrix),
+    rt_db_internal&  UNUSED(intern)
+) const {}
+
+
+void ConstDatabase::BeginTreeAccess
+(
+    const char* UNUSED(objectName)
+) {}
+
+
+void ConstDatabase::EndTreeAccess
+(
+    const char* UNUSED(objectName)
+) {}
+
+
+std::function<void(const directory*, const double*, rt_db_internal&)> ConstDatabase::Completion(void) const {
+    return [this](const directory* pDir, const double* matrix, rt_db_internal& intern) {
+        CompleteInternal(pDir, matrix, intern);
+    };
+}
+
+
 void ConstDatabase::RegisterCoreCallbacks(void) {
+    // a new database may be associated with the handle
+    if (m_facetizationCache != nullptr)
+        m_facetizationCache->ForgetTrees();
+
+    if (m_plotCache != nullptr)
+        m_plotCache->Clear();
+
+    if (m_boundingBoxCache != nullptr)
+        m_boundingBoxCache->Clear();
+    else
+        m_boundingBoxCache = new BoundingBoxCache;
+
     if (m_rtip != nullptr) {
         db_add_changed_clbk(m_rtip->rti_dbip, CallBackHooks::DatabaseChanged, this);
         db_add_update_nref_clbk(m_rtip->rti_dbip, CallBackHooks::ReferencesChanged, this);
@@ -849,6 +4978,9 @@ void ConstDatabase::GetInternal
         rt_db_internal intern;
         int            id = rt_db_get_internal(&intern, pDir, m_rtip->rti_dbip, nullptr);
 
+        if (id >= 0)
+            CompleteInternal(pDir, nullptr, intern);
+
         try {
             switch(id) {
             case ID_TOR: // 1
@@ -936,7 +5068,7 @@ void ConstDatabase::SignalDatabaseChange
     directory* pDir,
     int        mode
 ) const {
-    if ((m_rtip != nullptr) && (m_rtip->rti_dbip == dbip)) {
+    if ((m_rtip != nullptr) && (m_rtip->rti_dbip == dbip) && !m_selfModification) {
         ChangeType changeType;
 
         switch (mode) {
@@ -973,6 +5105,15 @@ void ConstDatabase::SignalChange
     const char* objectName,
     ChangeType  changeType
 ) const {
+    if (m_facetizationCache != nullptr)
+        m_facetizationCache->Invalidate(objectName, changeType);
+
+    if (m_plotCache != nullptr)
+        m_plotCache->Invalidate(objectName, changeType);
+
+    if (m_boundingBoxCache != nullptr)
+        m_boundingBoxCache->Invalidate(objectName, changeType);
+
     if (m_changeSignalHandlers != nullptr) {
         for (size_t i = 0; m_changeSignalHandlers[i] != nullptr; ++i)
             (*m_changeSignalHandlers[i])(objectName, changeType);
@@ -0,0 +1,746 @@
+/*                      M A P P E D B A G O F T R I A N G L E S . C P P
+ * BRL-CAD
+ *
+ * Copyright (c) 2026 United States Government as represented by
+ * the U.S. Army Research Laboratory.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this file; see the file named COPYING for more
+ * information.
+ */
+/** @file MappedBagOfTriangles.cpp
+ *
+ *  BRL-CAD core C++ interface:
+ *      read-only, out-of-core view on a bag of triangles (ID_BOT) database object implementation
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <algorithm>
+#include <queue>
+#include <functional>
+
+#include "raytrace.h"
+#include "bu/cv.h"
+
+#include <brlcad/Database/MappedBagOfTriangles.h>
+
+
+using namespace BRLCAD;
+
+
+static const size_t VerticesPerPage = 8192;
+static const size_t FacesPerPage    = 16384;
+
+// the fixed part of the db5 bot body: num_vertices, num_faces, orientation, mode, bot_flags
+static const size_t BodyHeaderSize  = 4 + 4 + 1 + 1 + 1;
+
+
+static size_t DecodeUnsigned
+(
+    const unsigned char* cp,
+    size_t               size
+) {
+    size_t ret = 0;
+
+    for (size_t i = 0; i < size; ++i)
+        ret = (ret << 8) | cp[i];
+
+    return ret;
+}
+
+
+class MappedBagOfTriangles::Pages {
+public:
+    Pages(void) : m_file(nullptr), m_objectAddress(0), m_memory(nullptr), m_bodyOffset(0),
+                  m_numberOfVertices(0), m_numberOfFaces(0), m_mode(RT_BOT_SURFACE), m_orientation(RT_BOT_UNORIENTED),
+                  m_readFailed(false), m_workingSetSize(0), m_cachedBytes(0), m_haveBoxes(false) {}
+
+    ~Pages(void) {
+        if (m_file != nullptr)
+            fclose(m_file);
+    }
+
+    /// reads \a size bytes at \a offset of the database object
+    bool Read
+    (
+        size_t         offset,
+        size_t         size,
+        unsigned char* buffer
+    ) {
+        bool ret = false;
+
+        if (m_memory != nullptr) {
+            memcpy(buffer, m_memory + offset, size);
+            ret = true;
+        }
+        else if (m_file != nullptr) {
+            std::lock_guard<std::mutex> lock(m_fileMutex);
+
+            if (bu_fseek(m_file, static_cast<b_off_t>(m_objectAddress + offset), SEEK_SET) == 0)
+                ret = (fread(buffer, 1, size, m_file) == size);
+        }
+
+        if (!ret)
+            m_readFailed = true;
+
+        return ret;
+    }
+
+    /// parses the db5 object header and the fixed part of the body
+    bool Open
+    (
+        db_i*      dbip,
+        directory* pDir
+    ) {
+        if ((pDir->d_major_type != DB5_MAJORTYPE_BRLCAD) || (pDir->d_minor_type != ID_BOT))
+            return false;
+
+        if (pDir->d_flags & RT_DIR_INMEM)
+            m_memory = static_cast<const unsigned char*>(pDir->d_un.ptr);
+        else if (dbip->dbi_filename != nullptr) {
+            m_file          = fopen(dbip->dbi_filename, "rb");
+            m_objectAddress = pDir->d_addr;
+        }
+
+        unsigned char header[sizeof(db5_ondisk_header) + 8];
+
+        if (!Read(0, sizeof(db5_ondisk_header), header) || (header[0] != DB5HDR_MAGIC1))
+            return false;
+
+        unsigned char hFlags = header[1];
+        unsigned char aFlags = header[2];
+        unsigned char bFlags = header[3];
+        size_t        offset = sizeof(db5_ondisk_header) + (size_t(1) << ((hFlags & DB5HDR_HFLAGS_OBJECT_WIDTH_MASK) >> DB5HDR_HFLAGS_OBJECT_WIDTH_SHIFT));
+
+        // skip the name and the attributes
+        if (hFlags & DB5HDR_HFLAGS_NAME_PRESENT) {
+            size_t width = size_t(1) << ((hFlags & DB5HDR_HFLAGS_NAME_WIDTH_MASK) >> DB5HDR_HFLAGS_NAME_WIDTH_SHIFT);
+
+            if (!Read(offset, width, header))
+                return false;
+
+            offset += width + DecodeUnsigned(header, width);
+        }
+
+        if (aFlags & DB5HDR_AFLAGS_PRESENT) {
+            size_t width = size_t(1) << ((aFlags & DB5HDR_AFLAGS_WIDTH_MASK) >> DB5HDR_AFLAGS_WIDTH_SHIFT);
+
+            if (!Read(offset, width, header))
+                return false;
+
+            offset += width + DecodeUnsigned(header, width);
+        }
+
+        // a compressed body can't be accessed page-wise
+        if (!(bFlags & DB5HDR_BFLAGS_PRESENT) || ((bFlags & DB5HDR_BFLAGS_ZZZ_MASK) != DB5_ZZZ_UNCOMPRESSED))
+            return false;
+
+        size_t width = size_t(1) << ((bFlags & DB5HDR_BFLAGS_WIDTH_MASK) >> DB5HDR_BFLAGS_WIDTH_SHIFT);
+
+        if (!Read(offset, width, header))
+            return false;
+
+        size_t bodyLength = DecodeUnsigned(header, width);
+
+        m_bodyOffset = offset + width;
+
+        unsigned char bodyHeader[BodyHeaderSize];
+
+        if ((bodyLength < BodyHeaderSize) || !Read(m_bodyOffset, BodyHeaderSize, bodyHeader))
+            return false;
+
+        m_numberOfVertices = DecodeUnsigned(bodyHeader, 4);
+        m_numberOfFaces    = DecodeUnsigned(bodyHeader + 4, 4);
+        m_orientation      = bodyHeader[8];
+        m_mode             = bodyHeader[9];
+
+        return bodyLength >= BodyHeaderSize + m_numberOfVertices * 3 * SIZEOF_NETWORK_DOUBLE + m_numberOfFaces * 3 * 4;
+    }
+
+    /// \return nullptr if the page can't be read, such a page isn't cached
+    std::shared_ptr<const std::vector<double> > VertexPage
+    (
+        size_t page
+    ) {
+        std::shared_ptr<const std::vector<double> > ret;
+        size_t                                      key = 2 * page;
+
+        if (!Lookup(key, &ret, nullptr)) {
+            size_t                                first    = page * VerticesPerPage;
+            size_t                                count    = std::min(VerticesPerPage, m_numberOfVertices - first);
+            std::vector<unsigned char>            buffer(3 * count * SIZEOF_NETWORK_DOUBLE);
+            std::shared_ptr<std::vector<double> > vertices = std::make_shared<std::vector<double> >(3 * count);
+
+            if (Read(m_bodyOffset + BodyHeaderSize + 3 * first * SIZEOF_NETWORK_DOUBLE, buffer.size(), buffer.data())) {
+                bu_cv_ntohd(reinterpret_cast<unsigned char*>(vertices->data()), buffer.data(), 3 * count);
+
+                ret = vertices;
+                Insert(key, ret, nullptr, vertices->size() * sizeof(double));
+            }
+        }
+
+        return ret;
+    }
+
+    /// \return nullptr if the page can't be read, such a page isn't cached
+    std::shared_ptr<const std::vector<uint32_t> > FacePage
+    (
+        size_t page
+    ) {
+        std::shared_ptr<const std::vector<uint32_t> > ret;
+        size_t                                        key = 2 * page + 1;
+
+        if (!Lookup(key, nullptr, &ret)) {
+            size_t                                  first       = page * FacesPerPage;
+            size_t                                  count       = std::min(FacesPerPage, m_numberOfFaces - first);
+            std::vector<unsigned char>              buffer(3 * count * 4);
+            std::shared_ptr<std::vector<uint32_t> > faces       = std::make_shared<std::vector<uint32_t> >(3 * count, 0);
+            size_t                                  facesOffset = m_bodyOffset + BodyHeaderSize + 3 * m_numberOfVertices * SIZEOF_NETWORK_DOUBLE;
+
+            if (Read(facesOffset + 3 * first * 4, buffer.size(), buffer.data())) {
+                for (size_t i = 0; i < 3 * count; ++i)
+                    (*faces)[i] = static_cast<uint32_t>(DecodeUnsigned(buffer.data() + 4 * i, 4));
+
+                ret = faces;
+                Insert(key, nullptr, ret, faces->size() * sizeof(uint32_t));
+            }
+        }
+
+        return ret;
+    }
+
+    /// the bounding boxes of the face pages, computed on the first call
+    /** \return nullptr if a page can't be read, the computation will be repeated on the next call then */
+    const std::vector<double>* Boxes(void) {
+        std::lock_guard<std::mutex> lock(m_boxesMutex);
+
+        if (!m_haveBoxes) {
+            size_t pages = (m_numberOfFaces + FacesPerPage - 1) / FacesPerPage;
+            bool   valid = true;
+
+            m_boxes.resize(6 * pages);
+
+            for (size_t page = 0; (page < pages) && valid; ++page) {
+                std::shared_ptr<const std::vector<uint32_t> > faces = FacePage(page);
+                std::shared_ptr<const std::vector<double> >   vertices;
+                size_t                                        vertexPage = 0;
+                double*                                       box        = m_boxes.data() + 6 * page;
+
+                VSETALL(box, INFINITY);
+                VSETALL(box + 3, -INFINITY);
+
+                if (faces == nullptr) {
+                    valid = false;
+                    break;
+                }
+
+                for (size_t i = 0; (i < faces->size()) && valid; ++i) {
+                    size_t vertex = (*faces)[i];
+
+                    if (vertex >= m_numberOfVertices)
+                        continue;
+
+                    if ((vertices == nullptr) || (vertexPage != vertex / VerticesPerPage)) {
+                        vertexPage = vertex / VerticesPerPage;
+                        vertices   = VertexPage(vertexPage);
+                    }
+
+                    if (vertices == nullptr)
+                        valid = false;
+                    else
+                        VMINMAX(box, box + 3, vertices->data() + 3 * (vertex % VerticesPerPage));
+                }
+            }
+
+            m_haveBoxes = valid;
+        }
+
+        return m_haveBoxes ? &m_boxes : nullptr;
+    }
+
+    size_t WorkingSetSize(void) const {
+        return m_workingSetSize;
+    }
+
+    void SetWorkingSetSize
+    (
+        size_t workingSetSize
+    ) {
+        std::lock_guard<std::mutex> lock(m_cacheMutex);
+
+        m_workingSetSize = workingSetSize;
+        Evict();
+    }
+
+    FILE*                m_file;
+    size_t               m_objectAddress;
+    const unsigned char* m_memory;
+    size_t               m_bodyOffset;
+    size_t               m_numberOfVertices;
+    size_t               m_numberOfFaces;
+    unsigned char        m_mode;
+    unsigned char        m_orientation;
+    std::atomic<bool>    m_readFailed;
+
+private:
+    struct CacheEntry {
+        std::shared_ptr<const std::vector<double> >   vertices;
+        std::shared_ptr<const std::vector<uint32_t> > faces;
+        size_t                                        bytes;
+        std::list<size_t>::iterator                   position;
+    };
+
+    std::mutex                             m_fileMutex;
+    std::mutex                             m_cacheMutex;
+    std::mutex                             m_boxesMutex;
+    size_t                                 m_workingSetSize;
+    size_t                                 m_cachedBytes;
+    std::unordered_map<size_t, CacheEntry> m_cache;
+    std::list<size_t>                      m_recentlyUsed;
+    bool                                   m_haveBoxes;
+    std::vector<double>                    m_boxes;
+
+    bool Lookup
+    (
+        size_t                                         key,
+        std::shared_ptr<const std::vector<double> >*   vertices,
+        std::shared_ptr<const std::vector<uint32_t> >* faces
+    ) {
+        std::lock_guard<std::mutex> lock(m_cacheMutex);
+        auto                        entry = m_cache.find(key);
+        bool                        ret   = (entry != m_cache.end());
+
+        if (ret) {
+            m_recentlyUsed.splice(m_recentlyUsed.begin(), m_recentlyUsed, entry->second.position);
+
+            if (vertices != nullptr)
+                *vertices = entry->second.vertices;
+
+            if (faces != nullptr)
+                *faces = entry->second.faces;
+        }
+
+        return ret;
+    }
+
+    void Insert
+    (
+        size_t                                        key,
+        std::shared_ptr<const std::vector<double> >   vertices,
+        std::shared_ptr<const std::vector<uint32_t> > faces,
+        size_t                                        bytes
+    ) {
+        std::lock_guard<std::mutex> lock(m_cacheMutex);
+
+        // another thread may have been faster
+        if (m_cache.find(key) == m_cache.end()) {
+            CacheEntry& entry = m_cache[key];
+
+            m_recentlyUsed.push_front(key);
+            entry.vertices = vertices;
+            entry.faces    = faces;
+            entry.bytes    = bytes;
+            entry.position = m_recentlyUsed.begin();
+            m_cachedBytes += bytes;
+
+            Evict();
+        }
+    }
+
+    /// drops the least recently used pages, pages in use stay alive until they are released by their user
+    void Evict(void) {
+        while ((m_cachedBytes > m_workingSetSize) && (m_recentlyUsed.size() > 1)) {
+            auto entry = m_cache.find(m_recentlyUsed.back());
+
+            m_cachedBytes -= entry->second.bytes;
+            m_recentlyUsed.pop_back();
+            m_cache.erase(entry);
+        }
+    }
+};
+
+
+MappedBagOfTriangles::~MappedBagOfTriangles(void) {
+    delete m_pages;
+}
+
+
+void MappedBagOfTriangles::Destroy(void) {
+    delete this;
+}
+
+
+size_t MappedBagOfTriangles::Face::VertexIndex
+(
+    size_t index
+) const {
+    assert(m_bot != nullptr);
+    assert(index < 3);
+
+    size_t ret = 0;
+
+    if ((m_bot != nullptr) && (index < 3)) {
+        std::shared_ptr<const std::vector<uint32_t> > faces = m_bot->m_pages->FacePage(m_faceIndex / FacesPerPage);
+
+        if (faces != nullptr)
+            ret = (*faces)[3 * (m_faceIndex % FacesPerPage) + index];
+        else
+            ret = m_bot->m_pages->m_numberOfVertices;
+    }
+
+    return ret;
+}
+
+
+Vector3D MappedBagOfTriangles::Face::Point
+(
+    size_t index
+) const {
+    Vector3D ret;
+
+    if (m_bot != nullptr)
+        ret = m_bot->Vertex(VertexIndex(index));
+
+    return ret;
+}
+
+
+BagOfTriangles::BotMode MappedBagOfTriangles::Mode(void) const {
+    BagOfTriangles::BotMode ret = BagOfTriangles::BotMode::Surface;
+
+    switch (m_pages->m_mode) {
+        case RT_BOT_SOLID:
+            ret = BagOfTriangles::BotMode::Solid;
+            break;
+
+        case RT_BOT_PLATE:
+            ret = BagOfTriangles::BotMode::Plate;
+            break;
+
+        case RT_BOT_PLATE_NOCOS:
+            ret = BagOfTriangles::BotMode::EqualLineOfSightPlate;
+    }
+
+    return ret;
+}
+
+
+BagOfTriangles::BotOrientation MappedBagOfTriangles::Orientation(void) const {
+    BagOfTriangles::BotOrientation ret = BagOfTriangles::BotOrientation::Unoriented;
+
+    switch (m_pages->m_orientation) {
+        case RT_BOT_CW:
+            ret = BagOfTriangles::BotOrientation::ClockWise;
+            break;
+
+        case RT_BOT_CCW:
+            ret = BagOfTriangles::BotOrientation::CounterClockWise;
+    }
+
+    return ret;
+}
+
+
+size_t MappedBagOfTriangles::NumberOfVertices(void) const {
+    return m_pages->m_numberOfVertices;
+}
+
+
+size_t MappedBagOfTriangles::NumberOfFaces(void) const {
+    return m_pages->m_numberOfFaces;
+}
+
+
+MappedBagOfTriangles::Face MappedBagOfTriangles::GetFace
+(
+    size_t index
+) const {
+    assert(index < m_pages->m_numberOfFaces);
+
+    Face ret;
+
+    if (index < m_pages->m_numberOfFaces)
+        ret = Face(this, index);
+
+    return ret;
+}
+
+
+Vector3D MappedBagOfTriangles::Vertex
+(
+    size_t index
+) const {
+    assert(index < m_pages->m_numberOfVertices);
+
+    Vector3D ret;
+
+    if (index < m_pages->m_numberOfVertices) {
+        std::shared_ptr<const std::vector<double> > vertices = m_pages->VertexPage(index / VerticesPerPage);
+
+        if (vertices != nullptr)
+            ret = Vector3D(vertices->data() + 3 * (index % VerticesPerPage));
+    }
+
+    return ret;
+}
+
+
+size_t MappedBagOfTriangles::GetVertices
+(
+    size_t  firstVertex,
+    size_t  count,
+    double* coordinates
+) const {
+    size_t ret = 0;
+
+    if (firstVertex < m_pages->m_numberOfVertices) {
+        size_t last = firstVertex + std::min(count, m_pages->m_numberOfVertices - firstVertex);
+
+        for (size_t vertex = firstVertex; vertex < last;) {
+            std::shared_ptr<const std::vector<double> > vertices = m_pages->VertexPage(vertex / VerticesPerPage);
+
+            if (vertices == nullptr)
+                break;
+
+            size_t begin = vertex % VerticesPerPage;
+            size_t end   = std::min(vertices->size() / 3, begin + last - vertex);
+
+            memcpy(coordinates + 3 * (vertex - firstVertex), vertices->data() + 3 * begin, 3 * (end - begin) * sizeof(double));
+            vertex += end - begin;
+            ret    += end - begin;
+        }
+    }
+
+    return ret;
+}
+
+
+size_t MappedBagOfTriangles::GetFaces
+(
+    size_t  firstFace,
+    size_t  count,
+    size_t* vertexIndices
+) const {
+    size_t ret = 0;
+
+    if (firstFace < m_pages->m_numberOfFaces) {
+        size_t last = firstFace + std::min(count, m_pages->m_numberOfFaces - firstFace);
+
+        for (size_t face = firstFace; face < last;) {
+            std::shared_ptr<const std::vector<uint32_t> > faces = m_pages->FacePage(face / FacesPerPage);
+
+            if (faces == nullptr)
+                break;
+
+            size_t begin = face % FacesPerPage;
+            size_t end   = std::min(faces->size() / 3, begin + last - face);
+
+            std::copy(faces->begin() + 3 * begin, faces->begin() + 3 * end, vertexIndices + 3 * (face - firstFace));
+            face += end - begin;
+            ret  += end - begin;
+        }
+    }
+
+    return ret;
+}
+
+
+bool MappedBagOfTriangles::ShootRay
+(
+    const Ray3D&                                                   ray,
+    const std::function<bool(size_t faceIndex, double distance)>& callback
+) const {
+    const std::vector<double>* boxes = m_pages->Boxes();
+
+    if (boxes == nullptr)
+        return false;
+
+    bool                                    ret       = true;
+    const double*                           origin    = ray.origin.coordinates;
+    const double*                           direction = ray.direction.coordinates;
+    std::vector<std::pair<double, size_t> > pages; // the entry distance of the ray into the box of a page
+
+    for (size_t page = 0; page < boxes->size() / 6; ++page) {
+        // slab test
+        const double* box   = boxes->data() + 6 * page;
+        double        entry = -INFINITY;
+        double        exit  = INFINITY;
+
+        for (size_t i = 0; (i < 3) && (entry <= exit); ++i) {
+            if (fabs(direction[i]) < SMALL_FASTF) {
+                if ((origin[i] < box[i]) || (origin[i] > box[3 + i]))
+                    exit = -INFINITY;
+            }
+            else {
+                double distance1 = (box[i] - origin[i]) / direction[i];
+                double distance2 = (box[3 + i] - origin[i]) / direction[i];
+
+                entry = std::max(entry, std::min(distance1, distance2));
+                exit  = std::min(exit, std::max(distance1, distance2));
+            }
+        }
+
+        if ((entry <= exit) && (exit >= 0.))
+            pages.push_back(std::make_pair(std::max(entry, 0.), page));
+    }
+
+    // the pages are intersected in the order of their entry distance
+    // a hit can be handed over as soon as it is closer than the entry into the next page
+    std::sort(pages.begin(), pages.end());
+
+    std::priority_queue<std::pair<double, size_t>,
+                        std::vector<std::pair<double, size_t> >,
+                        std::greater<std::pair<double, size_t> > > hits;
+    std::shared_ptr<const std::vector<double> >                     vertices;
+    size_t                                                          vertexPage = 0;
+    bool                                                            proceed    = true;
+
+    for (size_t i = 0; (i <= pages.size()) && proceed && ret; ++i) {
+        double nextEntry = (i < pages.size()) ? pages[i].first : INFINITY;
+
+        while (!hits.empty() && (hits.top().first <= nextEntry) && proceed) {
+            proceed = callback(hits.top().second, hits.top().first);
+            hits.pop();
+        }
+
+        if ((i == pages.size()) || !proceed)
+            break;
+
+        size_t                                        page  = pages[i].second;
+        std::shared_ptr<const std::vector<uint32_t> > faces = m_pages->FacePage(page);
+
+        if (faces == nullptr) {
+            ret = false;
+            break;
+        }
+
+        for (size_t face = 0; (face < faces->size() / 3) && ret; ++face) {
+            point_t points[3];
+            bool    valid = true;
+
+            for (size_t corner = 0; (corner < 3) && valid; ++corner) {
+                size_t vertex = (*faces)[3 * face + corner];
+
+                if (vertex >= m_pages->m_numberOfVertices)
+                    valid = false;
+                else {
+                    if ((vertices == nullptr) || (vertexPage != vertex / VerticesPerPage)) {
+                        vertexPage = vertex / VerticesPerPage;
+                        vertices   = m_pages->VertexPage(vertexPage);
+                    }
+
+                    if (vertices == nullptr) {
+                        valid = false;
+                        ret   = false;
+                    }
+                    else
+                        VMOVE(points[corner], vertices->data() + 3 * (vertex % VerticesPerPage));
+                }
+            }
+
+            if (!valid)
+                continue;
+
+            // Moeller-Trumbore
+            vect_t edge1;
+            vect_t edge2;
+            vect_t p;
+
+            VSUB2(edge1, points[1], points[0]);
+            VSUB2(edge2, points[2], points[0]);
+            VCROSS(p, direction, edge2);
+
+            double determinant = VDOT(edge1, p);
+
+            if (fabs(determinant) < SMALL_FASTF)
+                continue;
+
+            vect_t toOrigin;
+            vect_t q;
+
+            VSUB2(toOrigin, origin, points[0]);
+
+            double u = VDOT(toOrigin, p) / determinant;
+
+            if ((u < 0.) || (u > 1.))
+                continue;
+
+            VCROSS(q, toOrigin, edge1);
+
+            double v = VDOT(direction, q) / determinant;
+
+            if ((v < 0.) || (u + v > 1.))
+                continue;
+
+            double distance = VDOT(edge2, q) / determinant;
+
+            if (distance >= 0.)
+                hits.push(std::make_pair(distance, page * FacesPerPage + face));
+        }
+    }
+
+    return ret;
+}
+
+
+bool MappedBagOfTriangles::ReadFailed(void) const {
+    return m_pages->m_readFailed;
+}
+
+
+size_t MappedBagOfTriangles::WorkingSetSize(void) const {
+    return m_pages->WorkingSetSize();
+}
+
+
+void MappedBagOfTriangles::SetWorkingSetSize
+(
+    size_t workingSetSize
+) {
+    m_pages->SetWorkingSetSize(workingSetSize);
+}
+
+
+MappedBagOfTriangles::MappedBagOfTriangles
+(
+    Pages* pages
+) : m_pages(pages) {}
+
+
+MappedBagOfTriangles* MappedBagOfTriangles::Create
+(
+    db_i*      dbip,
+    directory* pDir,
+    size_t     workingSetSize
+) {
+    MappedBagOfTriangles* ret   = nullptr;
+    Pages*                pages = new Pages;
+
+    if (pages->Open(dbip, pDir)) {
+        pages->SetWorkingSetSize(workingSetSize);
+        ret = new MappedBagOfTriangles(pages);
+    }
+    else
+        delete pages;
+
+    return ret;
+}
@@ -24,9 +24,19 @@
  */
 
 #include <cassert>
+#include <cstring>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
 
 #include "raytrace.h"
 #include "bu/parallel.h"
+#include "rt/geom.h"
+
+#include "private.h"
 
 #include <brlcad/Database/MemoryDatabase.h>
 
@@ -34,9 +44,554 @@
 using namespace BRLCAD;
 
 
-MemoryDatabase::MemoryDatabase(void) : Database() {
+static void PutVarint
+(
+    std::vector<unsigned char>& data,
+    uint64_t                    value
+) {
+    while (value >= 0x80) {
+        data.push_back(static_cast<unsigned char>(value | 0x80));
+        value >>= 7;
+    }
+
+    data.push_back(static_cast<unsigned char>(value));
+}
+
+
+static uint64_t GetVarint
+(
+    const unsigned char*& cp
+) {
+    uint64_t ret   = 0;
+    int      shift = 0;
+
+    while (*cp & 0x80) {
+        ret   |= static_cast<uint64_t>(*cp++ & 0x7f) << shift;
+        shift += 7;
+    }
+
+    ret |= static_cast<uint64_t>(*cp++) << shift;
+
+    return ret;
+}
+
+
+/// delta coded index stream, the differences are zigzag and variable-length encoded
+static void PutIndices
+(
+    std::vector<unsigned char>& data,
+    const int*                  indices,
+    size_t                      count
+) {
+    int64_t previous = 0;
+
+    for (size_t i = 0; i < count; ++i) {
+        int64_t delta = static_cast<int64_t>(indices[i]) - previous;
+
+        PutVarint(data, (static_cast<uint64_t>(delta) << 1) ^ static_cast<uint64_t>(delta >> 63));
+        previous = indices[i];
+    }
+}
+
+
+static void GetIndices
+(
+    const unsigned char*& cp,
+    int*                  indices,
+    size_t                count
+) {
+    int64_t previous = 0;
+
+    for (size_t i = 0; i < count; ++i) {
+        uint64_t zigzag = GetVarint(cp);
+
+        previous  += static_cast<int64_t>(zigzag >> 1) ^ -static_cast<int64_t>(zigzag & 1);
+        indices[i] = static_cast<int>(previous);
+    }
+}
+
+
+template<typename T>
+static void PutRaw
+(
+    std::vector<unsigned char>& data,
+    const T*                    values,
+    size_t                      count
+) {
+    const unsigned char* cp = reinterpret_cast<const unsigned char*>(values);
+
+    data.insert(data.end(), cp, cp + count * sizeof(T));
+}
+
+
+template<typename T>
+static void GetRaw
+(
+    const unsigned char*& cp,
+    T*                    values,
+    size_t                count
+) {
+    memcpy(values, cp, count * sizeof(T));
+    cp += count * sizeof(T);
+}
+
+
+/// the vertices of a bag of triangles quantized in their bounding box with a maximal deviation of \a maxError per coordinate
+static void EncodeVertices
+(
+    const rt_bot_internal&      bot,
+    double                      maxError,
+    std::vector<unsigned char>& data
+) {
+    double minimum[3] = {0., 0., 0.};
+    double step[3]    = {0., 0., 0.};
+    int    bits[3]    = {0, 0, 0};
+
+    if (bot.num_vertices > 0) {
+        double maximum[3];
+
+        VMOVE(minimum, bot.vertices);
+        VMOVE(maximum, bot.vertices);
+
+        for (size_t i = 1; i < bot.num_vertices; ++i)
+            VMINMAX(minimum, maximum, bot.vertices + 3 * i);
+
+        for (size_t i = 0; i < 3; ++i) {
+            double extent = maximum[i] - minimum[i];
+
+            if (extent > 0.) {
+                // the rounding error is at most half a step
+                bits[i] = std::max(1, std::min(32, static_cast<int>(ceil(log2(extent / (2. * maxError) + 1.)))));
+                step[i] = extent / static_cast<double>((uint64_t(1) << bits[i]) - 1);
+            }
+        }
+    }
+
+    PutRaw(data, minimum, 3);
+    PutRaw(data, step, 3);
+
+    for (size_t i = 0; i < 3; ++i)
+        data.push_back(static_cast<unsigned char>(bits[i]));
+
+    // bit packed vertices
+    uint64_t buffer     = 0;
+    int      bufferBits = 0;
+
+    for (size_t i = 0; i < 3 * bot.num_vertices; ++i) {
+        size_t axis = i % 3;
+
+        if (bits[axis] == 0)
+            continue;
+
+        uint64_t value = static_cast<uint64_t>(floor((bot.vertices[i] - minimum[axis]) / step[axis] + 0.5));
+
+        value       = std::min(value, (uint64_t(1) << bits[axis]) - 1);
+        buffer     |= value << bufferBits;
+        bufferBits += bits[axis];
+
+        while (bufferBits >= 8) {
+            data.push_back(static_cast<unsigned char>(buffer));
+            buffer     >>= 8;
+            bufferBits  -= 8;
+        }
+    }
+
+    if (bufferBits > 0)
+        data.push_back(static_cast<unsigned char>(buffer));
+}
+
+
+/// flags of the byte which follows the counts in the encoded geometry
+enum EncodedParts {
+    EncodedThickness = 1,
+    EncodedFaceMode  = 2,
+    EncodedLossless  = 4  ///< the vertices and normals are stored verbatim
+};
+
+
+/// the geometry of a bag of triangles: the vertices quantized in their bounding box, the normals with 16 bit per coordinate
+/** If \a maxError isn't positive the vertices and normals are stored verbatim. */
+static void EncodeBot
+(
+    const rt_bot_internal&      bot,
+    double                      maxError,
+    std::vector<unsigned char>& data
+) {
+    const bool lossless = !(maxError > 0.);
+
+    data.clear();
+
+    PutVarint(data, bot.num_vertices);
+    PutVarint(data, bot.num_faces);
+    PutVarint(data, (bot.normals != nullptr) ? bot.num_normals : 0);
+    PutVarint(data, (bot.face_normals != nullptr) ? bot.num_face_normals : 0);
+    data.push_back(static_cast<unsigned char>(((bot.thickness != nullptr) ? EncodedThickness : 0) |
+                                              ((bot.face_mode != nullptr) ? EncodedFaceMode : 0) |
+                                              (lossless ? EncodedLossless : 0)));
+
+    if (lossless)
+        PutRaw(data, bot.vertices, 3 * bot.num_vertices);
+    else
+        EncodeVertices(bot, maxError, data);
+
+    PutIndices(data, bot.faces, 3 * bot.num_faces);
+
+    if (bot.normals != nullptr) {
+        if (lossless)
+            PutRaw(data, bot.normals, 3 * bot.num_normals);
+        else {
+            for (size_t i = 0; i < 3 * bot.num_normals; ++i) {
+                int16_t value = static_cast<int16_t>(floor(std::max(-1., std::min(1., bot.normals[i])) * 32767. + 0.5));
+
+                PutRaw(data, &value, 1);
+            }
+        }
+    }
+
+    if (bot.face_normals != nullptr)
+        PutIndices(data, bot.face_normals, 3 * bot.num_face_normals);
+
+    if (bot.thickness != nullptr)
+        PutRaw(data, bot.thickness, bot.num_faces);
+
+    if (bot.face_mode != nullptr) {
+        for (size_t i = 0; i < bot.num_faces; i += 8) {
+            unsigned char byte = 0;
+
+            for (size_t j = i; (j < i + 8) && (j < bot.num_faces); ++j) {
+                if (BU_BITTEST(bot.face_mode, j))
+                    byte |= static_cast<unsigned char>(1 << (j - i));
+            }
+
+            data.push_back(byte);
+        }
+    }
+}
+
+
+/// the counterpart of EncodeVertices()
+static void DecodeVertices
+(
+    const unsigned char*& cp,
+    fastf_t*              vertices,
+    size_t                numberOfVertices
+) {
+    double minimum[3];
+    double step[3];
+    int    bits[3];
+
+    GetRaw(cp, minimum, 3);
+    GetRaw(cp, step, 3);
+
+    for (size_t i = 0; i < 3; ++i)
+        bits[i] = *cp++;
+
+    uint64_t buffer     = 0;
+    int      bufferBits = 0;
+
+    for (size_t i = 0; i < 3 * numberOfVertices; ++i) {
+        size_t axis = i % 3;
+
+        while (bufferBits < bits[axis]) {
+            buffer     |= static_cast<uint64_t>(*cp++) << bufferBits;
+            bufferBits += 8;
+        }
+
+        uint64_t value = (bits[axis] > 0) ? (buffer & ((uint64_t(1) << bits[axis]) - 1)) : 0;
+
+        buffer      = (bits[axis] > 0) ? (buffer >> bits[axis]) : buffer;
+        bufferBits -= bits[axis];
+        vertices[i] = minimum[axis] + static_cast<double>(value) * step[axis];
+    }
+}
+
+
+/// restores the arrays of \a bot, which must not have any
+static void DecodeBot
+(
+    const std::vector<unsigned char>& data,
+    rt_bot_internal&                  bot
+) {
+    const unsigned char* cp = data.data();
+
+    bot.num_vertices     = GetVarint(cp);
+    bot.num_faces        = GetVarint(cp);
+    bot.num_normals      = GetVarint(cp);
+    bot.num_face_normals = GetVarint(cp);
+
+    unsigned char perFaceData = *cp++;
+
+    bot.vertices = static_cast<fastf_t*>(bu_malloc(std::max(size_t(1), 3 * bot.num_vertices) * sizeof(fastf_t), "MemoryDatabase DecodeBot(): vertices"));
+
+    if (perFaceData & EncodedLossless)
+        GetRaw(cp, bot.vertices, 3 * bot.num_vertices);
+    else
+        DecodeVertices(cp, bot.vertices, bot.num_vertices);
+
+    bot.faces = static_cast<int*>(bu_malloc(std::max(size_t(1), 3 * bot.num_faces) * sizeof(int), "MemoryDatabase DecodeBot(): faces"));
+    GetIndices(cp, bot.faces, 3 * bot.num_faces);
+
+    if (bot.num_normals > 0) {
+        bot.normals = static_cast<fastf_t*>(bu_malloc(3 * bot.num_normals * sizeof(fastf_t), "MemoryDatabase DecodeBot(): normals"));
+
+        if (perFaceData & EncodedLossless)
+            GetRaw(cp, bot.normals, 3 * bot.num_normals);
+        else {
+            for (size_t i = 0; i < 3 * bot.num_normals; ++i) {
+                int16_t value;
+
+                GetRaw(cp, &value, 1);
+                bot.normals[i] = value / 32767.;
+            }
+        }
+    }
+
+    if (bot.num_face_normals > 0) {
+        bot.face_normals = static_cast<int*>(bu_malloc(3 * bot.num_face_normals * sizeof(int), "MemoryDatabase DecodeBot(): face_normals"));
+        GetIndices(cp, bot.face_normals, 3 * bot.num_face_normals);
+    }
+
+    if (perFaceData & EncodedThickness) {
+        bot.thickness = static_cast<fastf_t*>(bu_malloc(std::max(size_t(1), bot.num_faces) * sizeof(fastf_t), "MemoryDatabase DecodeBot(): thickness"));
+        GetRaw(cp, bot.thickness, bot.num_faces);
+    }
+
+    if (perFaceData & EncodedFaceMode) {
+        bot.face_mode = bu_bitv_new(bot.num_faces);
+
+        for (size_t i = 0; i < bot.num_faces; ++i) {
+            if (cp[i / 8] & (1 << (i % 8)))
+                BU_BITSET(bot.face_mode, i);
+            else
+                BU_BITCLR(bot.face_mode, i);
+        }
+    }
+}
+
+
+/// frees the arrays of \a bot, i.e. makes it a placeholder with the properties only
+static void StripBot
+(
+    rt_bot_internal& bot
+) {
+    if (bot.vertices != nullptr)
+        bu_free(bot.vertices, "MemoryDatabase StripBot(): vertices");
+
+    if (bot.faces != nullptr)
+        bu_free(bot.faces, "MemoryDatabase StripBot(): faces");
+
+    if (bot.thickness != nullptr)
+        bu_free(bot.thickness, "MemoryDatabase StripBot(): thickness");
+
+    if (bot.face_mode != nullptr)
+        bu_bitv_free(bot.face_mode);
+
+    if (bot.normals != nullptr)
+        bu_free(bot.normals, "MemoryDatabase StripBot(): normals");
+
+    if (bot.face_normals != nullptr)
+        bu_free(bot.face_normals, "MemoryDatabase StripBot(): face_normals");
+
+    bot.vertices         = nullptr;
+    bot.num_vertices     = 0;
+    bot.faces            = nullptr;
+    bot.num_faces        = 0;
+    bot.thickness        = nullptr;
+    bot.face_mode        = nullptr;
+    bot.normals          = nullptr;
+    bot.num_normals      = 0;
+    bot.face_normals     = nullptr;
+    bot.num_face_normals = 0;
+}
+
+
+class MemoryDatabase::BotStore {
+public:
+    struct Entry {
+        std::vector<unsigned char> geometry;    ///< the encoded arrays
+        std::vector<unsigned char> placeholder; ///< the external form of the object without its arrays
+        double                     maxError;
+        size_t                     accessDepth; ///< > 0 while the object is restored
+        bool                       modified;    ///< the restored object was changed
+
+        Entry(void) : maxError(0.), accessDepth(0), modified(false) {}
+    };
+
+    std::map<std::string, Entry>           entries;
+    std::vector<std::vector<std::string> > accesses;
+    ConstDatabase::ChangeSignalHandler     changeSignalHandler;
+
+    /// replaces the object by a placeholder and keeps its geometry encoded
+    bool Compress
+    (
+        db_i*      dbip,
+        directory* pDir,
+        double     maxError
+    ) {
+        bool           ret = false;
+        rt_db_internal intern;
+
+        if (rt_db_get_internal(&intern, pDir, dbip, nullptr) == ID_BOT) {
+            rt_bot_internal* bot   = static_cast<rt_bot_internal*>(intern.idb_ptr);
+            Entry&           entry = entries[pDir->d_namep];
+
+            RT_BOT_CK_MAGIC(bot);
+
+            EncodeBot(*bot, maxError, entry.geometry);
+            StripBot(*bot);
+
+            entry.maxError    = maxError;
+            entry.accessDepth = 0;
+            entry.modified    = false;
+
+            if (rt_db_put_internal(pDir, dbip, &intern) == 0) {
+                bu_external external;
+
+                BU_EXTERNAL_INIT(&external);
+
+                if (db_get_external(&external, pDir, dbip) == 0) {
+                    entry.placeholder.assign(external.ext_buf, external.ext_buf + external.ext_nbytes);
+                    bu_free_external(&external);
+                    ret = true;
+                }
+            }
+
+            if (!ret)
+                entries.erase(pDir->d_namep);
+        }
+        else
+            rt_db_free_internal(&intern);
+
+        return ret;
+    }
+
+    /// writes the objects with their full geometry to the database, the decoding runs in parallel
+    void Restore
+    (
+        db_i*                           dbip,
+        const std::vector<std::string>& names
+    ) {
+        std::vector<Entry*>          restore;
+        std::vector<rt_bot_internal> arrays;
+
+        for (size_t i = 0; i < names.size(); ++i) {
+            Entry& entry = entries[names[i]];
+
+            if (entry.accessDepth++ == 0)
+                restore.push_back(&entry);
+        }
+
+        arrays.resize(restore.size());
+
+        ParallelFor(restore.size(), 1, [&restore, &arrays](size_t begin, size_t end, size_t) {
+            for (size_t i = begin; i < end; ++i) {
+                memset(&arrays[i], 0, sizeof(rt_bot_internal));
+                DecodeBot(restore[i]->geometry, arrays[i]);
+            }
+        });
+
+        for (size_t i = 0, j = 0; i < names.size(); ++i) {
+            Entry& entry = entries[names[i]];
+
+            if ((j >= restore.size()) || (&entry != restore[j]))
+                continue;
+
+            directory*     pDir = db_lookup(dbip, names[i].c_str(), LOOKUP_QUIET);
+            rt_db_internal intern;
+
+            if ((pDir != RT_DIR_NULL) && (rt_db_get_internal(&intern, pDir, dbip, nullptr) == ID_BOT)) {
+                rt_bot_internal* bot = static_cast<rt_bot_internal*>(intern.idb_ptr);
+
+                RT_BOT_CK_MAGIC(bot);
+                StripBot(*bot);
+
+                bot->num_vertices     = arrays[j].num_vertices;
+                bot->vertices         = arrays[j].vertices;
+                bot->num_faces        = arrays[j].num_faces;
+                bot->faces            = arrays[j].faces;
+                bot->thickness        = arrays[j].thickness;
+                bot->face_mode        = arrays[j].face_mode;
+                bot->num_normals      = arrays[j].num_normals;
+                bot->normals          = arrays[j].normals;
+                bot->num_face_normals = arrays[j].num_face_normals;
+                bot->face_normals     = arrays[j].face_normals;
+
+                rt_db_put_internal(pDir, dbip, &intern);
+            }
+            else {
+                if (pDir != RT_DIR_NULL)
+                    rt_db_free_internal(&intern);
+
+                StripBot(arrays[j]);
+            }
+
+            ++j;
+        }
+    }
+
+    /// puts the placeholders back, or re-encodes the objects which were changed meanwhile
+    void Release
+    (
+        db_i*                           dbip,
+        const std::vector<std::string>& names
+    ) {
+        for (size_t i = 0; i < names.size(); ++i) {
+            auto entry = entries.find(names[i]);
+
+            if ((entry == entries.end()) || (entry->second.accessDepth == 0) || (--entry->second.accessDepth > 0))
+                continue;
+
+            directory* pDir = db_lookup(dbip, names[i].c_str(), LOOKUP_QUIET);
+
+            if (pDir == RT_DIR_NULL)
+                entries.erase(entry);
+            else if (entry->second.modified)
+                Compress(dbip, pDir, entry->second.maxError);
+            else {
+                bu_external external;
+
+                BU_EXTERNAL_INIT(&external);
+                external.ext_buf    = entry->second.placeholder.data();
+                external.ext_nbytes = entry->second.placeholder.size();
+
+                db_put_external(&external, pDir, dbip);
+            }
+        }
+    }
+};
+
+
+static void CollectLeaf
+(
+    db_i*      UNUSED(dbip),
+    directory* pDir,
+    void*      clientData
+) {
+    std::vector<std::string>* names = static_cast<std::vector<std::string>*>(clientData);
+
+    names->push_back(pDir->d_namep);
+}
+
+
+MemoryDatabase::MemoryDatabase(void) : Database(), m_botStore(new BotStore) {
     db_i* dbip = nullptr;
 
+    // tracks the modifications of compressed bags of triangles
+    m_botStore->changeSignalHandler = [this](const char* objectName, ChangeType changeType) {
+        if (objectName != nullptr) {
+            auto entry = m_botStore->entries.find(objectName);
+
+            if (entry != m_botStore->entries.end()) {
+                if ((changeType != ChangeType::Removal) && (entry->second.accessDepth > 0))
+                    entry->second.modified = true;
+                else // removed, or the placeholder was overwritten
+                    m_botStore->entries.erase(entry);
+            }
+        }
+    };
+
+    RegisterChangeSignalHandler(m_botStore->changeSignalHandler);
+
     if (!BU_SETJUMP) {
         dbip = db_create_inmem();
         RT_CK_DBI(dbip);
@@ -73,7 +628,10 @@ MemoryDatabase::MemoryDatabase(void) : Database() {
 }
 
 
-MemoryDatabase::~MemoryDatabase(void) {}
+MemoryDatabase::~MemoryDatabase(void) {
+    DeRegisterChangeSignalHandler(m_botStore->changeSignalHandler);
+    delete m_botStore;
+}
 
 
 bool MemoryDatabase::Load
@@ -100,6 +658,9 @@ bool MemoryDatabase::Load
                 m_rtip = nullptr;
             }
 
+            m_botStore->entries.clear();
+            m_botStore->accesses.clear();
+
             // build new database
             db_i* dbip = db_open_inmem();
             RT_CK_DBI(dbip);
@@ -162,6 +723,9 @@ bool MemoryDatabase::Load
                 m_rtip = nullptr;
             }
 
+            m_botStore->entries.clear();
+            m_botStore->accesses.clear();
+
             // build new database
             db_i* dbip = db_open_inmem();
             RT_CK_DBI(dbip);
@@ -209,12 +773,222 @@ bool MemoryDatabase::Save
         rt_wdb* target = wdb_fopen(fileName);
 
         if (target != nullptr) {
+            // the compressed bags of triangles are written in their full form
+            std::vector<std::string> compressed;
+
+            for (auto entry = m_botStore->entries.begin(); entry != m_botStore->entries.end(); ++entry)
+                compressed.push_back(entry->first);
+
+            m_selfModification = true;
+            m_botStore->Restore(m_wdbp->dbip, compressed);
+
             ret = (db_dump(target, m_wdbp->dbip) == 0);
             wdb_close(target);
+
+            m_botStore->Release(m_wdbp->dbip, compressed);
+            m_selfModification = false;
         }
     }
+    else {
+        BU_UNSETJUMP;
+        m_selfModification = false;
+    }
 
     BU_UNSETJUMP;
 
     return ret;
 }
+
+
+size_t MemoryDatabase::CompressBagsOfTriangles
+(
+    double maxError
+) {
+    size_t ret = 0;
+
+    // m_wdbp and m_rtip share the database instance, further users, e.g. a CommandString, would see the placeholders
+    const int ownUses = 2;
+
+    if ((m_rtip != nullptr) && (m_rtip->rti_dbip->dbi_uses <= ownUses)) {
+        if (!BU_SETJUMP) {
+            std::vector<directory*> bots;
+            directory*              pDir;
+
+            FOR_ALL_DIRECTORY_START(pDir, m_rtip->rti_dbip) {
+                if ((pDir->d_major_type == DB5_MAJORTYPE_BRLCAD) && (pDir->d_minor_type == ID_BOT) &&
+                    (m_botStore->entries.find(pDir->d_namep) == m_botStore->entries.end()))
+                    bots.push_back(pDir);
+            } FOR_ALL_DIRECTORY_END
+
+            m_selfModification = true;
+
+            for (size_t i = 0; i < bots.size(); ++i) {
+                if (m_botStore->Compress(m_rtip->rti_dbip, bots[i], maxError))
+                    ++ret;
+            }
+        }
+        else
+            BU_UNSETJUMP;
+
+        BU_UNSETJUMP;
+
+        m_selfModification = false;
+    }
+
+    return ret;
+}
+
+
+void MemoryDatabase::DecompressBagsOfTriangles(void) {
+    if ((m_rtip != nullptr) && !m_botStore->entries.empty()) {
+        if (!BU_SETJUMP) {
+            std::vector<std::string> compressed;
+
+            for (auto entry = m_botStore->entries.begin(); entry != m_botStore->entries.end(); ++entry)
+                compressed.push_back(entry->first);
+
+            m_selfModification = true;
+            m_botStore->Restore(m_rtip->rti_dbip, compressed);
+        }
+        else
+            BU_UNSETJUMP;
+
+        BU_UNSETJUMP;
+
+        m_selfModification = false;
+        m_botStore->entries.clear();
+    }
+}
+
+
+bool MemoryDatabase::KeptContent
+(
+    const directory* pDir,
+    const void*&     data,
+    size_t&          size
+) const {
+    bool ret = false;
+
+    if (pDir != nullptr) {
+        auto entry = m_botStore->entries.find(pDir->d_namep);
+
+        // a restored object is completely in the database
+        if ((entry != m_botStore->entries.end()) && (entry->second.accessDepth == 0)) {
+            data = entry->second.geometry.data();
+            size = entry->second.geometry.size();
+            ret  = true;
+        }
+    }
+
+    return ret;
+}
+
+
+bool MemoryDatabase::KeepsContent(void) const {
+    return !m_botStore->entries.empty();
+}
+
+
+void MemoryDatabase::CompleteInternal
+(
+    const directory* pDir,
+    const double*    matrix,
+    rt_db_internal&  intern
+) const {
+    if ((pDir != nullptr) && (intern.idb_major_type == DB5_MAJORTYPE_BRLCAD) && (intern.idb_minor_type == ID_BOT) && (intern.idb_ptr != nullptr)) {
+        auto entry = m_botStore->entries.find(pDir->d_namep);
+
+        // a restored object is completely in the database
+        if ((entry != m_botStore->entries.end()) && (entry->second.accessDepth == 0)) {
+            rt_bot_internal* bot = static_cast<rt_bot_internal*>(intern.idb_ptr);
+
+            RT_BOT_CK_MAGIC(bot);
+            StripBot(*bot);
+            DecodeBot(entry->second.geometry, *bot);
+
+            // the placeholder was read with the matrix applied, the geometry has to follow
+            if (matrix != nullptr) {
+                for (size_t i = 0; i < bot->num_vertices; ++i) {
+                    point_t vertex;
+
+                    MAT4X3PNT(vertex, matrix, bot->vertices + 3 * i);
+                    VMOVE(bot->vertices + 3 * i, vertex);
+                }
+
+                for (size_t i = 0; i < bot->num_normals; ++i) {
+                    vect_t normal;
+
+                    MAT4X3VEC(normal, matrix, bot->normals + 3 * i);
+                    VUNITIZE(normal);
+                    VMOVE(bot->normals + 3 * i, normal);
+                }
+            }
+        }
+    }
+}
+
+
+void MemoryDatabase::BeginTreeAccess
+(
+    const char* objectName
+) {
+    std::vector<std::string> restored;
+
+    if ((m_rtip != nullptr) && !m_botStore->entries.empty() && (objectName != nullptr)) {
+        if (!BU_SETJUMP) {
+            // objectName may be a path into the tree
+            const char* baseName = strrchr(objectName, '/');
+            directory*  pDir     = db_lookup(m_rtip->rti_dbip, (baseName != nullptr) ? baseName + 1 : objectName, LOOKUP_QUIET);
+
+            if (pDir != RT_DIR_NULL) {
+                std::vector<std::string> leaves;
+
+                db_functree(m_rtip->rti_dbip, pDir, nullptr, CollectLeaf, m_resp, &leaves);
+                std::sort(leaves.begin(), leaves.end());
+                leaves.erase(std::unique(leaves.begin(), leaves.end()), leaves.end());
+
+                for (size_t i = 0; i < leaves.size(); ++i) {
+                    if (m_botStore->entries.find(leaves[i]) != m_botStore->entries.end())
+                        restored.push_back(leaves[i]);
+                }
+
+                m_selfModification = true;
+                m_botStore->Restore(m_rtip->rti_dbip, restored);
+            }
+        }
+        else
+            BU_UNSETJUMP;
+
+        BU_UNSETJUMP;
+
+        m_selfModification = false;
+    }
+
+    m_botStore->accesses.push_back(restored);
+}
+
+
+void MemoryDatabase::EndTreeAccess
+(
+    const char* UNUSED(objectName)
+) {
+    if (!m_botStore->accesses.empty()) {
+        std::vector<std::string> restored;
+
+        restored.swap(m_botStore->accesses.back());
+        m_botStore->accesses.pop_back();
+
+        if ((m_rtip != nullptr) && !restored.empty()) {
+            if (!BU_SETJUMP) {
+                m_selfModification = true;
+                m_botStore->Release(m_rtip->rti_dbip, restored);
+            }
+            else
+                BU_UNSETJUMP;
+
+            BU_UNSETJUMP;
+
+            m_selfModification = false;
+        }
+    }
+}
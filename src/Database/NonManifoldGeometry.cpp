@@ -24,12 +24,19 @@
  */
 
 #include <cassert>
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
 
 #include "raytrace.h"
 #include "bu/parallel.h"
+#include "bv/vlist.h"
 
 #include <brlcad/Database/NonManifoldGeometry.h>
 
+#include "private.h"
+
 
 using namespace BRLCAD;
 
@@ -471,6 +478,113 @@ NonManifoldGeometry::Region NonManifoldGeometry::RegionIterator::CurrentRegion(v
 }
 
 
+//
+// class NonManifoldGeometry::IndexedFaces
+//
+
+class NonManifoldGeometry::IndexedFaces::Arrays {
+public:
+    std::vector<double>        vertices;
+    std::vector<size_t>        loopOffsets;
+    std::vector<size_t>        loopVertices;
+    std::vector<unsigned char> loopIsHole;
+    std::vector<size_t>        faceLoopOffsets;
+    std::vector<double>        faceNormals;
+    std::vector<size_t>        faceShells;
+    std::vector<size_t>        shellRegions;
+    size_t                     numberOfRegions;
+
+    Arrays(void) : numberOfRegions(0) {}
+
+    void Clear(void) {
+        vertices.clear();
+        loopOffsets.assign(1, 0);
+        loopVertices.clear();
+        loopIsHole.clear();
+        faceLoopOffsets.assign(1, 0);
+        faceNormals.clear();
+        faceShells.clear();
+        shellRegions.clear();
+        numberOfRegions = 0;
+    }
+};
+
+
+NonManifoldGeometry::IndexedFaces::IndexedFaces(void) : m_arrays(new Arrays) {
+    m_arrays->Clear();
+}
+
+
+NonManifoldGeometry::IndexedFaces::~IndexedFaces(void) {
+    delete m_arrays;
+}
+
+
+size_t NonManifoldGeometry::IndexedFaces::NumberOfVertices(void) const {
+    return m_arrays->vertices.size() / 3;
+}
+
+
+const double* NonManifoldGeometry::IndexedFaces::Vertices(void) const {
+    return m_arrays->vertices.data();
+}
+
+
+size_t NonManifoldGeometry::IndexedFaces::NumberOfLoops(void) const {
+    return m_arrays->loopIsHole.size();
+}
+
+
+const size_t* NonManifoldGeometry::IndexedFaces::LoopOffsets(void) const {
+    return m_arrays->loopOffsets.data();
+}
+
+
+const size_t* NonManifoldGeometry::IndexedFaces::LoopVertices(void) const {
+    return m_arrays->loopVertices.data();
+}
+
+
+const unsigned char* NonManifoldGeometry::IndexedFaces::LoopIsHole(void) const {
+    return m_arrays->loopIsHole.data();
+}
+
+
+size_t NonManifoldGeometry::IndexedFaces::NumberOfFaces(void) const {
+    return m_arrays->faceShells.size();
+}
+
+
+const size_t* NonManifoldGeometry::IndexedFaces::FaceLoopOffsets(void) const {
+    return m_arrays->faceLoopOffsets.data();
+}
+
+
+const double* NonManifoldGeometry::IndexedFaces::FaceNormals(void) const {
+    return m_arrays->faceNormals.data();
+}
+
+
+const size_t* NonManifoldGeometry::IndexedFaces::FaceShells(void) const {
+    return m_arrays->faceShells.data();
+}
+
+
+size_t NonManifoldGeometry::IndexedFaces::NumberOfShells(void) const {
+    return m_arrays->shellRegions.size();
+}
+
+
+const size_t* NonManifoldGeometry::IndexedFaces::ShellRegions(void) const {
+    return m_arrays->shellRegions.data();
+}
+
+
+size_t NonManifoldGeometry::IndexedFaces::NumberOfRegions(void) const {
+    return m_arrays->numberOfRegions;
+}
+
+
 //
 // class NonManifoldGeometry
 //
@@ -540,14 +654,582 @@ const NonManifoldGeometry& NonManifoldGeometry::operator=
 }
 
 
-void NonManifoldGeometry::Triangulate(void) {
-    bn_tol tolerance;
+static const double DefaultDistanceTolerance = 0.0005;
+
+
+static bn_tol NmgTolerance
+(
+    double distanceTolerance
+) {
+    bn_tol ret;
+
+    ret.magic   = BN_TOL_MAGIC;
+    ret.dist    = distanceTolerance;
+    ret.dist_sq = ret.dist * ret.dist;
+    ret.perp    = 1e-6;
+    ret.para    = 1 - ret.perp;
+
+    return ret;
+}
+
+
+/// hash of an edge given by its two vertices in ascending order
+struct EdgeHash {
+    size_t operator()(const std::pair<const vertex*, const vertex*>& edge) const {
+        std::hash<const vertex*> hash;
+
+        return hash(edge.first) ^ (hash(edge.second) * 0x9e3779b97f4a7c15ULL);
+    }
+};
+
+
+bool NonManifoldGeometry::AddPolygons
+(
+    size_t        numberOfVertices,
+    const double* vertices,
+    size_t        numberOfPolygons,
+    const size_t* polygonOffsets,
+    const size_t* polygonVertices
+) {
+    bool ret = true;
+
+    for (size_t i = 0; ret && (i < numberOfPolygons); ++i) {
+        ret = (polygonOffsets[i] <= polygonOffsets[i + 1]);
+
+        for (size_t j = polygonOffsets[i]; ret && (j < polygonOffsets[i + 1]); ++j)
+            ret = (polygonVertices[j] < numberOfVertices);
+    }
+
+    if (ret) {
+        bn_tol     tolerance = NmgTolerance(DefaultDistanceTolerance);
+        nmgregion* region    = nullptr;
+
+        if (!BU_SETJUMP) {
+            region = nmg_mrsv(Internal());
+
+            shell*                 nmgShell = BU_LIST_FIRST(shell, &region->s_hd);
+            std::vector<vertex*>   nmgVertices(numberOfVertices, nullptr);
+            std::vector<size_t>    polygon;
+            std::vector<vertex**>  faceVertices;
+            std::vector<faceuse*>  faces;
+            std::unordered_map<std::pair<const vertex*, const vertex*>, edgeuse*, EdgeHash> edges;
+
+            for (size_t i = 0; i < numberOfPolygons; ++i) {
+                // remove repeated vertices at the boundary of the polygon
+                polygon.clear();
+
+                for (size_t j = polygonOffsets[i]; j < polygonOffsets[i + 1]; ++j) {
+                    if (polygon.empty() || (polygon.back() != polygonVertices[j]))
+                        polygon.push_back(polygonVertices[j]);
+                }
+
+                while ((polygon.size() > 1) && (polygon.front() == polygon.back()))
+                    polygon.pop_back();
+
+                if (polygon.size() < 3)
+                    continue;
+
+                std::vector<size_t> sorted(polygon);
+
+                std::sort(sorted.begin(), sorted.end());
+
+                if (std::adjacent_find(sorted.begin(), sorted.end()) != sorted.end())
+                    continue; // self touching polygon
+
+                // the plane by Newell's method
+                plane_t plane = HINIT_ZERO;
+                point_t center = VINIT_ZERO;
+
+                for (size_t j = 0; j < polygon.size(); ++j) {
+                    const double* current = vertices + 3 * polygon[j];
+                    const double* next    = vertices + 3 * polygon[(j + 1) % polygon.size()];
+
+                    plane[X] += (current[Y] - next[Y]) * (current[Z] + next[Z]);
+                    plane[Y] += (current[Z] - next[Z]) * (current[X] + next[X]);
+                    plane[Z] += (current[X] - next[X]) * (current[Y] + next[Y]);
+                    VADD2(center, center, current);
+                }
+
+                double length = MAGNITUDE(plane);
+
+                if (length < SMALL_FASTF)
+                    continue; // degenerated
+
+                VSCALE(plane, plane, 1. / length);
+                VSCALE(center, center, 1. / polygon.size());
+                plane[W] = VDOT(plane, center);
+
+                faceVertices.resize(polygon.size());
+
+                for (size_t j = 0; j < polygon.size(); ++j)
+                    faceVertices[j] = &nmgVertices[polygon[j]];
+
+                faceuse* face = nmg_cmface(nmgShell, faceVertices.data(), static_cast<int>(polygon.size()));
+
+                for (size_t j = 0; j < polygon.size(); ++j) {
+                    vertex* nmgVertex = nmgVertices[polygon[j]];
+
+                    if (nmgVertex->vg_p == nullptr)
+                        nmg_vertex_gv(nmgVertex, vertices + 3 * polygon[j]);
+                }
+
+                nmg_face_g(face, plane);
+
+                // share the edges with the already created faces
+                loopuse* loop = BU_LIST_FIRST(loopuse, &face->lu_hd);
+                edgeuse* edge;
+
+                for (BU_LIST_FOR(edge, edgeuse, &loop->down_hd)) {
+                    const vertex* first  = edge->vu_p->v_p;
+                    const vertex* second = edge->eumate_p->vu_p->v_p;
+
+                    if (second < first)
+                        std::swap(first, second);
+
+                    auto existing = edges.find(std::make_pair(first, second));
+
+                    if (existing != edges.end()) {
+                        if (existing->second->e_p != edge->e_p)
+                            nmg_je(existing->second, edge);
+                    }
+                    else
+                        edges[std::make_pair(first, second)] = edge;
+                }
+
+                faces.push_back(face);
+            }
+
+            if (faces.empty())
+                ret = false; // only degenerated polygons
+            else {
+                for (auto edge = edges.begin(); edge != edges.end(); ++edge)
+                    nmg_edge_g(edge->second);
+
+                for (size_t i = 0; i < faces.size(); ++i)
+                    nmg_face_bb(faces[i]->f_p, &tolerance);
+
+                // the lone vertex of the initial shell isn't needed
+                if (nmgShell->vu_p != nullptr)
+                    nmg_kvu(nmgShell->vu_p);
+
+                nmg_region_a(region, &tolerance);
+            }
+        }
+        else {
+            BU_UNSETJUMP;
+            ret = false;
+        }
+
+        BU_UNSETJUMP;
+
+        // don't leave an empty or half-built region behind
+        if (!ret && (region != nullptr)) {
+            if (!BU_SETJUMP)
+                nmg_kr(region);
+            else {
+                BU_UNSETJUMP;
+            }
+
+            BU_UNSETJUMP;
+        }
+    }
+
+    return ret;
+}
+
+
+/// a face to be triangulated and its triangles computed on a copy of it
+struct FaceTriangulation {
+    faceuse*             face;
+    bool                 copied;  ///< false if the face has to be triangulated in place
+    std::vector<vertex*> corners; ///< three per triangle in the order of the face's loops
+};
+
+
+static bool IsTriangle
+(
+    const faceuse& face
+) {
+    size_t         numberOfLoops = 0;
+    size_t         numberOfEdges = 0;
+    const loopuse* loop;
+
+    for (BU_LIST_FOR(loop, loopuse, &face.lu_hd)) {
+        ++numberOfLoops;
+
+        if (BU_LIST_FIRST_MAGIC(&loop->down_hd) == NMG_EDGEUSE_MAGIC) {
+            const edgeuse* edge;
+
+            for (BU_LIST_FOR(edge, edgeuse, &loop->down_hd))
+                ++numberOfEdges;
+        }
+    }
+
+    return (numberOfLoops == 1) && (numberOfEdges == 3);
+}
+
+
+static void CollectFaces
+(
+    shell&                          nmgShell,
+    std::vector<FaceTriangulation>& faces
+) {
+    faceuse* face;
+
+    for (BU_LIST_FOR(face, faceuse, &nmgShell.fu_hd)) {
+        if ((face->orientation == OT_SAME) && !IsTriangle(*face)) {
+            FaceTriangulation faceTriangulation;
+
+            faceTriangulation.face   = face;
+            faceTriangulation.copied = false;
+            faces.push_back(faceTriangulation);
+        }
+    }
+}
+
+
+/// triangulates a copy of \a face in a model of its own and records the corners of the resulting triangles
+/** Only \a face is read, therefore it can run in parallel for different faces of the same model.
+    \return false if the face can't be copied or the triangulation introduced new vertices */
+static bool TriangulateCopy
+(
+    const faceuse&        face,
+    const bn_tol&         tolerance,
+    std::vector<vertex*>& corners
+) {
+    bool                              ret = (face.f_p->g.plane_p != nullptr) && (*face.f_p->g.magic_p == NMG_FACE_G_PLANE_MAGIC);
+    std::vector<vertex*>              originals;
+    std::vector<std::vector<size_t> > loops;
+    std::vector<int>                  orientations;
+    size_t                            outerLoop = SIZE_MAX;
+    const loopuse*                    loop;
+
+    for (BU_LIST_FOR(loop, loopuse, &face.lu_hd)) {
+        if (BU_LIST_FIRST_MAGIC(&loop->down_hd) != NMG_EDGEUSE_MAGIC)
+            ret = false;
+        else {
+            const edgeuse* edge;
+
+            loops.push_back(std::vector<size_t>());
+            orientations.push_back((loop->orientation == OT_SAME) ? OT_SAME : OT_OPPOSITE);
+
+            if ((outerLoop == SIZE_MAX) && (loop->orientation == OT_SAME))
+                outerLoop = loops.size() - 1;
+
+            for (BU_LIST_FOR(edge, edgeuse, &loop->down_hd)) {
+                if (edge->vu_p->v_p->vg_p == nullptr)
+                    ret = false;
+
+                loops.back().push_back(originals.size());
+                originals.push_back(edge->vu_p->v_p);
+            }
+        }
+    }
+
+    if (ret && (outerLoop != SIZE_MAX)) {
+        std::vector<vertex*> sorted(originals);
+
+        std::sort(sorted.begin(), sorted.end());
+        ret = (std::adjacent_find(sorted.begin(), sorted.end()) == sorted.end()); // touching loops are left to the in place triangulation
+    }
+    else
+        ret = false;
+
+    if (ret) {
+        if (!BU_SETJUMP) {
+            model*                copy       = nmg_mm();
+            nmgregion*            region     = nmg_mrsv(copy);
+            shell*                copyShell  = BU_LIST_FIRST(shell, &region->s_hd);
+            std::vector<vertex*>  copies(originals.size(), nullptr);
+            std::vector<vertex**> outerVertices;
+            plane_t               plane;
+
+            for (size_t i = 0; i < loops[outerLoop].size(); ++i)
+                outerVertices.push_back(&copies[loops[outerLoop][i]]);
+
+            faceuse* copyFace = nmg_cmface(copyShell, outerVertices.data(), static_cast<int>(outerVertices.size()));
+
+            for (size_t i = 0; i < loops.size(); ++i) {
+                if (i != outerLoop) {
+                    std::vector<vertex*> loopVertices(loops[i].size(), nullptr);
+
+                    nmg_add_loop_to_face(copyShell, copyFace, loopVertices.data(), static_cast<int>(loopVertices.size()), orientations[i]);
+
+                    for (size_t j = 0; j < loops[i].size(); ++j)
+                        copies[loops[i][j]] = loopVertices[j];
+                }
+            }
+
+            if (copyShell->vu_p != nullptr)
+                nmg_kvu(copyShell->vu_p);
+
+            std::unordered_map<const vertex*, vertex*> originalOf;
+
+            for (size_t i = 0; i < copies.size(); ++i) {
+                nmg_vertex_gv(copies[i], originals[i]->vg_p->coord);
+                originalOf[copies[i]] = originals[i];
+            }
+
+            NMG_GET_FU_PLANE(plane, &face);
+            nmg_face_g(copyFace, plane);
+            nmg_face_bb(copyFace->f_p, &tolerance);
+
+            for (BU_LIST_FOR(loop, loopuse, &copyFace->lu_hd)) {
+                edgeuse* edge;
+
+                for (BU_LIST_FOR(edge, edgeuse, &loop->down_hd)) {
+                    if (edge->g.magic_p == nullptr)
+                        nmg_edge_g(edge);
+                }
+            }
+
+            bu_list vlfree;
+
+            BU_LIST_INIT(&vlfree);
+            nmg_triangulate_fu(copyFace, &vlfree, &tolerance);
+            bv_vlist_cleanup(&vlfree);
+
+            const faceuse* triangulatedFace;
+
+            for (BU_LIST_FOR(triangulatedFace, faceuse, &copyShell->fu_hd)) {
+                if (triangulatedFace->orientation != OT_SAME)
+                    continue;
+
+                for (BU_LIST_FOR(loop, loopuse, &triangulatedFace->lu_hd)) {
+                    if ((BU_LIST_FIRST_MAGIC(&loop->down_hd) != NMG_EDGEUSE_MAGIC) || (loop->orientation != OT_SAME))
+                        ret = false;
+                    else {
+                        const edgeuse* edge;
+                        size_t         numberOfCorners = 0;
+
+                        for (BU_LIST_FOR(edge, edgeuse, &loop->down_hd)) {
+                            auto original = originalOf.find(edge->vu_p->v_p);
+
+                            if (original != originalOf.end())
+                                corners.push_back(original->second);
+                            else
+                                ret = false;
+
+                            ++numberOfCorners;
+                        }
+
+                        if (numberOfCorners != 3)
+                            ret = false;
+                    }
+                }
+            }
+
+            nmg_km(copy);
+        }
+        else {
+            BU_UNSETJUMP;
+            ret = false;
+        }
+
+        BU_UNSETJUMP;
+    }
+
+    if (!ret)
+        corners.clear();
+
+    return ret;
+}
+
+
+/// replaces the loops of \a face by the triangles with the given corners
+/** The faceuse remains, the triangles are connected with each other and the adjacent faces. */
+static void ReplaceLoops
+(
+    faceuse&                    face,
+    const std::vector<vertex*>& corners
+) {
+    shell*                nmgShell = face.s_p;
+    std::vector<loopuse*> originalLoops;
+    loopuse*              loop;
+
+    for (BU_LIST_FOR(loop, loopuse, &face.lu_hd))
+        originalLoops.push_back(loop);
+
+    // the new loops are made before the old ones are killed, this keeps the vertices alive
+    for (size_t i = 0; i + 2 < corners.size(); i += 3) {
+        vertex* triangle[3] = {corners[i], corners[i + 1], corners[i + 2]};
+
+        nmg_add_loop_to_face(nmgShell, &face, triangle, 3, OT_SAME);
+    }
+
+    for (size_t i = 0; i < originalLoops.size(); ++i)
+        nmg_klu(originalLoops[i]);
+
+    for (BU_LIST_FOR(loop, loopuse, &face.lu_hd)) {
+        edgeuse* edge;
 
-    tolerance.magic   = BN_TOL_MAGIC;
-    tolerance.dist    = 0.0005;
-    tolerance.dist_sq = tolerance.dist * tolerance.dist;
-    tolerance.perp    = 1e-6;
-    tolerance.para    = 1 - tolerance.perp;
+        for (BU_LIST_FOR(edge, edgeuse, &loop->down_hd)) {
+            edgeuse* existing = nmg_findeu(edge->vu_p->v_p, edge->eumate_p->vu_p->v_p, nmgShell, edge, 0);
+
+            if ((existing != nullptr) && (existing->e_p != edge->e_p))
+                nmg_je(existing, edge);
+
+            if (edge->g.magic_p == nullptr)
+                nmg_edge_g(edge);
+        }
+    }
+}
+
+
+/// applies the triangulations of the copies to a clone of the faces' model and verifies the result with nmg_vmodel()
+/** The clone has the same indices as the original model, they identify the faces and vertices.
+    \return false if the replaced loops would give an invalid model */
+static bool ReplacementIsValid
+(
+    const std::vector<FaceTriangulation>& faces
+) {
+    bool   ret   = true;
+    model* trial = nullptr;
+
+    if (!BU_SETJUMP) {
+        trial = nmg_clone_model(faces[0].face->s_p->r_p->m_p);
+
+        std::vector<faceuse*> trialFaces(trial->maxindex, nullptr);
+        std::vector<vertex*>  trialVertices(trial->maxindex, nullptr);
+        nmgregion*            region;
+
+        for (BU_LIST_FOR(region, nmgregion, &trial->r_hd)) {
+            shell* nmgShell;
+
+            for (BU_LIST_FOR(nmgShell, shell, &region->s_hd)) {
+                faceuse* face;
+
+                for (BU_LIST_FOR(face, faceuse, &nmgShell->fu_hd)) {
+                    loopuse* loop;
+
+                    trialFaces[face->index] = face;
+
+                    for (BU_LIST_FOR(loop, loopuse, &face->lu_hd)) {
+                        if (BU_LIST_FIRST_MAGIC(&loop->down_hd) == NMG_EDGEUSE_MAGIC) {
+                            edgeuse* edge;
+
+                            for (BU_LIST_FOR(edge, edgeuse, &loop->down_hd))
+                                trialVertices[edge->vu_p->v_p->index] = edge->vu_p->v_p;
+                        }
+                    }
+                }
+            }
+        }
+
+        for (size_t i = 0; ret && (i < faces.size()); ++i) {
+            if (faces[i].copied) {
+                faceuse*             trialFace = trialFaces[faces[i].face->index];
+                std::vector<vertex*> trialCorners(faces[i].corners.size(), nullptr);
+
+                for (size_t j = 0; j < trialCorners.size(); ++j) {
+                    trialCorners[j] = trialVertices[faces[i].corners[j]->index];
+
+                    if (trialCorners[j] == nullptr)
+                        ret = false;
+                }
+
+                if (ret && (trialFace != nullptr))
+                    ReplaceLoops(*trialFace, trialCorners);
+                else
+                    ret = false;
+            }
+        }
+
+        if (ret)
+            nmg_vmodel(trial); // doesn't return if the model is invalid
+    }
+    else {
+        BU_UNSETJUMP;
+        ret = false;
+    }
+
+    BU_UNSETJUMP;
+
+    if (trial != nullptr) {
+        if (!BU_SETJUMP)
+            nmg_km(trial);
+        else {
+            BU_UNSETJUMP;
+        }
+
+        BU_UNSETJUMP;
+    }
+
+    return ret;
+}
+
+
+/// triangulates \a faces, which have to be part of the same model
+/** If \a parallel is set and there is more than one face the triangulations are computed in parallel on copies of the faces.
+    They are applied to the model serially afterwards if they give a valid model, otherwise all faces are triangulated in place.
+    Without \a parallel the faces are triangulated in place one after the other.
+    The errors of libnmg are caught here, i.e. the caller doesn't need an own BU_SETJUMP. */
+static void TriangulateFaces
+(
+    std::vector<FaceTriangulation>& faces,
+    const bn_tol&                   tolerance,
+    bool                            parallel
+) {
+    bool useCopies = false;
+
+    if (parallel && (faces.size() > 1)) {
+        NonManifoldFor(faces.size(), parallel, [&faces, &tolerance](size_t begin, size_t end, size_t) {
+            for (size_t i = begin; i < end; ++i)
+                faces[i].copied = TriangulateCopy(*faces[i].face, tolerance, faces[i].corners);
+        });
+
+        bool anyCopied = false;
+
+        for (size_t i = 0; i < faces.size(); ++i)
+            anyCopied = anyCopied || faces[i].copied;
+
+        useCopies = anyCopied && ReplacementIsValid(faces);
+    }
+
+    if (!BU_SETJUMP) {
+        bu_list vlfree;
+
+        BU_LIST_INIT(&vlfree);
+
+        for (size_t i = 0; i < faces.size(); ++i) {
+            if (useCopies && faces[i].copied)
+                ReplaceLoops(*faces[i].face, faces[i].corners);
+            else
+                nmg_triangulate_fu(faces[i].face, &vlfree, &tolerance);
+        }
+
+        bv_vlist_cleanup(&vlfree);
+    }
+    else {
+        BU_UNSETJUMP;
+    }
+
+    BU_UNSETJUMP;
+}
+
+
+static void TriangulateModel
+(
+    model&        nmgModel,
+    const bn_tol& tolerance,
+    bool          parallel
+) {
+    std::vector<FaceTriangulation> faces;
+    nmgregion*                     region;
+
+    for (BU_LIST_FOR(region, nmgregion, &nmgModel.r_hd)) {
+        shell* nmgShell;
+
+        for (BU_LIST_FOR(nmgShell, shell, &region->s_hd))
+            CollectFaces(*nmgShell, faces);
+    }
+
+    TriangulateFaces(faces, tolerance, parallel);
+}
+
+
+void NonManifoldGeometry::Triangulate(void) {
+    bn_tol tolerance = NmgTolerance(DefaultDistanceTolerance);
 
     if (!BU_SETJUMP)
         nmg_triangulate_model(Internal(), &rt_vlfree, &tolerance);
@@ -563,13 +1245,7 @@ void NonManifoldGeometry::Triangulate
 (
     Shell& shellToTrinagulate
 ) {
-    bn_tol tolerance;
-
-    tolerance.magic   = BN_TOL_MAGIC;
-    tolerance.dist    = 0.0005;
-    tolerance.dist_sq = tolerance.dist * tolerance.dist;
-    tolerance.perp    = 1e-6;
-    tolerance.para    = 1 - tolerance.perp;
+    bn_tol tolerance = NmgTolerance(DefaultDistanceTolerance);
 
     if (!BU_SETJUMP)
         nmg_triangulate_shell(const_cast<shell*>(shellToTrinagulate.m_shell), &rt_vlfree, &tolerance);
@@ -585,13 +1261,7 @@ void NonManifoldGeometry::Triangulate
 (
     Face& faceToTrinagulate
 ) {
-    bn_tol tolerance;
-
-    tolerance.magic   = BN_TOL_MAGIC;
-    tolerance.dist    = 0.0005;
-    tolerance.dist_sq = tolerance.dist * tolerance.dist;
-    tolerance.perp    = 1e-6;
-    tolerance.para    = 1 - tolerance.perp;
+    bn_tol tolerance = NmgTolerance(DefaultDistanceTolerance);
 
     if (!BU_SETJUMP)
         nmg_triangulate_fu(const_cast<faceuse*>(faceToTrinagulate.m_face), &rt_vlfree, &tolerance);
@@ -603,6 +1273,65 @@ void NonManifoldGeometry::Triangulate
 }
 
 
+void NonManifoldGeometry::Triangulate
+(
+    double distanceTolerance
+) {
+    Triangulate(distanceTolerance, false);
+}
+
+
+void NonManifoldGeometry::Triangulate
+(
+    Shell& shellToTrinagulate,
+    double distanceTolerance
+) {
+    Triangulate(shellToTrinagulate, distanceTolerance, false);
+}
+
+
+void NonManifoldGeometry::Triangulate
+(
+    Face&  faceToTrinagulate,
+    double distanceTolerance
+) {
+    faceuse* face = const_cast<faceuse*>(faceToTrinagulate.m_face);
+
+    if (face->orientation != OT_SAME)
+        face = face->fumate_p;
+
+    if (!IsTriangle(*face)) {
+        std::vector<FaceTriangulation> faces(1);
+
+        faces[0].face   = face;
+        faces[0].copied = false;
+        TriangulateFaces(faces, NmgTolerance(distanceTolerance), false);
+    }
+}
+
+
+void NonManifoldGeometry::Triangulate
+(
+    double distanceTolerance,
+    bool   parallel
+) {
+    TriangulateModel(*Internal(), NmgTolerance(distanceTolerance), parallel);
+}
+
+
+void NonManifoldGeometry::Triangulate
+(
+    Shell& shellToTrinagulate,
+    double distanceTolerance,
+    bool   parallel
+) {
+    std::vector<FaceTriangulation> faces;
+
+    CollectFaces(*const_cast<shell*>(shellToTrinagulate.m_shell), faces);
+    TriangulateFaces(faces, NmgTolerance(distanceTolerance), parallel);
+}
+
+
 NonManifoldGeometry::RegionIterator NonManifoldGeometry::Regions(void) const {
     NonManifoldGeometry::RegionIterator ret;
     ret.m_model = Internal();
@@ -611,6 +1340,125 @@ NonManifoldGeometry::RegionIterator NonManifoldGeometry::Regions(void) const {
 }
 
 
+void NonManifoldGeometry::Flatten
+(
+    IndexedFaces& indexedFaces,
+    bool          triangulated
+) const {
+    Flatten(indexedFaces, triangulated, DefaultDistanceTolerance);
+}
+
+
+void NonManifoldGeometry::Flatten
+(
+    IndexedFaces& indexedFaces,
+    bool          triangulated,
+    double        distanceTolerance
+) const {
+    IndexedFaces::Arrays& arrays = *indexedFaces.m_arrays;
+    model*                copy   = nullptr;
+
+    arrays.Clear();
+
+    if (!BU_SETJUMP) {
+        const model* flattened = Internal();
+
+        if (triangulated) {
+            bn_tol tolerance = NmgTolerance(distanceTolerance);
+
+            copy = nmg_clone_model(flattened);
+            nmg_triangulate_model(copy, &rt_vlfree, &tolerance);
+            flattened = copy;
+        }
+
+        // the vertices are identified by their index in the model, i.e. without any search structure
+        std::vector<size_t> vertexIndices(flattened->maxindex, SIZE_MAX);
+        const nmgregion*    region;
+
+        for (BU_LIST_FOR(region, nmgregion, &flattened->r_hd)) {
+            const shell* nmgShell;
+
+            NMG_CK_REGION(region);
+
+            for (BU_LIST_FOR(nmgShell, shell, &region->s_hd)) {
+                const faceuse* face;
+
+                NMG_CK_SHELL(nmgShell);
+
+                for (BU_LIST_FOR(face, faceuse, &nmgShell->fu_hd)) {
+                    NMG_CK_FACEUSE(face);
+
+                    if (face->orientation != OT_SAME)
+                        continue;
+
+                    const loopuse* loop;
+
+                    for (BU_LIST_FOR(loop, loopuse, &face->lu_hd)) {
+                        NMG_CK_LOOPUSE(loop);
+
+                        if (BU_LIST_FIRST_MAGIC(&loop->down_hd) != NMG_EDGEUSE_MAGIC)
+                            continue; // a loop of a single vertex doesn't bound an area
+
+                        const edgeuse* edge;
+
+                        for (BU_LIST_FOR(edge, edgeuse, &loop->down_hd)) {
+                            const vertex* nmgVertex = edge->vu_p->v_p;
+
+                            NMG_CK_VERTEX(nmgVertex);
+
+                            size_t& vertexIndex = vertexIndices[nmgVertex->index];
+
+                            if (vertexIndex == SIZE_MAX) {
+                                vertexIndex = arrays.vertices.size() / 3;
+
+                                if (nmgVertex->vg_p != nullptr)
+                                    arrays.vertices.insert(arrays.vertices.end(), nmgVertex->vg_p->coord, nmgVertex->vg_p->coord + 3);
+                                else
+                                    arrays.vertices.insert(arrays.vertices.end(), 3, 0.);
+                            }
+
+                            arrays.loopVertices.push_back(vertexIndex);
+                        }
+
+                        arrays.loopOffsets.push_back(arrays.loopVertices.size());
+                        arrays.loopIsHole.push_back((loop->orientation == OT_OPPOSITE) ? 1 : 0);
+                    }
+
+                    vect_t normal = VINIT_ZERO;
+
+                    if ((face->f_p != nullptr) && (*face->f_p->g.magic_p == NMG_FACE_G_PLANE_MAGIC))
+                        NMG_GET_FU_NORMAL(normal, face);
+
+                    arrays.faceNormals.insert(arrays.faceNormals.end(), normal, normal + 3);
+                    arrays.faceLoopOffsets.push_back(arrays.loopIsHole.size());
+                    arrays.faceShells.push_back(arrays.shellRegions.size());
+                }
+
+                arrays.shellRegions.push_back(arrays.numberOfRegions);
+            }
+
+            ++arrays.numberOfRegions;
+        }
+    }
+    else {
+        BU_UNSETJUMP;
+        arrays.Clear();
+    }
+
+    BU_UNSETJUMP;
+
+    if (copy != nullptr) {
+        if (!BU_SETJUMP)
+            nmg_km(copy);
+        else {
+            BU_UNSETJUMP;
+        }
+
+        BU_UNSETJUMP;
+    }
+}
+
+
 const Object& NonManifoldGeometry::operator=
 (
     const Object& original
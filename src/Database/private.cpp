@@ -0,0 +1,122 @@
+/*                      P R I V A T E . C P P
+ * BRL-CAD
+ *
+ * Copyright (c) 2026 United States Government as represented by
+ * the U.S. Army Research Laboratory.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this file; see the file named COPYING for more
+ * information.
+ */
+/** @file private.cpp
+ *
+ *  BRL-CAD core C++ interface:
+ *      private helper functions of the C++ interface implementation
+ */
+
+#include <atomic>
+#include <algorithm>
+
+#include "bu/parallel.h"
+
+#include "private.h"
+
+
+struct ParallelForData {
+    size_t                                                              count;
+    size_t                                                              grainSize;
+    const std::function<void(size_t begin, size_t end, size_t thread)>* body;
+    std::atomic<size_t>                                                 nextBlock;
+    std::atomic<size_t>                                                 nextThread;
+};
+
+
+static void ParallelForWorker
+(
+    int   UNUSED(cpu),
+    void* data
+) {
+    ParallelForData* forData = static_cast<ParallelForData*>(data);
+    size_t           thread  = forData->nextThread.fetch_add(1);
+
+    for (;;) {
+        size_t begin = forData->nextBlock.fetch_add(forData->grainSize);
+
+        if (begin >= forData->count)
+            break;
+
+        (*forData->body)(begin, std::min(begin + forData->grainSize, forData->count), thread);
+    }
+}
+
+
+size_t ParallelThreads
+(
+    size_t count,
+    size_t grainSize
+) {
+    if (grainSize < 1)
+        grainSize = 1;
+
+    size_t blocks = (count + grainSize - 1) / grainSize;
+    size_t ret    = bu_avail_cpus();
+
+    if (ret > blocks)
+        ret = blocks;
+
+    if (ret < 1)
+        ret = 1;
+
+    return ret;
+}
+
+
+void ParallelFor
+(
+    size_t                                                              count,
+    size_t                                                              grainSize,
+    const std::function<void(size_t begin, size_t end, size_t thread)>& body
+) {
+    if (grainSize < 1)
+        grainSize = 1;
+
+    size_t threads = ParallelThreads(count, grainSize);
+
+    if (count > 0) {
+        if (threads < 2)
+            body(0, count, 0);
+        else {
+            ParallelForData data;
+
+            data.count     = count;
+            data.grainSize = grainSize;
+            data.body      = &body;
+            data.nextBlock.store(0);
+            data.nextThread.store(0);
+
+            bu_parallel(ParallelForWorker, threads, &data);
+        }
+    }
+}
+
+
+void NonManifoldFor
+(
+    size_t                                                              count,
+    bool                                                                parallelNmg,
+    const std::function<void(size_t begin, size_t end, size_t thread)>& body
+) {
+    if (parallelNmg)
+        ParallelFor(count, 1, body);
+    else if (count > 0)
+        body(0, count, 0);
+}
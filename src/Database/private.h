@@ -27,6 +27,10 @@
 #ifndef PRIVATE_INCLUDED
 #define PRIVATE_INCLUDED
 
+#include <cstddef>
+#include <functional>
+
+
 struct rt_pipe_internal;
 struct rt_bot_internal;
 
@@ -47,4 +51,31 @@ void CleanUpBotInternal
 );
 
 
+/// number of threads ParallelFor() will use for \a count work items handed out in blocks of \a grainSize
+size_t ParallelThreads
+(
+    size_t count,
+    size_t grainSize
+);
+
+/// calls \a body for consecutive blocks [begin, end) of [0, count) on a pool of bu_parallel() threads
+/** \a thread is a dense index below ParallelThreads(count, grainSize) which can be used to select per-thread resources.
+    The blocks are handed out dynamically, i.e. their order of processing is undefined. */
+void ParallelFor
+(
+    size_t                                                            count,
+    size_t                                                            grainSize,
+    const std::function<void(size_t begin, size_t end, size_t thread)>& body
+);
+
+/// ParallelFor() for work on non-manifold geometry, which runs serially unless \a parallelNmg is set
+/** libnmg isn't known to be reentrant, see ConstDatabase::SetParallelNonManifoldGeometry(). */
+void NonManifoldFor
+(
+    size_t                                                            count,
+    bool                                                              parallelNmg,
+    const std::function<void(size_t begin, size_t end, size_t thread)>& body
+);
+
+
 #endif // PRIVATE_INCLUDED
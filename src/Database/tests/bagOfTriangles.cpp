@@ -0,0 +1,535 @@
+/*
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+ * SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER
+ * RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ * CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+#include <cmath>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include <iostream>
+
+#include <brlcad/Database/MemoryDatabase.h>
+#include <brlcad/Database/BagOfTriangles.h>
+#include <brlcad/Database/MappedBagOfTriangles.h>
+
+
+static const double Pi = 3.14159265358979323846;
+
+
+static double Dot
+(
+    const BRLCAD::Vector3D& a,
+    const BRLCAD::Vector3D& b
+) {
+    return a.coordinates[0] * b.coordinates[0] + a.coordinates[1] * b.coordinates[1] + a.coordinates[2] * b.coordinates[2];
+}
+
+
+static double Length
+(
+    const BRLCAD::Vector3D& a
+) {
+    return sqrt(Dot(a, a));
+}
+
+
+/// the unit normal of a face, its vertices are counter-clockwise seen from the outside
+static BRLCAD::Vector3D FaceNormal
+(
+    BRLCAD::BagOfTriangles::Face& face
+) {
+    BRLCAD::Vector3D a = face.Point(0);
+    BRLCAD::Vector3D b = face.Point(1);
+    BRLCAD::Vector3D c = face.Point(2);
+    double           u[3];
+    double           v[3];
+
+    for (size_t i = 0; i < 3; ++i) {
+        u[i] = b.coordinates[i] - a.coordinates[i];
+        v[i] = c.coordinates[i] - a.coordinates[i];
+    }
+
+    BRLCAD::Vector3D ret(u[1] * v[2] - u[2] * v[1], u[2] * v[0] - u[0] * v[2], u[0] * v[1] - u[1] * v[0]);
+    double           length = Length(ret);
+
+    for (size_t i = 0; i < 3; ++i)
+        ret.coordinates[i] /= length;
+
+    return ret;
+}
+
+
+/// a cube with the edge length 2 around the origin
+static void CreateCube
+(
+    BRLCAD::BagOfTriangles& bot
+) {
+    BRLCAD::Vector3D corners[8];
+
+    for (size_t i = 0; i < 8; ++i)
+        corners[i] = BRLCAD::Vector3D((i & 1) ? 1. : -1., (i & 2) ? 1. : -1., (i & 4) ? 1. : -1.);
+
+    // the quadrilaterals of the sides, counter-clockwise seen from the outside
+    const size_t sides[6][4] = {{0, 2, 3, 1}, {4, 5, 7, 6}, {0, 1, 5, 4}, {2, 6, 7, 3}, {0, 4, 6, 2}, {1, 3, 7, 5}};
+
+    for (size_t i = 0; i < 6; ++i) {
+        bot.AddFace(corners[sides[i][0]], corners[sides[i][1]], corners[sides[i][2]]);
+        bot.AddFace(corners[sides[i][0]], corners[sides[i][2]], corners[sides[i][3]]);
+    }
+}
+
+
+/// a sphere around the origin approximated by \a slices * \a stacks quadrilaterals, which become triangles at the poles
+static void CreateSphere
+(
+    BRLCAD::BagOfTriangles& bot,
+    double                  radius,
+    size_t                  slices,
+    size_t                  stacks
+) {
+    auto point = [radius, slices, stacks](size_t slice, size_t stack) {
+        double           theta = Pi * stack / stacks;
+        double           phi   = 2. * Pi * (slice % slices) / slices;
+        BRLCAD::Vector3D ret(radius * sin(theta) * cos(phi), radius * sin(theta) * sin(phi), radius * cos(theta));
+
+        // the poles have to be exactly the same vertex for all slices
+        if ((stack == 0) || (stack == stacks))
+            ret = BRLCAD::Vector3D(0., 0., (stack == 0) ? radius : -radius);
+
+        return ret;
+    };
+
+    for (size_t stack = 0; stack < stacks; ++stack) {
+        for (size_t slice = 0; slice < slices; ++slice) {
+            // southwards and eastwards
+            if (stack > 0)
+                bot.AddFace(point(slice, stack), point(slice, stack + 1), point(slice + 1, stack));
+
+            if (stack + 1 < stacks)
+                bot.AddFace(point(slice + 1, stack), point(slice, stack + 1), point(slice + 1, stack + 1));
+        }
+    }
+}
+
+
+/// a square with the edge length \a size in the xy plane, split into \a size * \a size unit squares
+static void CreateGrid
+(
+    BRLCAD::BagOfTriangles& bot,
+    size_t                  size
+) {
+    for (size_t i = 0; i < size; ++i) {
+        for (size_t j = 0; j < size; ++j) {
+            BRLCAD::Vector3D a(i, j, 0.);
+            BRLCAD::Vector3D b(i + 1., j, 0.);
+            BRLCAD::Vector3D c(i + 1., j + 1., 0.);
+            BRLCAD::Vector3D d(i, j + 1., 0.);
+
+            bot.AddFace(a, b, c);
+            bot.AddFace(a, c, d);
+        }
+    }
+}
+
+
+/// the largest deviation of a vertex of \a bot from the sphere with \a radius around the origin
+static double SphereDeviation
+(
+    BRLCAD::BagOfTriangles& bot,
+    double                  radius
+) {
+    double ret = 0.;
+
+    for (size_t i = 0; i < bot.NumberOfFaces(); ++i) {
+        BRLCAD::BagOfTriangles::Face face = bot.GetFace(i);
+
+        for (size_t j = 0; j < 3; ++j)
+            ret = std::max(ret, fabs(Length(face.Point(j)) - radius));
+    }
+
+    return ret;
+}
+
+
+/// the largest coordinate differences of the points and normals of the faces of \a a and \a b
+/** \return false if \a a and \a b have different numbers of faces */
+static bool Deviations
+(
+    BRLCAD::BagOfTriangles& a,
+    BRLCAD::BagOfTriangles& b,
+    double&                 pointDeviation,
+    double&                 normalDeviation
+) {
+    bool ret = (a.NumberOfFaces() == b.NumberOfFaces()) && (a.FacesHaveNormals() == b.FacesHaveNormals());
+
+    pointDeviation  = 0.;
+    normalDeviation = 0.;
+
+    for (size_t i = 0; ret && (i < a.NumberOfFaces()); ++i) {
+        BRLCAD::BagOfTriangles::Face faceA = a.GetFace(i);
+        BRLCAD::BagOfTriangles::Face faceB = b.GetFace(i);
+
+        for (size_t j = 0; j < 3; ++j) {
+            for (size_t k = 0; k < 3; ++k) {
+                pointDeviation = std::max(pointDeviation, fabs(faceA.Point(j).coordinates[k] - faceB.Point(j).coordinates[k]));
+
+                if (a.FacesHaveNormals())
+                    normalDeviation = std::max(normalDeviation, fabs(faceA.Normal(j).coordinates[k] - faceB.Normal(j).coordinates[k]));
+            }
+        }
+    }
+
+    return ret;
+}
+
+
+/// compares \a original with the bag of triangles \a objectName in \a database
+static bool Deviations
+(
+    const BRLCAD::MemoryDatabase& database,
+    const char*                   objectName,
+    BRLCAD::BagOfTriangles&       original,
+    double&                       pointDeviation,
+    double&                       normalDeviation
+) {
+    bool            ret    = false;
+    BRLCAD::Object* object = database.Get(objectName);
+
+    if (object != nullptr) {
+        BRLCAD::BagOfTriangles* bot = dynamic_cast<BRLCAD::BagOfTriangles*>(object);
+
+        if (bot != nullptr)
+            ret = Deviations(original, *bot, pointDeviation, normalDeviation);
+
+        object->Destroy();
+    }
+
+    return ret;
+}
+
+
+/// the faces with their points and normals as sorted tuples, independent of the face and vertex indices
+/** The corners of a face are rotated to start with the smallest point, i.e. the orientation is kept. */
+static std::vector<std::vector<double> > Triangles
+(
+    BRLCAD::BagOfTriangles& bot
+) {
+    std::vector<std::vector<double> > ret;
+
+    for (size_t i = 0; i < bot.NumberOfFaces(); ++i) {
+        BRLCAD::BagOfTriangles::Face      face = bot.GetFace(i);
+        std::vector<std::vector<double> > corners;
+
+        for (size_t j = 0; j < 3; ++j) {
+            BRLCAD::Vector3D point  = face.Point(j);
+            BRLCAD::Vector3D normal = face.Normal(j);
+
+            corners.push_back({point.coordinates[0], point.coordinates[1], point.coordinates[2], normal.coordinates[0], normal.coordinates[1], normal.coordinates[2]});
+        }
+
+        std::rotate(corners.begin(), std::min_element(corners.begin(), corners.end()), corners.end());
+
+        std::vector<double> triangle;
+
+        for (size_t j = 0; j < 3; ++j)
+            triangle.insert(triangle.end(), corners[j].begin(), corners[j].end());
+
+        ret.push_back(triangle);
+    }
+
+    std::sort(ret.begin(), ret.end());
+
+    return ret;
+}
+
+
+int main
+(
+    int   argc,
+    char* argv[]
+) {
+    int ret = 1;
+
+    if ((argc < 2) || (argv[1] == nullptr))
+        std::cerr << "Usage: " << argv[0] << " <test type>";
+    else {
+        if (strcmp(argv[1], "vertexNormals") == 0) {
+            BRLCAD::BagOfTriangles cube;
+            BRLCAD::BagOfTriangles sphere;
+            size_t                 creased  = 0;
+            size_t                 unsmooth = 0;
+
+            CreateCube(cube);
+            CreateSphere(sphere, 10., 32, 16);
+
+            // the edges of the cube are creases, i.e. every corner gets the normal of its face
+            cube.ComputeVertexNormals(30. * Pi / 180.);
+
+            for (size_t i = 0; i < cube.NumberOfFaces(); ++i) {
+                BRLCAD::BagOfTriangles::Face face   = cube.GetFace(i);
+                BRLCAD::Vector3D             normal = FaceNormal(face);
+
+                for (size_t j = 0; j < 3; ++j) {
+                    if (!(Dot(face.Normal(j), normal) > 1. - 1e-9))
+                        ++creased;
+                }
+            }
+
+            // the sphere is smooth, i.e. the normals point away from the center
+            sphere.ComputeVertexNormals(60. * Pi / 180.);
+
+            for (size_t i = 0; i < sphere.NumberOfFaces(); ++i) {
+                BRLCAD::BagOfTriangles::Face face = sphere.GetFace(i);
+
+                for (size_t j = 0; j < 3; ++j) {
+                    BRLCAD::Vector3D normal = face.Normal(j);
+                    BRLCAD::Vector3D point  = face.Point(j);
+
+                    if (!(fabs(Length(normal) - 1.) < 1e-6) || !(Dot(normal, point) / Length(point) > 0.995))
+                        ++unsmooth;
+                }
+            }
+
+            if (!cube.FacesHaveNormals() || !cube.UseFaceNormals() || !sphere.FacesHaveNormals() || !sphere.UseFaceNormals())
+                std::cerr << "The normals aren't enabled";
+            else if (creased > 0)
+                std::cerr << creased << " corners of the cube didn't get the normal of their face";
+            else if (unsmooth > 0)
+                std::cerr << unsmooth << " corners of the sphere didn't get a smooth normal";
+            else
+                ret = 0;
+        }
+        else if (strcmp(argv[1], "reorder") == 0) {
+            BRLCAD::BagOfTriangles sphere;
+
+            CreateSphere(sphere, 10., 64, 32);
+            sphere.ComputeVertexNormals(60. * Pi / 180.);
+
+            // the faces and their corners move together
+            std::vector<std::vector<double> > original = Triangles(sphere);
+
+            sphere.Reorder(false);
+
+            if (Triangles(sphere) != original)
+                std::cerr << "The Morton order changed the geometry";
+            else {
+                sphere.Reorder(true);
+
+                if (Triangles(sphere) != original)
+                    std::cerr << "The vertex cache optimization changed the geometry";
+                else if (sphere.NumberOfFaces() != 64 * 2 * 31)
+                    std::cerr << "The number of faces changed";
+                else
+                    ret = 0;
+            }
+        }
+        else if (strcmp(argv[1], "decimate") == 0) {
+            const double           radius   = 10.;
+            const double           maxError = 0.1;
+            BRLCAD::BagOfTriangles sphere;
+
+            CreateSphere(sphere, radius, 64, 32);
+            sphere.ComputeVertexNormals(60. * Pi / 180.);
+
+            // the distance of the planes of the original faces from the sphere
+            double                 sag       = radius * (1. - cos(Pi / 32.));
+            size_t                 original  = sphere.NumberOfFaces();
+            BRLCAD::BagOfTriangles unbounded = sphere;
+
+            // the error bound stops the decimation long before the target
+            sphere.Decimate(4, maxError);
+            unbounded.Decimate(4, -1.);
+
+            BRLCAD::BagOfTriangles grid;
+            size_t                 nonPlanar = 0;
+            size_t                 flipped   = 0;
+            double                 area      = 0.;
+
+            CreateGrid(grid, 20);
+            grid.Decimate(0, 1e-9);
+
+            for (size_t i = 0; i < grid.NumberOfFaces(); ++i) {
+                BRLCAD::BagOfTriangles::Face face = grid.GetFace(i);
+                BRLCAD::Vector3D             a    = face.Point(0);
+                BRLCAD::Vector3D             b    = face.Point(1);
+                BRLCAD::Vector3D             c    = face.Point(2);
+                double                       z    = (b.coordinates[0] - a.coordinates[0]) * (c.coordinates[1] - a.coordinates[1]) -
+                                                    (b.coordinates[1] - a.coordinates[1]) * (c.coordinates[0] - a.coordinates[0]);
+
+                for (size_t j = 0; j < 3; ++j) {
+                    if (fabs(face.Point(j).coordinates[2]) > 1e-9)
+                        ++nonPlanar;
+                }
+
+                if (z <= 0.)
+                    ++flipped;
+
+                area += z / 2.;
+            }
+
+            if (!(sphere.NumberOfFaces() < original) || (sphere.NumberOfFaces() <= 4))
+                std::cerr << "The bounded decimation removed " << (original - sphere.NumberOfFaces()) << " of " << original << " faces";
+            else if (SphereDeviation(sphere, radius) > maxError + 2. * sag)
+                std::cerr << "The bounded decimation moved a vertex " << SphereDeviation(sphere, radius) << " away from the sphere";
+            else if (sphere.FacesHaveNormals())
+                std::cerr << "The decimation kept the vertex normals";
+            else if (!(unbounded.NumberOfFaces() < sphere.NumberOfFaces()))
+                std::cerr << "The unbounded decimation didn't go beyond the bounded one";
+            else if (!(grid.NumberOfFaces() < 20 * 20 * 2))
+                std::cerr << "The plane wasn't decimated";
+            else if ((nonPlanar > 0) || (flipped > 0) || (fabs(area - 20. * 20.) > 1e-6))
+                std::cerr << "The decimation of the plane changed its shape";
+            else
+                ret = 0;
+        }
+        else if (strcmp(argv[1], "mapped") == 0) {
+            const double           radius = 10.;
+            BRLCAD::MemoryDatabase database;
+            BRLCAD::BagOfTriangles sphere;
+
+            CreateSphere(sphere, radius, 64, 32);
+            sphere.SetName("sphere.bot");
+
+            if (database.Add(sphere)) {
+                // a working set of a few pages only
+                BRLCAD::MappedBagOfTriangles* mapped = database.MapBagOfTriangles("sphere.bot", 4096);
+
+                if (mapped != nullptr) {
+                    size_t              differentFaces = 0;
+                    std::vector<size_t> indices(3 * mapped->NumberOfFaces());
+                    std::vector<double> coordinates(3 * mapped->NumberOfVertices());
+                    size_t              bulkFaces      = mapped->GetFaces(0, mapped->NumberOfFaces(), indices.data());
+                    size_t              bulkVertices   = mapped->GetVertices(0, mapped->NumberOfVertices(), coordinates.data());
+
+                    if ((mapped->NumberOfFaces() == sphere.NumberOfFaces()) && (bulkFaces == mapped->NumberOfFaces()) && (bulkVertices == mapped->NumberOfVertices())) {
+                        for (size_t i = 0; i < sphere.NumberOfFaces(); ++i) {
+                            BRLCAD::BagOfTriangles::Face       face       = sphere.GetFace(i);
+                            BRLCAD::MappedBagOfTriangles::Face mappedFace = mapped->GetFace(i);
+                            bool                               equal      = true;
+
+                            for (size_t j = 0; j < 3; ++j) {
+                                BRLCAD::Vector3D point       = face.Point(j);
+                                BRLCAD::Vector3D mappedPoint = mappedFace.Point(j);
+                                size_t           index       = indices[3 * i + j];
+
+                                equal = equal && (mappedFace.VertexIndex(j) == index) && (index < mapped->NumberOfVertices());
+
+                                for (size_t k = 0; equal && (k < 3); ++k)
+                                    equal = (point.coordinates[k] == mappedPoint.coordinates[k]) && (point.coordinates[k] == coordinates[3 * index + k]);
+                            }
+
+                            if (!equal)
+                                ++differentFaces;
+                        }
+                    }
+                    else
+                        differentFaces = sphere.NumberOfFaces();
+
+                    // an off-center ray from above, which enters and leaves the sphere
+                    BRLCAD::Ray3D       ray;
+                    std::vector<double> distances;
+
+                    ray.origin    = BRLCAD::Vector3D(0.3, 0.2, 2. * radius);
+                    ray.direction = BRLCAD::Vector3D(0., 0., -1.);
+
+                    bool   traversed = mapped->ShootRay(ray, [&distances](size_t, double distance) {
+                        distances.push_back(distance);
+
+                        return true;
+                    });
+                    double height    = sqrt(radius * radius - 0.3 * 0.3 - 0.2 * 0.2);
+                    double sag       = radius * (1. - cos(Pi / 32.));
+
+                    if (differentFaces > 0)
+                        std::cerr << differentFaces << " faces differ in the mapped view";
+                    else if (!traversed || (distances.size() != 2))
+                        std::cerr << "The ray hit the mapped sphere " << distances.size() << " times";
+                    else if ((fabs(distances[0] - (2. * radius - height)) > sag) || (fabs(distances[1] - (2. * radius + height)) > sag))
+                        std::cerr << "The hits on the mapped sphere are at the wrong distances";
+                    else if (mapped->ReadFailed() || (mapped->WorkingSetSize() != 4096))
+                        std::cerr << "The mapped sphere couldn't be read within its working set";
+                    else
+                        ret = 0;
+
+                    mapped->Destroy();
+                }
+                else
+                    std::cerr << "The sphere couldn't be mapped";
+            }
+            else
+                std::cerr << "The sphere couldn't be added to the database";
+        }
+        else if (strcmp(argv[1], "compress") == 0) {
+            const double           maxError = 0.01;
+            BRLCAD::MemoryDatabase lossless;
+            BRLCAD::MemoryDatabase lossy;
+            BRLCAD::BagOfTriangles sphere;
+
+            CreateSphere(sphere, 10., 64, 32);
+            sphere.ComputeVertexNormals(60. * Pi / 180.);
+            sphere.SetName("sphere.bot");
+
+            if (lossless.Add(sphere) && lossy.Add(sphere)) {
+                double pointDeviation  = 0.;
+                double normalDeviation = 0.;
+
+                if (lossless.CompressBagsOfTriangles(0.) != 1)
+                    std::cerr << "The sphere wasn't compressed losslessly";
+                else if (lossless.CompressBagsOfTriangles(0.) != 0)
+                    std::cerr << "The sphere was compressed twice";
+                else if (!Deviations(lossless, "sphere.bot", sphere, pointDeviation, normalDeviation) || (pointDeviation != 0.) || (normalDeviation != 0.))
+                    std::cerr << "The lossless compression changed the sphere";
+                else if (lossless.MapBagOfTriangles("sphere.bot", 4096) != nullptr)
+                    std::cerr << "The compressed sphere was mapped";
+                else if (lossy.CompressBagsOfTriangles(maxError) != 1)
+                    std::cerr << "The sphere wasn't compressed lossy";
+                else if (!Deviations(lossy, "sphere.bot", sphere, pointDeviation, normalDeviation) || (pointDeviation > maxError) || (normalDeviation > 1e-3))
+                    std::cerr << "The lossy compression moved the vertices by " << pointDeviation << " and the normals by " << normalDeviation;
+                else {
+                    // the decompressed geometry is the decoded one
+                    BRLCAD::BagOfTriangles decoded;
+                    BRLCAD::Object*        object = lossy.Get("sphere.bot");
+
+                    if (object != nullptr) {
+                        BRLCAD::BagOfTriangles* bot = dynamic_cast<BRLCAD::BagOfTriangles*>(object);
+
+                        if (bot != nullptr)
+                            decoded = *bot;
+
+                        object->Destroy();
+                    }
+
+                    lossy.DecompressBagsOfTriangles();
+
+                    BRLCAD::MappedBagOfTriangles* mapped = lossy.MapBagOfTriangles("sphere.bot", 4096);
+
+                    if (!Deviations(lossy, "sphere.bot", decoded, pointDeviation, normalDeviation) || (pointDeviation != 0.) || (normalDeviation != 0.))
+                        std::cerr << "The decompression changed the sphere";
+                    else if (mapped == nullptr)
+                        std::cerr << "The decompressed sphere couldn't be mapped";
+                    else
+                        ret = 0;
+
+                    if (mapped != nullptr)
+                        mapped->Destroy();
+                }
+            }
+            else
+                std::cerr << "The sphere couldn't be added to the databases";
+        }
+        else
+            std::cerr << "Unknown test type: " << argv[1];
+    }
+
+    return ret;
+}
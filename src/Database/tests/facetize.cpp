@@ -0,0 +1,638 @@
+/*
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+ * SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER
+ * RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ * CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <array>
+#include <map>
+#include <string>
+#include <vector>
+#include <iostream>
+
+#include <brlcad/Database/MemoryDatabase.h>
+#include <brlcad/Database/Arb8.h>
+#include <brlcad/Database/Ellipsoid.h>
+#include <brlcad/Database/Combination.h>
+#include <brlcad/Database/BagOfTriangles.h>
+#include <brlcad/Database/NonManifoldGeometry.h>
+
+
+static const double Pi = 3.14159265358979323846;
+
+
+static bool CreateModel
+(
+    BRLCAD::MemoryDatabase& database
+) {
+    bool ret = true;
+
+    BRLCAD::Arb8 box(BRLCAD::Vector3D(-10., -10., -10.), BRLCAD::Vector3D(10., 10., 10.));
+    box.SetName("box.s");
+    ret = ret && database.Add(box);
+
+    BRLCAD::Ellipsoid ball(BRLCAD::Vector3D(10., 10., 10.), 8.);
+    ball.SetName("ball.s");
+    ret = ret && database.Add(ball);
+
+    BRLCAD::Ellipsoid hole(BRLCAD::Vector3D(0., 0., 0.), BRLCAD::Vector3D(0., 0., 15.), 4.);
+    hole.SetName("hole.s");
+    ret = ret && database.Add(hole);
+
+    BRLCAD::Ellipsoid satellite(BRLCAD::Vector3D(25., 0., 0.), 6.);
+    satellite.SetName("satellite.s");
+    ret = ret && database.Add(satellite);
+
+    // (box u ball) - hole
+    BRLCAD::Combination body;
+    body.SetName("body.r");
+    body.SetIsRegion(true);
+    body.AddLeaf("box.s");
+    body.AddLeaf("ball.s");
+    body.Tree().Apply(BRLCAD::Combination::ConstTreeNode::Operator::Subtraction, "hole.s");
+    ret = ret && database.Add(body);
+
+    // satellite + box, i.e. the intersection with an instance of a solid of the other region
+    BRLCAD::Combination cap;
+    cap.SetName("cap.r");
+    cap.SetIsRegion(true);
+    cap.AddLeaf("satellite.s");
+    cap.Tree().Apply(BRLCAD::Combination::ConstTreeNode::Operator::Intersection, "box.s");
+    ret = ret && database.Add(cap);
+
+    BRLCAD::Combination all;
+    all.SetName("all.c");
+    all.AddLeaf("body.r");
+    all.AddLeaf("cap.r");
+    ret = ret && database.Add(all);
+
+    return ret;
+}
+
+
+/// the number of vertices and faces of a non-manifold geometry facetization of \a objectName
+/** \return false if the facetization failed or is empty */
+static bool FacetizationSize
+(
+    const BRLCAD::ConstDatabase& database,
+    const char*                  objectName,
+    size_t&                      numberOfVertices,
+    size_t&                      numberOfFaces
+) {
+    bool                         ret = false;
+    BRLCAD::NonManifoldGeometry* nmg = database.Facetize(objectName);
+
+    numberOfVertices = 0;
+    numberOfFaces    = 0;
+
+    if (nmg != nullptr) {
+        BRLCAD::NonManifoldGeometry::IndexedFaces faces;
+
+        nmg->Flatten(faces, false);
+        numberOfVertices = faces.NumberOfVertices();
+        numberOfFaces    = faces.NumberOfFaces();
+        ret              = (numberOfFaces > 0);
+
+        nmg->Destroy();
+    }
+
+    return ret;
+}
+
+
+/// the enclosed volume of \a bot if it's closed and every edge is used once in each direction
+/** \return -1 if \a bot isn't a closed and consistently oriented mesh */
+static double ClosedVolume
+(
+    BRLCAD::BagOfTriangles& bot
+) {
+    typedef std::array<double, 3>   Point;
+    typedef std::pair<Point, Point> Edge;
+
+    double              volume = 0.;
+    std::map<Edge, int> edges;
+
+    for (size_t i = 0; i < bot.NumberOfFaces(); ++i) {
+        BRLCAD::BagOfTriangles::Face face = bot.GetFace(i);
+        Point                        points[3];
+
+        for (size_t j = 0; j < 3; ++j)
+            points[j] = {face.Point(j).coordinates[0], face.Point(j).coordinates[1], face.Point(j).coordinates[2]};
+
+        // the edges of the neighbors have to cancel these ones
+        for (size_t j = 0; j < 3; ++j) {
+            ++edges[Edge(points[j], points[(j + 1) % 3])];
+            --edges[Edge(points[(j + 1) % 3], points[j])];
+        }
+
+        // the signed volume of the tetrahedron with the origin
+        volume += (points[0][0] * (points[1][1] * points[2][2] - points[1][2] * points[2][1]) -
+                   points[0][1] * (points[1][0] * points[2][2] - points[1][2] * points[2][0]) +
+                   points[0][2] * (points[1][0] * points[2][1] - points[1][1] * points[2][0])) / 6.;
+    }
+
+    if (bot.Orientation() == BRLCAD::BagOfTriangles::BotOrientation::ClockWise)
+        volume = -volume;
+
+    double ret = volume;
+
+    for (std::map<Edge, int>::const_iterator it = edges.begin(); it != edges.end(); ++it) {
+        if (it->second != 0)
+            ret = -1.;
+    }
+
+    return ret;
+}
+
+
+/// the largest x coordinate of the vertices of \a bot
+static double MaximumX
+(
+    BRLCAD::BagOfTriangles& bot
+) {
+    double ret = -INFINITY;
+
+    for (size_t i = 0; i < bot.NumberOfFaces(); ++i) {
+        BRLCAD::BagOfTriangles::Face face = bot.GetFace(i);
+
+        for (size_t j = 0; j < 3; ++j)
+            ret = std::max(ret, face.Point(j).coordinates[0]);
+    }
+
+    return ret;
+}
+
+
+/// exports the facetization of \a objectName in \a format to \a data
+static bool ExportToMemory
+(
+    const BRLCAD::ConstDatabase&      database,
+    const char*                       objectName,
+    BRLCAD::ConstDatabase::MeshFormat format,
+    std::vector<unsigned char>&       data
+) {
+    data.clear();
+
+    return database.ExportFacetization(objectName, format, [&data](size_t position, const void* bytes, size_t size) {
+        if (data.size() < position + size)
+            data.resize(position + size);
+
+        memcpy(data.data() + position, bytes, size);
+
+        return true;
+    });
+}
+
+
+/// the number of triangles of a binary STL file in \a data and their enclosed volume
+/** \return false if the size of \a data doesn't match the number of triangles in its header */
+static bool StlTriangles
+(
+    const std::vector<unsigned char>& data,
+    size_t&                           numberOfTriangles,
+    double&                           volume
+) {
+    bool ret = false;
+
+    numberOfTriangles = 0;
+    volume            = 0.;
+
+    if (data.size() >= 84) {
+        // little-endian
+        for (size_t i = 0; i < 4; ++i)
+            numberOfTriangles |= static_cast<size_t>(data[80 + i]) << (8 * i);
+
+        ret = (data.size() == 84 + 50 * numberOfTriangles);
+    }
+
+    for (size_t i = 0; ret && (i < numberOfTriangles); ++i) {
+        float corners[9];
+
+        // behind the normal
+        memcpy(corners, data.data() + 84 + 50 * i + 12, sizeof(corners));
+
+        volume += (corners[0] * (corners[4] * corners[8] - corners[5] * corners[7]) -
+                   corners[1] * (corners[3] * corners[8] - corners[5] * corners[6]) +
+                   corners[2] * (corners[3] * corners[7] - corners[4] * corners[6])) / 6.;
+    }
+
+    return ret;
+}
+
+
+static bool EqualFacetizations
+(
+    BRLCAD::BagOfTriangles& serial,
+    BRLCAD::BagOfTriangles& parallel
+) {
+    bool ret = (serial.NumberOfFaces() > 0) && (serial.NumberOfFaces() == parallel.NumberOfFaces());
+
+    for (size_t i = 0; ret && (i < serial.NumberOfFaces()); ++i) {
+        BRLCAD::BagOfTriangles::Face serialFace   = serial.GetFace(i);
+        BRLCAD::BagOfTriangles::Face parallelFace = parallel.GetFace(i);
+
+        for (size_t j = 0; ret && (j < 3); ++j) {
+            BRLCAD::Vector3D serialPoint   = serialFace.Point(j);
+            BRLCAD::Vector3D parallelPoint = parallelFace.Point(j);
+
+            for (size_t k = 0; ret && (k < 3); ++k)
+                ret = (fabs(serialPoint.coordinates[k] - parallelPoint.coordinates[k]) < 1e-6);
+        }
+    }
+
+    return ret;
+}
+
+
+int main
+(
+    int   argc,
+    char* argv[]
+) {
+    int ret = 1;
+
+    if ((argc < 2) || (argv[1] == nullptr))
+        std::cerr << "Usage: " << argv[0] << " <test type>";
+    else {
+        if (strcmp(argv[1], "default") == 0) {
+            BRLCAD::MemoryDatabase database;
+
+            if (CreateModel(database)) {
+                BRLCAD::BagOfTriangles* facetization = database.FacetizeToBot("all.c");
+
+                if (facetization != nullptr) {
+                    // the box and the ball of body.r, cap.r is empty
+                    double minimum = INFINITY;
+                    double maximum = -INFINITY;
+
+                    for (size_t i = 0; i < facetization->NumberOfFaces(); ++i) {
+                        BRLCAD::BagOfTriangles::Face face = facetization->GetFace(i);
+
+                        for (size_t j = 0; j < 3; ++j) {
+                            minimum = std::min(minimum, face.Point(j).coordinates[0]);
+                            maximum = std::max(maximum, face.Point(j).coordinates[0]);
+                        }
+                    }
+
+                    if ((fabs(minimum + 10.) < 1e-6) && (maximum > 16.) && (maximum < 18. + 1e-6))
+                        ret = 0;
+                    else
+                        std::cerr << "The facetization misses a part of the model";
+
+                    facetization->Destroy();
+                }
+                else
+                    std::cerr << "Could not facetize the model";
+            }
+            else
+                std::cerr << "Could not create the model";
+        }
+        else if (strcmp(argv[1], "parallelNmg") == 0) {
+            BRLCAD::MemoryDatabase database;
+
+            if (CreateModel(database)) {
+                // serial is the default
+                if (!database.ParallelNonManifoldGeometry()) {
+                    BRLCAD::BagOfTriangles* serial = database.FacetizeToBot("all.c");
+
+                    database.SetParallelNonManifoldGeometry(true);
+
+                    BRLCAD::BagOfTriangles* parallel = database.FacetizeToBot("all.c");
+
+                    if ((serial != nullptr) && (parallel != nullptr)) {
+                        if (EqualFacetizations(*serial, *parallel))
+                            ret = 0;
+                        else
+                            std::cerr << "The parallel facetization differs from the serial one";
+                    }
+                    else
+                        std::cerr << "Could not facetize the model";
+
+                    if (serial != nullptr)
+                        serial->Destroy();
+
+                    if (parallel != nullptr)
+                        parallel->Destroy();
+                }
+                else
+                    std::cerr << "Non-manifold geometry is processed in parallel by default";
+            }
+            else
+                std::cerr << "Could not create the model";
+        }
+        else if (strcmp(argv[1], "parallelFacetize") == 0) {
+            BRLCAD::MemoryDatabase database;
+
+            if (CreateModel(database)) {
+                size_t serialVertices   = 0;
+                size_t serialFaces      = 0;
+                size_t parallelVertices = 0;
+                size_t parallelFaces    = 0;
+                bool   serial           = FacetizationSize(database, "all.c", serialVertices, serialFaces);
+
+                database.SetParallelNonManifoldGeometry(true);
+
+                bool   parallel         = FacetizationSize(database, "all.c", parallelVertices, parallelFaces);
+
+                if (!serial || !parallel)
+                    std::cerr << "Could not facetize the model";
+                else if ((serialVertices != parallelVertices) || (serialFaces != parallelFaces))
+                    std::cerr << "The parallel facetization has " << parallelFaces << " faces, the serial one " << serialFaces;
+                else
+                    ret = 0;
+            }
+            else
+                std::cerr << "Could not create the model";
+        }
+        else if (strcmp(argv[1], "toBot") == 0) {
+            BRLCAD::MemoryDatabase database;
+
+            if (CreateModel(database)) {
+                BRLCAD::BagOfTriangles* facetization = database.FacetizeToBot("all.c");
+
+                if (facetization != nullptr) {
+                    // box + 7/8 of the ball outside of it - the part of the hole inside of the box, cap.r is empty
+                    double expected = 20. * 20. * 20. + 7. / 8. * 4. / 3. * Pi * 8. * 8. * 8. - Pi * 4. * 4. * (20. - 2. * 10. * 10. * 10. / (3. * 15. * 15.));
+                    double volume   = ClosedVolume(*facetization);
+
+                    facetization->SetName("all.bot");
+
+                    if (volume < 0.)
+                        std::cerr << "The facetization isn't a closed and oriented mesh";
+                    else if (fabs(volume - expected) > 0.05 * expected)
+                        std::cerr << "The facetization has the volume " << volume << " instead of " << expected;
+                    else if (!database.Add(*facetization))
+                        std::cerr << "Could not add the facetization to the database";
+                    else {
+                        BRLCAD::Object*         object = database.Get("all.bot");
+                        BRLCAD::BagOfTriangles* stored = dynamic_cast<BRLCAD::BagOfTriangles*>(object);
+
+                        if ((stored != nullptr) && (stored->NumberOfFaces() == facetization->NumberOfFaces()))
+                            ret = 0;
+                        else
+                            std::cerr << "The facetization wasn't stored in the database";
+
+                        if (object != nullptr)
+                            object->Destroy();
+                    }
+
+                    facetization->Destroy();
+                }
+                else
+                    std::cerr << "Could not facetize the model";
+            }
+            else
+                std::cerr << "Could not create the model";
+        }
+        else if (strcmp(argv[1], "cache") == 0) {
+            BRLCAD::MemoryDatabase database;
+
+            if (CreateModel(database)) {
+                database.EnableFacetizationCache(nullptr, 64 << 20);
+
+                BRLCAD::BagOfTriangles* first  = database.FacetizeToBot("all.c");
+                BRLCAD::BagOfTriangles* cached = database.FacetizeToBot("all.c");
+
+                // a smaller ball invalidates the cached facetization
+                BRLCAD::Ellipsoid ball(BRLCAD::Vector3D(10., 10., 10.), 6.);
+                ball.SetName("ball.s");
+
+                bool                    changed  = database.Set(ball);
+                BRLCAD::BagOfTriangles* modified = database.FacetizeToBot("all.c");
+
+                if ((first == nullptr) || (cached == nullptr) || (modified == nullptr))
+                    std::cerr << "Could not facetize the model";
+                else if (!EqualFacetizations(*first, *cached))
+                    std::cerr << "The cached facetization differs from the first one";
+                else if (!changed)
+                    std::cerr << "Could not change the model";
+                else if ((MaximumX(*first) < 17.) || (MaximumX(*modified) > 16. + 1e-6))
+                    std::cerr << "The facetization of the changed model was taken from the cache";
+                else
+                    ret = 0;
+
+                if (first != nullptr)
+                    first->Destroy();
+
+                if (cached != nullptr)
+                    cached->Destroy();
+
+                if (modified != nullptr)
+                    modified->Destroy();
+            }
+            else
+                std::cerr << "Could not create the model";
+        }
+        else if (strcmp(argv[1], "instances") == 0) {
+            // a row of disjoint regions which are instances of the same ellipsoid
+            const size_t           numberOfInstances = 8;
+            BRLCAD::MemoryDatabase database;
+            BRLCAD::Ellipsoid      ball(BRLCAD::Vector3D(0., 0., 0.), 5.);
+            BRLCAD::Combination    row;
+
+            ball.SetName("ball.s");
+            row.SetName("row.c");
+
+            bool created = database.Add(ball);
+
+            for (size_t i = 0; created && (i < numberOfInstances); ++i) {
+                std::string         instanceName    = "instance" + std::to_string(i) + ".r";
+                BRLCAD::Combination instance;
+                double              translation[16] = {1., 0., 0., 20. * i,
+                                                       0., 1., 0., 0.,
+                                                       0., 0., 1., 0.,
+                                                       0., 0., 0., 1.};
+
+                instance.SetName(instanceName.c_str());
+                instance.SetIsRegion(true);
+                instance.AddLeaf("ball.s");
+                instance.Tree().SetMatrix(translation);
+                created = database.Add(instance);
+                row.AddLeaf(instanceName.c_str());
+            }
+
+            created = created && database.Add(row);
+
+            if (created) {
+                BRLCAD::BagOfTriangles* single    = database.FacetizeToBot("instance0.r");
+                BRLCAD::BagOfTriangles* instances = database.FacetizeToBot("row.c");
+
+                if ((single == nullptr) || (instances == nullptr) || (single->NumberOfFaces() == 0))
+                    std::cerr << "Could not facetize the instances";
+                else if (instances->NumberOfFaces() != numberOfInstances * single->NumberOfFaces())
+                    std::cerr << "The instances got different tessellations";
+                else if (fabs((MaximumX(*instances) - MaximumX(*single)) - 20. * (numberOfInstances - 1)) > 1e-6)
+                    std::cerr << "The instances weren't transformed";
+                else
+                    ret = 0;
+
+                if (single != nullptr)
+                    single->Destroy();
+
+                if (instances != nullptr)
+                    instances->Destroy();
+            }
+            else
+                std::cerr << "Could not create the instances";
+        }
+        else if (strcmp(argv[1], "manifold") == 0) {
+            BRLCAD::MemoryDatabase database;
+
+            if (CreateModel(database)) {
+                BRLCAD::BagOfTriangles* nonManifold = database.FacetizeToBot("all.c");
+
+                if (nonManifold == nullptr)
+                    std::cerr << "Could not facetize the model";
+                else if (database.FacetizeBooleanBackend() != BRLCAD::ConstDatabase::BooleanBackend::NonManifold)
+                    std::cerr << "The manifold backend is selected by default";
+                else if (!database.SetFacetizeBooleanBackend(BRLCAD::ConstDatabase::BooleanBackend::Manifold)) {
+                    // not available in this build
+                    if (database.FacetizeBooleanBackend() == BRLCAD::ConstDatabase::BooleanBackend::NonManifold)
+                        ret = 0;
+                    else
+                        std::cerr << "The unavailable manifold backend was selected";
+                }
+                else {
+                    BRLCAD::BagOfTriangles* manifold          = database.FacetizeToBot("all.c");
+                    double                  nonManifoldVolume = ClosedVolume(*nonManifold);
+
+                    if (manifold == nullptr)
+                        std::cerr << "Could not facetize the model with the manifold backend";
+                    else if (ClosedVolume(*manifold) < 0.)
+                        std::cerr << "The manifold facetization isn't a closed and oriented mesh";
+                    else if (fabs(ClosedVolume(*manifold) - nonManifoldVolume) > 0.01 * nonManifoldVolume)
+                        std::cerr << "The volumes of the facetizations differ by more than 1 %";
+                    else if (!database.SetFacetizeBooleanBackend(BRLCAD::ConstDatabase::BooleanBackend::NonManifold))
+                        std::cerr << "Could not select the non-manifold backend again";
+                    else
+                        ret = 0;
+
+                    if (manifold != nullptr)
+                        manifold->Destroy();
+                }
+
+                if (nonManifold != nullptr)
+                    nonManifold->Destroy();
+            }
+            else
+                std::cerr << "Could not create the model";
+        }
+        else if (strcmp(argv[1], "levels") == 0) {
+            BRLCAD::MemoryDatabase database;
+
+            if (CreateModel(database)) {
+                const size_t                                   NumberOfLevels          = 3;
+                const BRLCAD::ConstDatabase::FacetizeTolerance levels[NumberOfLevels]  = {{0., 0.005, 0.}, {0., 0.02, 0.}, {0., 0.1, 0.}};
+                BRLCAD::NonManifoldGeometry*                   results[NumberOfLevels];
+                size_t                                         faces[NumberOfLevels]   = {0, 0, 0};
+                size_t                                         regions[NumberOfLevels] = {0, 0, 0};
+
+                database.FacetizeLevelsOfDetail("all.c", NumberOfLevels, levels, results);
+
+                for (size_t i = 0; i < NumberOfLevels; ++i) {
+                    if (results[i] != nullptr) {
+                        BRLCAD::NonManifoldGeometry::IndexedFaces indexedFaces;
+
+                        results[i]->Flatten(indexedFaces, true);
+                        faces[i]   = indexedFaces.NumberOfFaces();
+                        regions[i] = indexedFaces.NumberOfRegions();
+                        results[i]->Destroy();
+                    }
+                }
+
+                if ((faces[0] == 0) || (faces[1] == 0) || (faces[2] == 0))
+                    std::cerr << "Could not facetize all levels of the model";
+                else if ((regions[0] != regions[1]) || (regions[0] != regions[2]))
+                    std::cerr << "The levels have different regions";
+                else if ((faces[1] > faces[0]) || (faces[2] > faces[1]) || !(faces[2] < faces[0]))
+                    std::cerr << "The coarser levels don't have less faces: " << faces[0] << ", " << faces[1] << ", " << faces[2];
+                else
+                    ret = 0;
+            }
+            else
+                std::cerr << "Could not create the model";
+        }
+        else if (strcmp(argv[1], "export") == 0) {
+            BRLCAD::MemoryDatabase database;
+
+            if (CreateModel(database)) {
+                // the box and 7/8 of the ball without the part of the hole inside of the box
+                double                     expected          = 20. * 20. * 20. + 7. / 8. * 4. / 3. * Pi * 8. * 8. * 8. - Pi * 4. * 4. * (20. - 2. * 10. * 10. * 10. / (3. * 15. * 15.));
+                std::vector<unsigned char> stl;
+                std::vector<unsigned char> ply;
+                std::vector<unsigned char> obj;
+                std::vector<unsigned char> parallelStl;
+                size_t                     numberOfTriangles = 0;
+                size_t                     parallelTriangles = 0;
+                double                     volume            = 0.;
+                double                     parallelVolume    = 0.;
+                bool                       exported          = ExportToMemory(database, "body.r", BRLCAD::ConstDatabase::MeshFormat::BinaryStl, stl) &&
+                                                               ExportToMemory(database, "body.r", BRLCAD::ConstDatabase::MeshFormat::BinaryPly, ply) &&
+                                                               ExportToMemory(database, "body.r", BRLCAD::ConstDatabase::MeshFormat::Obj, obj);
+
+                // serial is the default
+                database.SetParallelNonManifoldGeometry(true);
+                exported = exported && ExportToMemory(database, "body.r", BRLCAD::ConstDatabase::MeshFormat::BinaryStl, parallelStl);
+
+                bool   failingSink = database.ExportFacetization("body.r", BRLCAD::ConstDatabase::MeshFormat::BinaryStl, [](size_t, const void*, size_t) {
+                    return false;
+                });
+                bool   stlValid    = StlTriangles(stl, numberOfTriangles, volume);
+                char   plyFaces[64];
+                size_t objFaces    = 0;
+                bool   objRegion   = false;
+                size_t lineBegin   = 0;
+
+                snprintf(plyFaces, sizeof(plyFaces), "element face %010llu\n", static_cast<unsigned long long>(numberOfTriangles));
+
+                for (size_t i = 0; i < obj.size(); ++i) {
+                    if (obj[i] == '\n') {
+                        std::string line(obj.begin() + lineBegin, obj.begin() + i);
+
+                        if (line.compare(0, 2, "f ") == 0)
+                            ++objFaces;
+                        else if (line == "o body.r")
+                            objRegion = true;
+
+                        lineBegin = i + 1;
+                    }
+                }
+
+                if (!exported)
+                    std::cerr << "Could not export the facetization";
+                else if (!stlValid || (numberOfTriangles == 0))
+                    std::cerr << "The size of the STL data doesn't match the number of triangles in its header";
+                else if (fabs(volume - expected) > 0.05 * expected)
+                    std::cerr << "The STL triangles enclose the volume " << volume << " instead of " << expected;
+                else if (std::string(ply.begin(), ply.end()).find(plyFaces) == std::string::npos)
+                    std::cerr << "The PLY header doesn't give the number of triangles";
+                else if (!objRegion || (objFaces != numberOfTriangles))
+                    std::cerr << "The OBJ text has " << objFaces << " faces instead of " << numberOfTriangles;
+                else if (!StlTriangles(parallelStl, parallelTriangles, parallelVolume) || (parallelTriangles != numberOfTriangles))
+                    std::cerr << "The parallel export differs from the serial one";
+                else if (failingSink)
+                    std::cerr << "The failure of the sink wasn't reported";
+                else
+                    ret = 0;
+            }
+            else
+                std::cerr << "Could not create the model";
+        }
+        else
+            std::cerr << "Unknown test type: " << argv[1];
+    }
+
+    return ret;
+}
@@ -0,0 +1,259 @@
+/*
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+ * SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER
+ * RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ * CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+#include <cmath>
+#include <cstring>
+#include <vector>
+#include <iostream>
+
+#include <brlcad/Database/MemoryDatabase.h>
+#include <brlcad/Database/Arb8.h>
+#include <brlcad/Database/Cone.h>
+#include <brlcad/Database/Combination.h>
+#include <brlcad/Database/NonManifoldGeometry.h>
+
+
+/// a box with a cylindrical hole, i.e. with faces with holes
+static bool CreateModel
+(
+    BRLCAD::MemoryDatabase& database
+) {
+    bool ret = true;
+
+    BRLCAD::Arb8 box(BRLCAD::Vector3D(-10., -10., -10.), BRLCAD::Vector3D(10., 10., 10.));
+    box.SetName("box.s");
+    ret = ret && database.Add(box);
+
+    BRLCAD::Cone drill(BRLCAD::Vector3D(0., 0., -20.), BRLCAD::Vector3D(0., 0., 40.), 4.);
+    drill.SetName("drill.s");
+    ret = ret && database.Add(drill);
+
+    BRLCAD::Combination part;
+    part.SetName("part.r");
+    part.SetIsRegion(true);
+    part.AddLeaf("box.s");
+    part.Tree().Apply(BRLCAD::Combination::ConstTreeNode::Operator::Subtraction, "drill.s");
+    ret = ret && database.Add(part);
+
+    return ret;
+}
+
+
+/// checks that the offsets and indices of \a faces stay within their arrays
+static bool ConsistentIndices
+(
+    const BRLCAD::NonManifoldGeometry::IndexedFaces& faces
+) {
+    bool ret = (faces.NumberOfFaces() > 0) && (faces.FaceLoopOffsets()[0] == 0) && (faces.FaceLoopOffsets()[faces.NumberOfFaces()] == faces.NumberOfLoops()) &&
+               (faces.LoopOffsets()[0] == 0);
+
+    for (size_t i = 0; ret && (i < faces.NumberOfLoops()); ++i) {
+        ret = (faces.LoopOffsets()[i + 1] >= faces.LoopOffsets()[i] + 3);
+
+        for (size_t j = faces.LoopOffsets()[i]; ret && (j < faces.LoopOffsets()[i + 1]); ++j)
+            ret = (faces.LoopVertices()[j] < faces.NumberOfVertices());
+    }
+
+    for (size_t i = 0; ret && (i < faces.NumberOfFaces()); ++i) {
+        const double* normal = faces.FaceNormals() + 3 * i;
+
+        ret = (faces.FaceLoopOffsets()[i + 1] > faces.FaceLoopOffsets()[i]) && (faces.FaceShells()[i] < faces.NumberOfShells()) &&
+              (fabs(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2] - 1.) < 1e-6);
+    }
+
+    for (size_t i = 0; ret && (i < faces.NumberOfShells()); ++i)
+        ret = (faces.ShellRegions()[i] < faces.NumberOfRegions());
+
+    return ret;
+}
+
+
+/// the area of the faces of \a faces
+/** The area of a loop is signed by the normal of its face, i.e. the holes are subtracted if they run clockwise. */
+static double Area
+(
+    const BRLCAD::NonManifoldGeometry::IndexedFaces& faces
+) {
+    double ret = 0.;
+
+    for (size_t i = 0; i < faces.NumberOfFaces(); ++i) {
+        const double* normal = faces.FaceNormals() + 3 * i;
+
+        for (size_t j = faces.FaceLoopOffsets()[i]; j < faces.FaceLoopOffsets()[i + 1]; ++j) {
+            double newell[3] = {0., 0., 0.};
+
+            for (size_t k = faces.LoopOffsets()[j]; k < faces.LoopOffsets()[j + 1]; ++k) {
+                size_t        next = (k + 1 < faces.LoopOffsets()[j + 1]) ? k + 1 : faces.LoopOffsets()[j];
+                const double* a    = faces.Vertices() + 3 * faces.LoopVertices()[k];
+                const double* b    = faces.Vertices() + 3 * faces.LoopVertices()[next];
+
+                newell[0] += a[1] * b[2] - a[2] * b[1];
+                newell[1] += a[2] * b[0] - a[0] * b[2];
+                newell[2] += a[0] * b[1] - a[1] * b[0];
+            }
+
+            ret += (newell[0] * normal[0] + newell[1] * normal[1] + newell[2] * normal[2]) / 2.;
+        }
+    }
+
+    return ret;
+}
+
+
+/// checks that the faces of \a faces point away from \a center
+static bool Outward
+(
+    const BRLCAD::NonManifoldGeometry::IndexedFaces& faces,
+    const double                                     center[3]
+) {
+    bool ret = true;
+
+    for (size_t i = 0; ret && (i < faces.NumberOfFaces()); ++i) {
+        const double* normal = faces.FaceNormals() + 3 * i;
+        size_t        loop   = faces.FaceLoopOffsets()[i];
+        const double* a      = faces.Vertices() + 3 * faces.LoopVertices()[faces.LoopOffsets()[loop]];
+
+        ret = ((a[0] - center[0]) * normal[0] + (a[1] - center[1]) * normal[1] + (a[2] - center[2]) * normal[2] > 0.);
+    }
+
+    return ret;
+}
+
+
+int main
+(
+    int   argc,
+    char* argv[]
+) {
+    int ret = 1;
+
+    if ((argc < 2) || (argv[1] == nullptr))
+        std::cerr << "Usage: " << argv[0] << " <test type>";
+    else {
+        if (strcmp(argv[1], "flatten") == 0) {
+            BRLCAD::MemoryDatabase database;
+
+            if (CreateModel(database)) {
+                BRLCAD::NonManifoldGeometry* part = database.Facetize("part.r");
+
+                if (part != nullptr) {
+                    BRLCAD::NonManifoldGeometry::IndexedFaces polygons;
+                    BRLCAD::NonManifoldGeometry::IndexedFaces triangles;
+                    bool                                      holes = false;
+                    bool                                      split = true;
+
+                    part->Flatten(polygons, false);
+                    part->Flatten(triangles, true, database.DistanceTolerance());
+
+                    for (size_t i = 0; i < polygons.NumberOfLoops(); ++i)
+                        holes = holes || (polygons.LoopIsHole()[i] != 0);
+
+                    for (size_t i = 0; i < triangles.NumberOfLoops(); ++i)
+                        split = split && (triangles.LoopIsHole()[i] == 0) && (triangles.LoopOffsets()[i + 1] - triangles.LoopOffsets()[i] == 3);
+
+                    double polygonArea  = Area(polygons);
+                    double triangleArea = Area(triangles);
+
+                    // the triangulation is done on a copy
+                    BRLCAD::NonManifoldGeometry::IndexedFaces again;
+
+                    part->Flatten(again, false);
+
+                    if (!ConsistentIndices(polygons) || !ConsistentIndices(triangles))
+                        std::cerr << "The flattened faces have inconsistent indices";
+                    else if ((polygons.NumberOfRegions() != 1) || (polygons.NumberOfShells() != 1))
+                        std::cerr << "The part was flattened into " << polygons.NumberOfRegions() << " regions and " << polygons.NumberOfShells() << " shells";
+                    else if (!holes)
+                        std::cerr << "The flattened faces have no holes";
+                    else if (!split)
+                        std::cerr << "Not all flattened faces were triangulated";
+                    else if ((polygonArea <= 2400.) || (fabs(triangleArea - polygonArea) > 1e-6 * polygonArea))
+                        std::cerr << "The triangulated area " << triangleArea << " differs from the polygonal one " << polygonArea;
+                    else if ((again.NumberOfLoops() != polygons.NumberOfLoops()) || (again.NumberOfVertices() != polygons.NumberOfVertices()))
+                        std::cerr << "The triangulation changed the part";
+                    else
+                        ret = 0;
+
+                    part->Destroy();
+                }
+                else
+                    std::cerr << "Could not facetize the model";
+            }
+            else
+                std::cerr << "Could not create the model";
+        }
+        else if (strcmp(argv[1], "addPolygons") == 0) {
+            const double vertices[]            = {0., 0., 0., 1., 0., 0., 1., 1., 0., 0., 1., 0., 0., 0., 1., 1., 0., 1., 1., 1., 1., 0., 1., 1.};
+            const double center[3]             = {0.5, 0.5, 0.5};
+            const size_t polygonOffsets[]      = {0, 4, 8, 12, 16, 20, 24};
+            const size_t polygonVertices[]     = {0, 3, 2, 1, 4, 5, 6, 7, 0, 1, 5, 4, 1, 2, 6, 5, 2, 3, 7, 6, 3, 0, 4, 7};
+            const size_t invalidVertices[]     = {0, 3, 2, 1, 4, 5, 6, 8, 0, 1, 5, 4, 1, 2, 6, 5, 2, 3, 7, 6, 3, 0, 4, 7};
+            const size_t degeneratedOffsets[]  = {0, 3, 6};
+            const size_t degeneratedVertices[] = {0, 1, 1, 4, 4, 4};
+
+            BRLCAD::NonManifoldGeometry               cube;
+            BRLCAD::NonManifoldGeometry::IndexedFaces cubeFaces;
+
+            bool built = cube.AddPolygons(8, vertices, 6, polygonOffsets, polygonVertices);
+
+            cube.Flatten(cubeFaces, false);
+
+            // rebuilds the cube from its flattened faces, they have no holes
+            BRLCAD::NonManifoldGeometry               copy;
+            BRLCAD::NonManifoldGeometry::IndexedFaces copyFaces;
+            std::vector<size_t>                       copyOffsets;
+
+            for (size_t i = 0; i < cubeFaces.NumberOfFaces(); ++i)
+                copyOffsets.push_back(cubeFaces.LoopOffsets()[cubeFaces.FaceLoopOffsets()[i]]);
+
+            copyOffsets.push_back(cubeFaces.LoopOffsets()[cubeFaces.NumberOfLoops()]);
+
+            bool rebuilt = copy.AddPolygons(cubeFaces.NumberOfVertices(), cubeFaces.Vertices(), cubeFaces.NumberOfFaces(), copyOffsets.data(), cubeFaces.LoopVertices());
+
+            copy.Flatten(copyFaces, false);
+
+            // rejected input leaves the geometries unchanged
+            BRLCAD::NonManifoldGeometry               invalid;
+            BRLCAD::NonManifoldGeometry::IndexedFaces invalidFaces;
+            BRLCAD::NonManifoldGeometry::IndexedFaces unchangedFaces;
+
+            bool invalidAccepted     = invalid.AddPolygons(8, vertices, 6, polygonOffsets, invalidVertices);
+            bool degeneratedAccepted = invalid.AddPolygons(8, vertices, 2, degeneratedOffsets, degeneratedVertices) ||
+                                       cube.AddPolygons(8, vertices, 6, polygonOffsets, invalidVertices) ||
+                                       cube.AddPolygons(8, vertices, 2, degeneratedOffsets, degeneratedVertices);
+
+            invalid.Flatten(invalidFaces, false);
+            cube.Flatten(unchangedFaces, false);
+
+            if (!built)
+                std::cerr << "Could not build the cube";
+            else if ((cubeFaces.NumberOfVertices() != 8) || (cubeFaces.NumberOfFaces() != 6) || (cubeFaces.NumberOfLoops() != 6) || (cubeFaces.NumberOfRegions() != 1))
+                std::cerr << "The cube isn't connected as expected";
+            else if (!ConsistentIndices(cubeFaces) || (fabs(Area(cubeFaces) - 6.) > 1e-6) || !Outward(cubeFaces, center))
+                std::cerr << "The faces of the cube aren't oriented as expected";
+            else if (!rebuilt || (copyFaces.NumberOfVertices() != 8) || (copyFaces.NumberOfFaces() != 6) || (fabs(Area(copyFaces) - 6.) > 1e-6) || !Outward(copyFaces, center))
+                std::cerr << "The cube couldn't be rebuilt from its flattened faces";
+            else if (invalidAccepted || degeneratedAccepted)
+                std::cerr << "An invalid vertex index or degenerated polygons were accepted";
+            else if ((invalidFaces.NumberOfFaces() != 0) || (unchangedFaces.NumberOfFaces() != 6) || (unchangedFaces.NumberOfRegions() != 1))
+                std::cerr << "The rejected polygons changed the geometry";
+            else
+                ret = 0;
+        }
+        else
+            std::cerr << "Unknown test type: " << argv[1];
+    }
+
+    return ret;
+}
@@ -0,0 +1,390 @@
+/*
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+ * SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER
+ * RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ * CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+#include <algorithm>
+#include <iostream>
+
+#include <brlcad/Database/MemoryDatabase.h>
+#include <brlcad/Database/Ellipsoid.h>
+#include <brlcad/Database/BagOfTriangles.h>
+#include <brlcad/Database/NonManifoldGeometry.h>
+#include <brlcad/Database/Sketch.h>
+#include <brlcad/Database/Combination.h>
+#include <brlcad/CommandString/CommandString.h>
+
+
+/// solids of different primitives, they are read in parallel but plotted serially
+static const char* Solids[] = {"ell.s", "bot.s", "nmg.s", "sketch.s", "extrude.s", "brep.s"};
+
+
+static bool RunCommand
+(
+    BRLCAD::CommandString& commandString,
+    std::vector<const char*> arguments
+) {
+    bool ret = (commandString.Parse(arguments.size(), arguments.data()) == BRLCAD::CommandString::State::Success);
+
+    if (!ret)
+        std::cerr << "Command failed: " << arguments[0] << ' ' << commandString.Results() << std::endl;
+
+    return ret;
+}
+
+
+static bool CreateModel
+(
+    BRLCAD::MemoryDatabase& database
+) {
+    bool ret = true;
+
+    BRLCAD::Ellipsoid ellipsoid(BRLCAD::Vector3D(0., 0., 0.), 5.);
+    ellipsoid.SetName("ell.s");
+    ret = ret && database.Add(ellipsoid);
+
+    BRLCAD::BagOfTriangles bot;
+    BRLCAD::Vector3D       tetrahedron[4] = {BRLCAD::Vector3D(10., 0., 0.), BRLCAD::Vector3D(20., 0., 0.), BRLCAD::Vector3D(10., 10., 0.), BRLCAD::Vector3D(10., 0., 10.)};
+    bot.AddFace(tetrahedron[0], tetrahedron[2], tetrahedron[1]);
+    bot.AddFace(tetrahedron[0], tetrahedron[1], tetrahedron[3]);
+    bot.AddFace(tetrahedron[0], tetrahedron[3], tetrahedron[2]);
+    bot.AddFace(tetrahedron[1], tetrahedron[2], tetrahedron[3]);
+    bot.SetName("bot.s");
+    ret = ret && database.Add(bot);
+
+    BRLCAD::NonManifoldGeometry nmg;
+    const double                cubeVertices[]  = {-20., 0., 0., -10., 0., 0., -10., 10., 0., -20., 10., 0., -20., 0., 10., -10., 0., 10., -10., 10., 10., -20., 10., 10.};
+    const size_t                cubeOffsets[]   = {0, 4, 8, 12, 16, 20, 24};
+    const size_t                cubePolygons[]  = {0, 3, 2, 1, 4, 5, 6, 7, 0, 1, 5, 4, 1, 2, 6, 5, 2, 3, 7, 6, 3, 0, 4, 7};
+    ret = ret && nmg.AddPolygons(8, cubeVertices, 6, cubeOffsets, cubePolygons);
+    nmg.SetName("nmg.s");
+    ret = ret && database.Add(nmg);
+
+    BRLCAD::Sketch   sketch;
+    BRLCAD::Vector3D origin(0., 20., 0.);
+    BRLCAD::Vector3D u(1., 0., 0.);
+    BRLCAD::Vector3D v(0., 1., 0.);
+    sketch.SetEmbeddingPlaneOrigin(origin);
+    sketch.SetEmbeddingPlaneX(u);
+    sketch.SetEmbeddingPlaneY(v);
+
+    const BRLCAD::Vector2D square[4] = {BRLCAD::Vector2D(0., 0.), BRLCAD::Vector2D(5., 0.), BRLCAD::Vector2D(5., 5.), BRLCAD::Vector2D(0., 5.)};
+
+    for (size_t i = 0; i < 4; ++i) {
+        BRLCAD::Sketch::Line* line = sketch.AppendLine();
+
+        line->SetStartPoint(square[i]);
+        line->SetEndPoint(square[(i + 1) % 4]);
+    }
+
+    sketch.SetName("sketch.s");
+    ret = ret && database.Add(sketch);
+
+    if (ret) {
+        // there are no classes for these primitives
+        BRLCAD::CommandString commandString(database);
+
+        ret = RunCommand(commandString, {"put", "extrude.s", "extrude", "V", "0 20 0", "H", "0 0 10", "A", "1 0 0", "B", "0 1 0", "S", "sketch.s", "K", "0"}) &&
+              RunCommand(commandString, {"brep", "ell.s", "brep.s"});
+    }
+
+    BRLCAD::Combination mixed;
+    mixed.SetName("mixed.c");
+
+    for (size_t i = 0; i < sizeof(Solids) / sizeof(Solids[0]); ++i)
+        mixed.AddLeaf(Solids[i]);
+
+    ret = ret && database.Add(mixed);
+
+    return ret;
+}
+
+
+/// the elements of a vector list as sortable tuples of their type and values
+static std::vector<std::vector<double> > Elements
+(
+    const BRLCAD::VectorList& vectorList
+) {
+    std::vector<std::vector<double> >  ret;
+    BRLCAD::VectorList::ElementArrays arrays;
+
+    vectorList.Export(arrays);
+
+    for (size_t i = 0; i < arrays.NumberOfElements(); ++i) {
+        const double* values = arrays.Values() + 3 * i;
+
+        ret.push_back({static_cast<double>(arrays.ElementTypes()[i]), values[0], values[1], values[2]});
+    }
+
+    return ret;
+}
+
+
+/// the sorted elements of the plots of \a solids
+static std::vector<std::vector<double> > SolidElements
+(
+    BRLCAD::MemoryDatabase&         database,
+    const std::vector<const char*>& solids
+) {
+    std::vector<std::vector<double> > ret;
+
+    for (size_t i = 0; i < solids.size(); ++i) {
+        BRLCAD::VectorList                solidPlot;
+        std::vector<std::vector<double> > solidElements;
+
+        database.Plot(solids[i], solidPlot);
+        solidElements = Elements(solidPlot);
+
+        if (solidElements.empty())
+            std::cerr << "Empty plot of " << solids[i] << std::endl;
+
+        ret.insert(ret.end(), solidElements.begin(), solidElements.end());
+    }
+
+    std::sort(ret.begin(), ret.end());
+
+    return ret;
+}
+
+
+/// the sorted elements of the plot of \a objectName in an orthographic view of the cube [-size, size]^3 on 1000 x 1000 pixels
+static std::vector<std::vector<double> > ViewElements
+(
+    BRLCAD::MemoryDatabase& database,
+    const char*             objectName,
+    double                  size,
+    double                  pixelTolerance
+) {
+    const double       viewMatrix[16] = {1. / size, 0., 0., 0., 0., 1. / size, 0., 0., 0., 0., 1. / size, 0., 0., 0., 0., 1.};
+    BRLCAD::VectorList viewPlot;
+
+    database.Plot(objectName, viewMatrix, 1000, 1000, pixelTolerance, viewPlot);
+
+    std::vector<std::vector<double> > ret = Elements(viewPlot);
+
+    std::sort(ret.begin(), ret.end());
+
+    return ret;
+}
+
+
+/// the sorted solid names and properties of the shaded meshes of \a objectName: color, red, number of vertices and triangles
+/** \return false if a triangle has an invalid vertex index */
+static bool ShadedMeshes
+(
+    const BRLCAD::MemoryDatabase&                               database,
+    const char*                                                 objectName,
+    std::vector<std::pair<std::string, std::vector<double> > >& meshes
+) {
+    bool ret = true;
+
+    meshes.clear();
+
+    database.PlotShaded(objectName, [&ret, &meshes](const BRLCAD::ConstDatabase::ShadedMesh& mesh) {
+        for (size_t i = 0; i < 3 * mesh.numberOfTriangles; ++i) {
+            if (mesh.triangles[i] >= mesh.numberOfVertices)
+                ret = false;
+        }
+
+        meshes.push_back({mesh.solidName, {mesh.hasColor ? 1. : 0., mesh.red, static_cast<double>(mesh.numberOfVertices), static_cast<double>(mesh.numberOfTriangles)}});
+    });
+
+    std::sort(meshes.begin(), meshes.end());
+
+    return ret;
+}
+
+
+int main
+(
+    int   argc,
+    char* argv[]
+) {
+    int ret = 1;
+
+    if ((argc < 2) || (argv[1] == nullptr))
+        std::cerr << "Usage: " << argv[0] << " <test type>";
+    else {
+        if (strcmp(argv[1], "mixed") == 0) {
+            BRLCAD::MemoryDatabase database;
+
+            if (CreateModel(database)) {
+                // a single solid is plotted serially
+                std::vector<std::vector<double> > serial = SolidElements(database, std::vector<const char*>(Solids, Solids + sizeof(Solids) / sizeof(Solids[0])));
+                BRLCAD::VectorList                mixedPlot;
+                std::vector<std::vector<double> > mixed;
+
+                database.Plot("mixed.c", mixedPlot);
+                mixed = Elements(mixedPlot);
+                std::sort(mixed.begin(), mixed.end());
+
+                if (!serial.empty() && (mixed == serial))
+                    ret = 0;
+                else
+                    std::cerr << "The plot of the tree differs from the plots of its solids";
+            }
+            else
+                std::cerr << "Could not create the model";
+        }
+        else if (strcmp(argv[1], "culled") == 0) {
+            BRLCAD::MemoryDatabase database;
+
+            if (CreateModel(database)) {
+                // only the ellipsoid and its brep copy are in the small view
+                std::vector<std::vector<double> > all    = SolidElements(database, std::vector<const char*>(Solids, Solids + sizeof(Solids) / sizeof(Solids[0])));
+                std::vector<std::vector<double> > center = SolidElements(database, {"ell.s", "brep.s"});
+
+                // the bounding boxes are unknown at the first plot, and the combination's box is known at the second one
+                if (ViewElements(database, "mixed.c", 6., 0.) != center)
+                    std::cerr << "The first plot of the small view differs from the plots of its solids";
+                else if (ViewElements(database, "mixed.c", 6., 0.) != center)
+                    std::cerr << "The second plot of the small view differs from the plots of its solids";
+                else if (ViewElements(database, "mixed.c", 100., 0.) != all)
+                    std::cerr << "The plot of the large view differs from the plots of all solids";
+                else if (ViewElements(database, "bot.s", 6., 0.).empty())
+                    ret = 0;
+                else
+                    std::cerr << "The solid outside of the view was plotted";
+            }
+            else
+                std::cerr << "Could not create the model";
+        }
+        else if (strcmp(argv[1], "repeated") == 0) {
+            BRLCAD::MemoryDatabase database;
+
+            if (CreateModel(database)) {
+                // the order of the elements mustn't depend on the threads which read the solids
+                BRLCAD::VectorList firstPlot;
+                BRLCAD::VectorList secondPlot;
+
+                database.Plot("mixed.c", firstPlot);
+                database.Plot("mixed.c", secondPlot);
+
+                std::vector<std::vector<double> > first  = Elements(firstPlot);
+                std::vector<std::vector<double> > second = Elements(secondPlot);
+
+                if (!first.empty() && (second == first))
+                    ret = 0;
+                else
+                    std::cerr << "The plots of the tree differ";
+            }
+            else
+                std::cerr << "Could not create the model";
+        }
+        else if (strcmp(argv[1], "cache") == 0) {
+            BRLCAD::MemoryDatabase database;
+
+            if (CreateModel(database)) {
+                database.EnablePlotCache(64 << 20);
+
+                BRLCAD::VectorList firstPlot;
+                BRLCAD::VectorList cachedPlot;
+
+                database.Plot("mixed.c", firstPlot);
+                database.Plot("mixed.c", cachedPlot);
+
+                // a larger ellipsoid invalidates its cached wireframe
+                BRLCAD::Ellipsoid ellipsoid(BRLCAD::Vector3D(0., 0., 0.), 6.);
+                ellipsoid.SetName("ell.s");
+
+                bool               modified = database.Set(ellipsoid);
+                BRLCAD::VectorList changedPlot;
+                BRLCAD::VectorList uncachedPlot;
+
+                database.Plot("mixed.c", changedPlot);
+                database.DisablePlotCache();
+                database.Plot("mixed.c", uncachedPlot);
+
+                std::vector<std::vector<double> > first   = Elements(firstPlot);
+                std::vector<std::vector<double> > changed = Elements(changedPlot);
+
+                if (first.empty() || (Elements(cachedPlot) != first))
+                    std::cerr << "The cached plot differs from the first one";
+                else if (!modified)
+                    std::cerr << "Could not change the model";
+                else if ((changed == first) || (changed != Elements(uncachedPlot)))
+                    std::cerr << "The plot of the changed model was taken from the cache";
+                else
+                    ret = 0;
+            }
+            else
+                std::cerr << "Could not create the model";
+        }
+        else if (strcmp(argv[1], "coarse") == 0) {
+            BRLCAD::MemoryDatabase database;
+
+            if (CreateModel(database)) {
+                // the ellipsoid is 10 pixels large in the view, and its tessellation has to follow the pixel tolerance
+                std::vector<std::vector<double> > fine   = ViewElements(database, "ell.s", 500., 0.);
+                std::vector<std::vector<double> > coarse = ViewElements(database, "ell.s", 500., 2.);
+
+                if (fine.empty() || coarse.empty())
+                    std::cerr << "The ellipsoid wasn't plotted";
+                else if (!(coarse.size() < fine.size()))
+                    std::cerr << "The plot with a pixel tolerance has " << coarse.size() << " elements, the one without " << fine.size();
+                else
+                    ret = 0;
+            }
+            else
+                std::cerr << "Could not create the model";
+        }
+        else if (strcmp(argv[1], "shaded") == 0) {
+            BRLCAD::MemoryDatabase database;
+
+            if (CreateModel(database)) {
+                // the ellipsoid is subtracted, the booleans aren't evaluated
+                BRLCAD::Combination shaded;
+                shaded.SetName("shaded.c");
+                shaded.AddLeaf("bot.s");
+                shaded.AddLeaf("nmg.s");
+                shaded.Tree().Apply(BRLCAD::Combination::ConstTreeNode::Operator::Subtraction, "ell.s");
+                shaded.SetHasColor(true);
+                shaded.SetRed(1.);
+
+                std::vector<std::pair<std::string, std::vector<double> > > serial;
+                std::vector<std::pair<std::string, std::vector<double> > > parallel;
+
+                if (!database.Add(shaded))
+                    std::cerr << "Could not add the combination";
+                else if (!ShadedMeshes(database, "shaded.c", serial))
+                    std::cerr << "A mesh has an invalid vertex index";
+                else if ((serial.size() != 2) || (serial[0].first != "bot.s") || (serial[1].first != "nmg.s"))
+                    std::cerr << "There are " << serial.size() << " meshes instead of the ones of the added solids";
+                else if ((serial[0].second[0] != 1.) || (serial[0].second[1] != 1.) || (serial[1].second[0] != 1.) || (serial[1].second[1] != 1.))
+                    std::cerr << "The meshes don't have the color of the combination";
+                else if ((serial[0].second[3] != 4.) || (serial[1].second[3] < 12.))
+                    std::cerr << "The tetrahedron has " << serial[0].second[3] << " triangles, the cube " << serial[1].second[3];
+                else {
+                    // the tessellation with non-manifold geometry runs serially by default
+                    database.SetParallelNonManifoldGeometry(true);
+
+                    if (!ShadedMeshes(database, "shaded.c", parallel) || (parallel != serial))
+                        std::cerr << "The parallel tessellation differs from the serial one";
+                    else
+                        ret = 0;
+
+                    database.SetParallelNonManifoldGeometry(false);
+                }
+            }
+            else
+                std::cerr << "Could not create the model";
+        }
+        else
+            std::cerr << "Unknown test type: " << argv[1];
+    }
+
+    return ret;
+}
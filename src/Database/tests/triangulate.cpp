@@ -0,0 +1,225 @@
+/*
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+ * SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER
+ * RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ * CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <algorithm>
+#include <utility>
+#include <iostream>
+
+#include <brlcad/Database/MemoryDatabase.h>
+#include <brlcad/Database/Arb8.h>
+#include <brlcad/Database/Cone.h>
+#include <brlcad/Database/Combination.h>
+#include <brlcad/Database/NonManifoldGeometry.h>
+
+
+/// a box with a cylindrical hole, i.e. with faces with holes whose edges are shared with the wall of the hole
+static bool CreateModel
+(
+    BRLCAD::MemoryDatabase& database
+) {
+    bool ret = true;
+
+    BRLCAD::Arb8 box(BRLCAD::Vector3D(-10., -10., -10.), BRLCAD::Vector3D(10., 10., 10.));
+    box.SetName("box.s");
+    ret = ret && database.Add(box);
+
+    BRLCAD::Cone drill(BRLCAD::Vector3D(0., 0., -20.), BRLCAD::Vector3D(0., 0., 40.), 4.);
+    drill.SetName("drill.s");
+    ret = ret && database.Add(drill);
+
+    BRLCAD::Combination part;
+    part.SetName("part.r");
+    part.SetIsRegion(true);
+    part.AddLeaf("box.s");
+    part.Tree().Apply(BRLCAD::Combination::ConstTreeNode::Operator::Subtraction, "drill.s");
+    ret = ret && database.Add(part);
+
+    return ret;
+}
+
+
+static bool HasHoles
+(
+    const BRLCAD::NonManifoldGeometry& geometry
+) {
+    bool                                      ret = false;
+    BRLCAD::NonManifoldGeometry::IndexedFaces faces;
+
+    geometry.Flatten(faces, false);
+
+    for (size_t i = 0; i < faces.NumberOfLoops(); ++i)
+        ret = ret || (faces.LoopIsHole()[i] != 0);
+
+    return ret;
+}
+
+
+/// properties of a triangulation which have to be independent of the algorithm
+struct TriangulationSummary {
+    bool   triangles;    ///< all loops are triangles without holes
+    double area;
+    size_t openEdges;    ///< edges which aren't shared by exactly two triangles
+};
+
+
+static TriangulationSummary Summarize
+(
+    const BRLCAD::NonManifoldGeometry& geometry
+) {
+    TriangulationSummary                      ret = {true, 0., 0};
+    BRLCAD::NonManifoldGeometry::IndexedFaces faces;
+    std::map<std::pair<size_t, size_t>, int>  edgeUses;
+
+    geometry.Flatten(faces, false);
+
+    for (size_t i = 0; i < faces.NumberOfLoops(); ++i) {
+        const size_t* loop = faces.LoopVertices() + faces.LoopOffsets()[i];
+
+        if ((faces.LoopOffsets()[i + 1] - faces.LoopOffsets()[i] != 3) || (faces.LoopIsHole()[i] != 0))
+            ret.triangles = false;
+        else {
+            const double* a = faces.Vertices() + 3 * loop[0];
+            const double* b = faces.Vertices() + 3 * loop[1];
+            const double* c = faces.Vertices() + 3 * loop[2];
+            double        u[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+            double        v[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+            double        n[3] = {u[1] * v[2] - u[2] * v[1], u[2] * v[0] - u[0] * v[2], u[0] * v[1] - u[1] * v[0]};
+
+            ret.area += sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]) / 2.;
+
+            for (size_t j = 0; j < 3; ++j) {
+                size_t from = loop[j];
+                size_t to   = loop[(j + 1) % 3];
+
+                ++edgeUses[std::make_pair(std::min(from, to), std::max(from, to))];
+            }
+        }
+    }
+
+    for (auto edge = edgeUses.begin(); edge != edgeUses.end(); ++edge) {
+        if (edge->second != 2)
+            ++ret.openEdges;
+    }
+
+    return ret;
+}
+
+
+int main
+(
+    int   argc,
+    char* argv[]
+) {
+    int ret = 1;
+
+    if ((argc < 2) || (argv[1] == nullptr))
+        std::cerr << "Usage: " << argv[0] << " <test type>";
+    else {
+        if (strcmp(argv[1], "holes") == 0) {
+            BRLCAD::MemoryDatabase database;
+
+            if (CreateModel(database)) {
+                BRLCAD::NonManifoldGeometry* inPlace = database.Facetize("part.r");
+                BRLCAD::NonManifoldGeometry* serial  = database.Facetize("part.r");
+                BRLCAD::NonManifoldGeometry* copied  = database.Facetize("part.r");
+
+                if ((inPlace != nullptr) && (serial != nullptr) && (copied != nullptr)) {
+                    if (HasHoles(*copied)) {
+                        inPlace->Triangulate();
+                        serial->Triangulate(database.DistanceTolerance());
+                        copied->Triangulate(database.DistanceTolerance(), true);
+
+                        TriangulationSummary inPlaceSummary = Summarize(*inPlace);
+                        TriangulationSummary serialSummary  = Summarize(*serial);
+                        TriangulationSummary copiedSummary  = Summarize(*copied);
+
+                        if (!inPlaceSummary.triangles || !serialSummary.triangles || !copiedSummary.triangles)
+                            std::cerr << "Not all faces were triangulated";
+                        else if ((fabs(inPlaceSummary.area - serialSummary.area) > 1e-6 * inPlaceSummary.area) ||
+                                 (fabs(inPlaceSummary.area - copiedSummary.area) > 1e-6 * inPlaceSummary.area))
+                            std::cerr << "The triangulations have different areas";
+                        else if (copiedSummary.openEdges > inPlaceSummary.openEdges)
+                            std::cerr << "The triangles aren't connected along the shared edges";
+                        else
+                            ret = 0;
+                    }
+                    else
+                        std::cerr << "The facetization has no faces with holes";
+                }
+                else
+                    std::cerr << "Could not facetize the model";
+
+                if (inPlace != nullptr)
+                    inPlace->Destroy();
+
+                if (serial != nullptr)
+                    serial->Destroy();
+
+                if (copied != nullptr)
+                    copied->Destroy();
+            }
+            else
+                std::cerr << "Could not create the model";
+        }
+        else if (strcmp(argv[1], "stored") == 0) {
+            BRLCAD::MemoryDatabase database;
+
+            if (CreateModel(database)) {
+                BRLCAD::NonManifoldGeometry* part   = database.Facetize("part.r");
+                bool                         stored = false;
+
+                if (part != nullptr) {
+                    part->SetName("part.nmg");
+                    stored = database.Add(*part);
+                    part->Destroy();
+                }
+
+                if (stored) {
+                    // triangulates the object in the database
+                    double distanceTolerance = database.DistanceTolerance();
+                    bool   found             = database.Get("part.nmg", [distanceTolerance](BRLCAD::Object& object) {
+                        BRLCAD::NonManifoldGeometry* nmg = dynamic_cast<BRLCAD::NonManifoldGeometry*>(&object);
+
+                        if (nmg != nullptr)
+                            nmg->Triangulate(distanceTolerance);
+                    });
+
+                    BRLCAD::Object*              object = database.Get("part.nmg");
+                    BRLCAD::NonManifoldGeometry* nmg    = dynamic_cast<BRLCAD::NonManifoldGeometry*>(object);
+
+                    if (!found || (nmg == nullptr))
+                        std::cerr << "The facetization wasn't stored in the database";
+                    else if (!Summarize(*nmg).triangles)
+                        std::cerr << "The triangulation wasn't written to the database";
+                    else
+                        ret = 0;
+
+                    if (object != nullptr)
+                        object->Destroy();
+                }
+                else
+                    std::cerr << "Could not store the facetization of the model";
+            }
+            else
+                std::cerr << "Could not create the model";
+        }
+        else
+            std::cerr << "Unknown test type: " << argv[1];
+    }
+
+    return ret;
+}
@@ -0,0 +1,498 @@
+/*
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+ * SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER
+ * RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ * CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <functional>
+#include <vector>
+#include <thread>
+#include <iostream>
+
+#include <brlcad/VectorList.h>
+
+
+typedef BRLCAD::VectorList::Element::ElementType ElementType;
+
+
+/// a point, a polyline, a triangle and a quadrilateral in model space and a line in display space
+static const ElementType ListTypes[] = {ElementType::PointSize, ElementType::PointDraw,
+                                        ElementType::LineWidth, ElementType::LineMove, ElementType::LineDraw, ElementType::LineDraw,
+                                        ElementType::TriangleStart, ElementType::TriangleMove, ElementType::TriangleDraw, ElementType::TriangleDraw, ElementType::TriangleEnd,
+                                        ElementType::PolygonStart, ElementType::PolygonMove, ElementType::PolygonDraw, ElementType::PolygonDraw, ElementType::PolygonDraw, ElementType::PolygonEnd,
+                                        ElementType::DisplaySpace, ElementType::LineMove, ElementType::LineDraw, ElementType::ModelSpace};
+
+
+static bool CreateList
+(
+    BRLCAD::VectorList& vectorList
+) {
+    bool ret = true;
+
+    ret = ret && vectorList.Append(BRLCAD::VectorList::PointSize(3.));
+    ret = ret && vectorList.Append(BRLCAD::VectorList::PointDraw(BRLCAD::Vector3D(0., 0., 0.)));
+
+    ret = ret && vectorList.Append(BRLCAD::VectorList::LineWidth(2.));
+    ret = ret && vectorList.Append(BRLCAD::VectorList::LineMove(BRLCAD::Vector3D(0., 0., 0.)));
+    ret = ret && vectorList.Append(BRLCAD::VectorList::LineDraw(BRLCAD::Vector3D(1., 0., 0.)));
+    ret = ret && vectorList.Append(BRLCAD::VectorList::LineDraw(BRLCAD::Vector3D(1., 1., 0.)));
+
+    ret = ret && vectorList.Append(BRLCAD::VectorList::TriangleStart(BRLCAD::Vector3D(0., 0., 1.)));
+    ret = ret && vectorList.Append(BRLCAD::VectorList::TriangleMove(BRLCAD::Vector3D(0., 0., 0.)));
+    ret = ret && vectorList.Append(BRLCAD::VectorList::TriangleDraw(BRLCAD::Vector3D(1., 0., 0.)));
+    ret = ret && vectorList.Append(BRLCAD::VectorList::TriangleDraw(BRLCAD::Vector3D(1., 1., 0.)));
+    ret = ret && vectorList.Append(BRLCAD::VectorList::TriangleEnd(BRLCAD::Vector3D(0., 0., 0.)));
+
+    ret = ret && vectorList.Append(BRLCAD::VectorList::PolygonStart(BRLCAD::Vector3D(0., 0., 1.)));
+    ret = ret && vectorList.Append(BRLCAD::VectorList::PolygonMove(BRLCAD::Vector3D(0., 0., 1.)));
+    ret = ret && vectorList.Append(BRLCAD::VectorList::PolygonDraw(BRLCAD::Vector3D(1., 0., 1.)));
+    ret = ret && vectorList.Append(BRLCAD::VectorList::PolygonDraw(BRLCAD::Vector3D(1., 1., 1.)));
+    ret = ret && vectorList.Append(BRLCAD::VectorList::PolygonDraw(BRLCAD::Vector3D(0., 1., 1.)));
+    ret = ret && vectorList.Append(BRLCAD::VectorList::PolygonEnd(BRLCAD::Vector3D(0., 0., 1.)));
+
+    ret = ret && vectorList.Append(BRLCAD::VectorList::DisplaySpace(BRLCAD::Vector3D(0., 0., 0.)));
+    ret = ret && vectorList.Append(BRLCAD::VectorList::LineMove(BRLCAD::Vector3D(5., 5., 5.)));
+    ret = ret && vectorList.Append(BRLCAD::VectorList::LineDraw(BRLCAD::Vector3D(6., 6., 6.)));
+    ret = ret && vectorList.Append(BRLCAD::VectorList::ModelSpace());
+
+    return ret;
+}
+
+
+/// the largest difference of the values of two vector lists with the same element types
+/** \return -1 if the element types differ */
+static double MaximumDeviation
+(
+    const BRLCAD::VectorList& vectorList,
+    const BRLCAD::VectorList& other
+) {
+    double                            ret = -1.;
+    BRLCAD::VectorList::ElementArrays arrays;
+    BRLCAD::VectorList::ElementArrays otherArrays;
+
+    vectorList.Export(arrays);
+    other.Export(otherArrays);
+
+    if ((arrays.NumberOfElements() == otherArrays.NumberOfElements()) &&
+        std::equal(arrays.ElementTypes(), arrays.ElementTypes() + arrays.NumberOfElements(), otherArrays.ElementTypes())) {
+        ret = 0.;
+
+        for (size_t i = 0; i < 3 * arrays.NumberOfElements(); ++i)
+            ret = std::max(ret, fabs(arrays.Values()[i] - otherArrays.Values()[i]));
+    }
+
+    return ret;
+}
+
+
+/// copies the file \a fileName to \a copyName with the byte at \a offset replaced by \a value
+static bool CorruptedCopy
+(
+    const char*   fileName,
+    const char*   copyName,
+    size_t        offset,
+    unsigned char value
+) {
+    bool                       ret  = false;
+    FILE*                      file = fopen(fileName, "rb");
+    std::vector<unsigned char> content;
+
+    if (file != nullptr) {
+        unsigned char buffer[1024];
+        size_t        count;
+
+        while ((count = fread(buffer, 1, sizeof(buffer), file)) > 0)
+            content.insert(content.end(), buffer, buffer + count);
+
+        fclose(file);
+    }
+
+    if (content.size() > offset) {
+        content[offset] = value;
+        file            = fopen(copyName, "wb");
+
+        if (file != nullptr) {
+            ret = (fwrite(content.data(), 1, content.size(), file) == content.size());
+            ret = (fclose(file) == 0) && ret;
+        }
+    }
+
+    return ret;
+}
+
+
+/// appends \a numberOfCircles circles of 360 segments in the plane \a z to \a vectorList
+static void FillCircles
+(
+    BRLCAD::VectorList& vectorList,
+    size_t              numberOfCircles,
+    double              z
+) {
+    std::vector<double> circle;
+
+    for (size_t i = 0; i <= 360; ++i) {
+        double angle = i * 3.14159265358979323846 / 180.;
+
+        circle.insert(circle.end(), {cos(angle), sin(angle), z});
+    }
+
+    for (size_t i = 0; i < numberOfCircles; ++i)
+        vectorList.AppendPolyline(circle.size() / 3, circle.data());
+}
+
+
+/// the types of the elements of \a vectorList by Iterate()
+static std::vector<ElementType> IteratedTypes
+(
+    const BRLCAD::VectorList& vectorList
+) {
+    std::vector<ElementType> ret;
+
+    vectorList.Iterate([&ret](const BRLCAD::VectorList::Element* element) {
+        ret.push_back(element->Type());
+
+        return true;
+    });
+
+    return ret;
+}
+
+
+/// records the types of the visited elements and stops after \a limit elements
+class TypeRecorder {
+public:
+    std::vector<ElementType> types;
+    double                   pointSize;
+    double                   lineWidth;
+
+    TypeRecorder(size_t limit) : pointSize(0.), lineWidth(0.), m_limit(limit) {}
+
+    bool PointDraw(const double*)            {return Record(ElementType::PointDraw);}
+    bool LineMove(const double*)             {return Record(ElementType::LineMove);}
+    bool LineDraw(const double*)             {return Record(ElementType::LineDraw);}
+    bool TriangleMove(const double*)         {return Record(ElementType::TriangleMove);}
+    bool TriangleDraw(const double*)         {return Record(ElementType::TriangleDraw);}
+    bool TriangleEnd(const double*)          {return Record(ElementType::TriangleEnd);}
+    bool PolygonMove(const double*)          {return Record(ElementType::PolygonMove);}
+    bool PolygonDraw(const double*)          {return Record(ElementType::PolygonDraw);}
+    bool PolygonEnd(const double*)           {return Record(ElementType::PolygonEnd);}
+    bool TriangleStart(const double*)        {return Record(ElementType::TriangleStart);}
+    bool TriangleVertexNormal(const double*) {return Record(ElementType::TriangleVertexNormal);}
+    bool PolygonStart(const double*)         {return Record(ElementType::PolygonStart);}
+    bool PolygonVertexNormal(const double*)  {return Record(ElementType::PolygonVertexNormal);}
+    bool PointSize(double size)              {pointSize = size; return Record(ElementType::PointSize);}
+    bool LineWidth(double width)             {lineWidth = width; return Record(ElementType::LineWidth);}
+    bool DisplaySpace(const double*)         {return Record(ElementType::DisplaySpace);}
+    bool ModelSpace(void)                    {return Record(ElementType::ModelSpace);}
+
+private:
+    size_t m_limit;
+
+    bool Record(ElementType type) {
+        types.push_back(type);
+
+        return (types.size() < m_limit);
+    }
+};
+
+
+/// checks that the \a count indices at \a indices refer to vertices
+static bool ValidIndices
+(
+    size_t        count,
+    const size_t* indices,
+    size_t        numberOfVertices
+) {
+    bool ret = true;
+
+    for (size_t i = 0; ret && (i < count); ++i)
+        ret = (indices[i] < numberOfVertices);
+
+    return ret;
+}
+
+
+int main
+(
+    int   argc,
+    char* argv[]
+) {
+    int ret = 1;
+
+    if ((argc < 2) || (argv[1] == nullptr))
+        std::cerr << "Usage: " << argv[0] << " <test type>";
+    else {
+        const std::vector<ElementType> listTypes(ListTypes, ListTypes + sizeof(ListTypes) / sizeof(ListTypes[0]));
+
+        if (strcmp(argv[1], "exportArrays") == 0) {
+            BRLCAD::VectorList vectorList;
+
+            if (CreateList(vectorList)) {
+                BRLCAD::VectorList::ElementArrays     elements;
+                BRLCAD::VectorList::IndexedPrimitives primitives;
+
+                vectorList.Export(elements);
+                vectorList.Export(primitives);
+
+                std::vector<ElementType> exportedTypes(elements.ElementTypes(), elements.ElementTypes() + elements.NumberOfElements());
+
+                // the polyline, the triangle and the quadrilateral share the vertices at z = 0 and z = 1 respectively, the line in display space is omitted
+                if ((exportedTypes != listTypes) || (IteratedTypes(vectorList) != listTypes))
+                    std::cerr << "The element arrays have other types than the vector list";
+                else if ((elements.Values()[0] != 3.) || (elements.Values()[3 * 2] != 2.) || (elements.Values()[3 * 14] != 1.) || (elements.Values()[3 * 14 + 1] != 1.))
+                    std::cerr << "The element arrays have other values than the vector list";
+                else if ((primitives.NumberOfVertices() != 7) || (primitives.NumberOfPoints() != 1) || (primitives.NumberOfLines() != 2) || (primitives.NumberOfTriangles() != 3))
+                    std::cerr << "The vector list was converted into " << primitives.NumberOfVertices() << " vertices, " << primitives.NumberOfPoints() << " points, "
+                              << primitives.NumberOfLines() << " lines and " << primitives.NumberOfTriangles() << " triangles";
+                else if (!ValidIndices(primitives.NumberOfPoints(), primitives.PointIndices(), primitives.NumberOfVertices()) ||
+                         !ValidIndices(2 * primitives.NumberOfLines(), primitives.LineIndices(), primitives.NumberOfVertices()) ||
+                         !ValidIndices(3 * primitives.NumberOfTriangles(), primitives.TriangleIndices(), primitives.NumberOfVertices()))
+                    std::cerr << "A primitive has an invalid vertex index";
+                else
+                    ret = 0;
+            }
+            else
+                std::cerr << "Could not create the vector list";
+        }
+        else if (strcmp(argv[1], "visit") == 0) {
+            BRLCAD::VectorList vectorList;
+
+            if (CreateList(vectorList)) {
+                TypeRecorder all(listTypes.size() + 1);
+                TypeRecorder first(5);
+
+                vectorList.Visit(all);
+                vectorList.Visit(first);
+
+                if (all.types != listTypes)
+                    std::cerr << "The visitor saw " << all.types.size() << " elements of other types than the vector list";
+                else if ((all.pointSize != 3.) || (all.lineWidth != 2.))
+                    std::cerr << "The visitor got other sizes than the vector list";
+                else if (first.types != std::vector<ElementType>(listTypes.begin(), listTypes.begin() + 5))
+                    std::cerr << "The visit didn't stop after the visitor returned false";
+                else
+                    ret = 0;
+            }
+            else
+                std::cerr << "Could not create the vector list";
+        }
+        else if (strcmp(argv[1], "bulkAppend") == 0) {
+            const double       points[]    = {0., 0., -1., 1., 0., -1., 2., 0., -1.};
+            const double       polyline[]  = {0., 0., 0., 1., 0., 0., 1., 1., 0., 0., 1., 0.};
+            const double       triangles[] = {0., 0., 0., 1., 0., 0., 1., 1., 0., 0., 0., 0., 1., 1., 0., 0., 1., 0.};
+            BRLCAD::VectorList vectorList;
+
+            // a triangle gives its start with the normal, the move to the first, the draws to the other vertices and the end
+            std::vector<ElementType> bulkTypes = {ElementType::PointDraw, ElementType::PointDraw, ElementType::PointDraw,
+                                                  ElementType::LineMove, ElementType::LineDraw, ElementType::LineDraw, ElementType::LineDraw};
+
+            for (size_t i = 0; i < 2; ++i)
+                bulkTypes.insert(bulkTypes.end(), {ElementType::TriangleStart, ElementType::TriangleMove, ElementType::TriangleDraw, ElementType::TriangleDraw, ElementType::TriangleEnd});
+
+            vectorList.Reserve(bulkTypes.size());
+
+            if (vectorList.AppendPoints(3, points) && vectorList.AppendPolyline(4, polyline) && vectorList.AppendTriangles(2, triangles)) {
+                BRLCAD::VectorList::ElementArrays arrays;
+
+                vectorList.Export(arrays);
+
+                std::vector<ElementType> appendedTypes(arrays.ElementTypes(), arrays.ElementTypes() + arrays.NumberOfElements());
+                const double*            values = arrays.Values();
+
+                if (appendedTypes != bulkTypes)
+                    std::cerr << "The " << appendedTypes.size() << " elements aren't in the order of the appends";
+                else if ((values[3 * 2] != 2.) || (values[3 * 6 + 1] != 1.) || (values[3 * 14 + 1] != 1.) || (values[3 * 16] != 0.))
+                    std::cerr << "The elements have other points than the appended ones";
+                else if ((values[3 * 7 + 2] != 1.) || (values[3 * 12 + 2] != 1.))
+                    std::cerr << "The triangles don't have the normals of their counter-clockwise vertices";
+                else {
+                    vectorList.Clear();
+                    vectorList.Export(arrays);
+
+                    if (arrays.NumberOfElements() != 0)
+                        std::cerr << "The vector list wasn't cleared";
+                    else if (!vectorList.AppendPoints(3, points) || (IteratedTypes(vectorList).size() != 3))
+                        std::cerr << "Could not append to the cleared vector list";
+                    else
+                        ret = 0;
+                }
+            }
+            else
+                std::cerr << "Could not append the elements";
+        }
+        else if (strcmp(argv[1], "concurrentFill") == 0) {
+            const size_t                    numberOfThreads  = 4;
+            const size_t                    circlesPerThread = 1000;
+            std::vector<BRLCAD::VectorList> vectorLists(numberOfThreads);
+            std::vector<std::thread>        threads;
+
+            for (size_t i = 0; i < numberOfThreads; ++i)
+                threads.push_back(std::thread(FillCircles, std::ref(vectorLists[i]), circlesPerThread, static_cast<double>(i)));
+
+            for (size_t i = 0; i < numberOfThreads; ++i)
+                threads[i].join();
+
+            ret = 0;
+
+            for (size_t i = 0; (i < numberOfThreads) && (ret == 0); ++i) {
+                BRLCAD::VectorList::ElementArrays arrays;
+
+                vectorLists[i].Export(arrays);
+
+                if (arrays.NumberOfElements() != 361 * circlesPerThread) {
+                    std::cerr << "Vector list " << i << " has " << arrays.NumberOfElements() << " elements instead of " << (361 * circlesPerThread);
+                    ret = 1;
+                }
+                else {
+                    // every vector list has to contain its own circles only
+                    for (size_t j = 0; j < arrays.NumberOfElements(); ++j) {
+                        if (arrays.Values()[3 * j + 2] != static_cast<double>(i)) {
+                            std::cerr << "Vector list " << i << " contains an element of another thread";
+                            ret = 1;
+                            break;
+                        }
+                    }
+                }
+
+                vectorLists[i].Clear();
+                vectorLists[i].FreeUnusedMemory();
+            }
+        }
+        else if (strcmp(argv[1], "saveLoad") == 0) {
+            BRLCAD::VectorList vectorList;
+
+            if (CreateList(vectorList)) {
+                // the quantization step of the points is 6 / 65535, the one of the normals 2 / 65535
+                const BRLCAD::VectorList::CoordinateFormat formats[]    = {BRLCAD::VectorList::CoordinateFormat::Double,
+                                                                           BRLCAD::VectorList::CoordinateFormat::Float,
+                                                                           BRLCAD::VectorList::CoordinateFormat::Quantized16};
+                const double                               tolerances[] = {0., 1e-6, 1e-4};
+
+                ret = 0;
+
+                for (size_t i = 0; (i < 3) && (ret == 0); ++i) {
+                    BRLCAD::VectorList             loaded;
+                    BRLCAD::VectorList::MappedView view;
+
+                    if (!vectorList.Save("vectorlist.vl", formats[i]) || !loaded.Load("vectorlist.vl")) {
+                        std::cerr << "Could not save and load the vector list in format " << i;
+                        ret = 1;
+                    }
+                    else if (MaximumDeviation(vectorList, loaded) < 0.) {
+                        std::cerr << "The loaded vector list in format " << i << " has other elements";
+                        ret = 1;
+                    }
+                    else if (MaximumDeviation(vectorList, loaded) > tolerances[i]) {
+                        std::cerr << "The loaded vector list in format " << i << " deviates by " << MaximumDeviation(vectorList, loaded);
+                        ret = 1;
+                    }
+                    else if (!view.Open("vectorlist.vl") || (view.NumberOfElements() != sizeof(ListTypes) / sizeof(ListTypes[0]))) {
+                        std::cerr << "Could not map the vector list in format " << i;
+                        ret = 1;
+                    }
+                    else {
+                        std::vector<ElementType> viewTypes;
+
+                        view.Iterate([&viewTypes](const BRLCAD::VectorList::Element* element) {
+                            viewTypes.push_back(element->Type());
+
+                            return true;
+                        });
+
+                        if (viewTypes != IteratedTypes(vectorList)) {
+                            std::cerr << "The mapped view in format " << i << " has other elements";
+                            ret = 1;
+                        }
+                    }
+                }
+
+                if (ret == 0) {
+                    // the first command follows the 80 bytes of the header, an unknown one has to be rejected
+                    BRLCAD::VectorList             loaded;
+                    BRLCAD::VectorList::MappedView view;
+
+                    ret = 1;
+
+                    if (!CorruptedCopy("vectorlist.vl", "corrupted.vl", 80, 0xff))
+                        std::cerr << "Could not write the corrupted file";
+                    else if (!loaded.Append(BRLCAD::VectorList::PointDraw(BRLCAD::Vector3D(0., 0., 0.))) || loaded.Load("corrupted.vl"))
+                        std::cerr << "The corrupted file was loaded";
+                    else if (IteratedTypes(loaded).size() != 1)
+                        std::cerr << "The failed load changed the vector list";
+                    else if (view.Open("corrupted.vl"))
+                        std::cerr << "The corrupted file was mapped";
+                    else
+                        ret = 0;
+                }
+
+                remove("vectorlist.vl");
+                remove("corrupted.vl");
+            }
+            else
+                std::cerr << "Could not create the vector list";
+        }
+        else if (strcmp(argv[1], "simplify") == 0) {
+            BRLCAD::VectorList vectorList;
+            bool               created = true;
+
+            // a polyline with a corner and collinear points, a line and a polyline in display space
+            created = created && vectorList.Append(BRLCAD::VectorList::PointSize(3.));
+            created = created && vectorList.Append(BRLCAD::VectorList::LineMove(BRLCAD::Vector3D(0., 0., 0.)));
+            created = created && vectorList.Append(BRLCAD::VectorList::LineDraw(BRLCAD::Vector3D(1., 0., 0.)));
+            created = created && vectorList.Append(BRLCAD::VectorList::LineDraw(BRLCAD::Vector3D(2., 0., 0.)));
+            created = created && vectorList.Append(BRLCAD::VectorList::LineDraw(BRLCAD::Vector3D(2., 1., 0.)));
+            created = created && vectorList.Append(BRLCAD::VectorList::LineDraw(BRLCAD::Vector3D(2., 2., 0.)));
+            created = created && vectorList.Append(BRLCAD::VectorList::LineMove(BRLCAD::Vector3D(5., 0., 0.)));
+            created = created && vectorList.Append(BRLCAD::VectorList::LineDraw(BRLCAD::Vector3D(6., 0., 0.)));
+            created = created && vectorList.Append(BRLCAD::VectorList::DisplaySpace(BRLCAD::Vector3D(0., 0., 0.)));
+            created = created && vectorList.Append(BRLCAD::VectorList::LineMove(BRLCAD::Vector3D(0., 0., 0.)));
+            created = created && vectorList.Append(BRLCAD::VectorList::LineDraw(BRLCAD::Vector3D(1., 0., 0.)));
+            created = created && vectorList.Append(BRLCAD::VectorList::LineDraw(BRLCAD::Vector3D(2., 0., 0.)));
+            created = created && vectorList.Append(BRLCAD::VectorList::ModelSpace());
+
+            if (created) {
+                const std::vector<ElementType> simplifiedTypes = {ElementType::PointSize,
+                                                                  ElementType::LineMove, ElementType::LineDraw, ElementType::LineDraw,
+                                                                  ElementType::LineMove, ElementType::LineDraw,
+                                                                  ElementType::DisplaySpace, ElementType::LineMove, ElementType::LineDraw, ElementType::LineDraw,
+                                                                  ElementType::ModelSpace};
+                BRLCAD::VectorList::ElementArrays arrays;
+
+                vectorList.Simplify(0.01);
+                vectorList.Export(arrays);
+
+                std::vector<ElementType> types(arrays.ElementTypes(), arrays.ElementTypes() + arrays.NumberOfElements());
+                const double*            values = arrays.Values();
+
+                if (types != simplifiedTypes)
+                    std::cerr << "The simplified vector list has " << types.size() << " elements of other types than expected";
+                else if ((values[3 * 1] != 0.) || (values[3 * 2] != 2.) || (values[3 * 2 + 1] != 0.) || (values[3 * 3 + 1] != 2.))
+                    std::cerr << "The polyline wasn't reduced to its first point, its corner and its last point";
+                else if ((values[3 * 4] != 5.) || (values[3 * 5] != 6.))
+                    std::cerr << "The line was changed";
+                else if ((values[3 * 8] != 1.) || (values[3 * 9] != 2.))
+                    std::cerr << "The polyline in display space was simplified";
+                else
+                    ret = 0;
+            }
+            else
+                std::cerr << "Could not create the vector list";
+        }
+        else
+            std::cerr << "Unknown test type: " << argv[1];
+    }
+
+    return ret;
+}
@@ -24,11 +24,20 @@
  */
 
 #include <cassert>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <unordered_map>
 
 #include "bu/parallel.h"
-#include "rt/global.h"
+#include "bu/mapped_file.h"
 #include "bv/vlist.h"
 
+#include "Database/private.h"
+
 #include <brlcad/VectorList.h>
 
 
@@ -843,307 +852,947 @@ VectorList::ModelSpace::ModelSpace
 
 
 //
-// BRLCAD::VectorList
+// BRLCAD::VectorList::ElementArrays
 //
-VectorList::VectorList(void) {
-    assert(BU_LIST_IS_INITIALIZED(&rt_vlfree));
+class VectorList::ElementArrays::Arrays {
+public:
+    std::vector<Element::ElementType> elementTypes;
+    std::vector<double>               values;
+};
 
-    m_vlist = new bu_list;
-    BU_LIST_INIT(m_vlist);
-}
 
+VectorList::ElementArrays::ElementArrays(void) : m_arrays(new Arrays) {}
 
-VectorList::VectorList
-(
-    const VectorList& original
-) {
-    m_vlist = new bu_list;
-    BU_LIST_INIT(m_vlist);
 
-    if (!BU_SETJUMP)
-        bv_vlist_copy(&rt_vlfree, m_vlist, original.m_vlist);
-    else
-        BU_UNSETJUMP;
+VectorList::ElementArrays::~ElementArrays(void) {
+    delete m_arrays;
+}
 
-    BU_UNSETJUMP;
+
+size_t VectorList::ElementArrays::NumberOfElements(void) const {
+    return m_arrays->elementTypes.size();
 }
 
 
-VectorList::~VectorList(void) {
-    BV_FREE_VLIST(&rt_vlfree, m_vlist);
-    delete m_vlist;
+const VectorList::Element::ElementType* VectorList::ElementArrays::ElementTypes(void) const {
+    return m_arrays->elementTypes.data();
 }
 
 
-const VectorList& VectorList::operator=
-(
-    const VectorList& original
-) {
-    if (&original != this) {
-        BV_FREE_VLIST(&rt_vlfree, m_vlist);
+const double* VectorList::ElementArrays::Values(void) const {
+    return m_arrays->values.data();
+}
 
-        if (!BU_SETJUMP)
-            bv_vlist_copy(&rt_vlfree, m_vlist, original.m_vlist);
-        else
-            BU_UNSETJUMP;
 
-        BU_UNSETJUMP;
+//
+// BRLCAD::VectorList::IndexedPrimitives
+//
+class VectorList::IndexedPrimitives::Arrays {
+public:
+    std::vector<double> vertices;
+    std::vector<size_t> pointIndices;
+    std::vector<size_t> lineIndices;
+    std::vector<size_t> triangleIndices;
+
+    void Clear(void) {
+        vertices.clear();
+        pointIndices.clear();
+        lineIndices.clear();
+        triangleIndices.clear();
     }
+};
 
-    return *this;
+
+VectorList::IndexedPrimitives::IndexedPrimitives(void) : m_arrays(new Arrays) {}
+
+
+VectorList::IndexedPrimitives::~IndexedPrimitives(void) {
+    delete m_arrays;
 }
 
 
-void VectorList::Iterate
-(
-    const std::function<bool(const Element* element)>& callback
-) const {
-    if (m_vlist != nullptr) {
-        bool      cont = true;
-        bv_vlist* chunk;
+size_t VectorList::IndexedPrimitives::NumberOfVertices(void) const {
+    return m_arrays->vertices.size() / 3;
+}
 
-        for (BU_LIST_FOR(chunk, bv_vlist, m_vlist)) {
-            for (size_t i = 0; i < chunk->nused; ++i) {
-                switch (chunk->cmd[i]) {
-                    case BV_VLIST_LINE_MOVE: {
-                        LineMove element(chunk, i);
 
-                        if (!callback(&element))
-                            cont = false;
+const double* VectorList::IndexedPrimitives::Vertices(void) const {
+    return m_arrays->vertices.data();
+}
 
-                        break;
-                    }
 
-                    case BV_VLIST_LINE_DRAW: {
-                        LineDraw element(chunk, i);
+size_t VectorList::IndexedPrimitives::NumberOfPoints(void) const {
+    return m_arrays->pointIndices.size();
+}
 
-                        if (!callback(&element))
-                            cont = false;
 
-                        break;
-                    }
+const size_t* VectorList::IndexedPrimitives::PointIndices(void) const {
+    return m_arrays->pointIndices.data();
+}
 
-                    case BV_VLIST_POLY_START: {
-                        PolygonStart element(chunk, i);
 
-                        if (!callback(&element))
-                            cont = false;
+size_t VectorList::IndexedPrimitives::NumberOfLines(void) const {
+    return m_arrays->lineIndices.size() / 2;
+}
 
-                        break;
-                    }
 
-                    case BV_VLIST_POLY_MOVE: {
-                        PolygonMove element(chunk, i);
+const size_t* VectorList::IndexedPrimitives::LineIndices(void) const {
+    return m_arrays->lineIndices.data();
+}
 
-                        if (!callback(&element))
-                            cont = false;
 
-                        break;
-                    }
+size_t VectorList::IndexedPrimitives::NumberOfTriangles(void) const {
+    return m_arrays->triangleIndices.size() / 3;
+}
 
-                    case BV_VLIST_POLY_DRAW: {
-                        PolygonDraw element(chunk, i);
 
-                        if (!callback(&element))
-                            cont = false;
+const size_t* VectorList::IndexedPrimitives::TriangleIndices(void) const {
+    return m_arrays->triangleIndices.data();
+}
 
-                        break;
-                    }
 
-                    case BV_VLIST_POLY_END: {
-                        PolygonEnd element(chunk, i);
+/// the type of a vlist command
+/** \return false if the command is unknown */
+static bool ElementTypeOf
+(
+    int                               command,
+    VectorList::Element::ElementType& elementType
+) {
+    bool ret = true;
 
-                        if (!callback(&element))
-                            cont = false;
+    switch (command) {
+        case BV_VLIST_LINE_MOVE:
+            elementType = VectorList::Element::ElementType::LineMove;
+            break;
 
-                        break;
-                    }
+        case BV_VLIST_LINE_DRAW:
+            elementType = VectorList::Element::ElementType::LineDraw;
+            break;
 
-                    case BV_VLIST_POLY_VERTNORM: {
-                        PolygonVertexNormal element(chunk, i);
+        case BV_VLIST_POLY_START:
+            elementType = VectorList::Element::ElementType::PolygonStart;
+            break;
 
-                        if (!callback(&element))
-                            cont = false;
+        case BV_VLIST_POLY_MOVE:
+            elementType = VectorList::Element::ElementType::PolygonMove;
+            break;
 
-                        break;
-                    }
+        case BV_VLIST_POLY_DRAW:
+            elementType = VectorList::Element::ElementType::PolygonDraw;
+            break;
 
-                    case BV_VLIST_TRI_START: {
-                        TriangleStart element(chunk, i);
+        case BV_VLIST_POLY_END:
+            elementType = VectorList::Element::ElementType::PolygonEnd;
+            break;
 
-                        if (!callback(&element))
-                            cont = false;
+        case BV_VLIST_POLY_VERTNORM:
+            elementType = VectorList::Element::ElementType::PolygonVertexNormal;
+            break;
 
-                        break;
-                    }
+        case BV_VLIST_TRI_START:
+            elementType = VectorList::Element::ElementType::TriangleStart;
+            break;
 
-                    case BV_VLIST_TRI_MOVE: {
-                        TriangleMove element(chunk, i);
+        case BV_VLIST_TRI_MOVE:
+            elementType = VectorList::Element::ElementType::TriangleMove;
+            break;
 
-                        if (!callback(&element))
-                            cont = false;
+        case BV_VLIST_TRI_DRAW:
+            elementType = VectorList::Element::ElementType::TriangleDraw;
+            break;
 
-                        break;
-                    }
+        case BV_VLIST_TRI_END:
+            elementType = VectorList::Element::ElementType::TriangleEnd;
+            break;
 
-                    case BV_VLIST_TRI_DRAW: {
-                        TriangleDraw element(chunk, i);
+        case BV_VLIST_TRI_VERTNORM:
+            elementType = VectorList::Element::ElementType::TriangleVertexNormal;
+            break;
 
-                        if (!callback(&element))
-                            cont = false;
+        case BV_VLIST_POINT_DRAW:
+            elementType = VectorList::Element::ElementType::PointDraw;
+            break;
 
-                        break;
-                    }
+        case BV_VLIST_POINT_SIZE:
+            elementType = VectorList::Element::ElementType::PointSize;
+            break;
 
-                    case BV_VLIST_TRI_END: {
-                        TriangleEnd element(chunk, i);
+        case BV_VLIST_LINE_WIDTH:
+            elementType = VectorList::Element::ElementType::LineWidth;
+            break;
 
-                        if (!callback(&element))
-                            cont = false;
+        case BV_VLIST_DISPLAY_MAT:
+            elementType = VectorList::Element::ElementType::DisplaySpace;
+            break;
 
-                        break;
-                    }
+        case BV_VLIST_MODEL_MAT:
+            elementType = VectorList::Element::ElementType::ModelSpace;
+            break;
 
-                    case BV_VLIST_TRI_VERTNORM: {
-                        TriangleVertexNormal element(chunk, i);
+        default:
+            ret = false;
+    }
 
-                        if (!callback(&element))
-                            cont = false;
+    return ret;
+}
 
-                        break;
-                    }
 
-                    case BV_VLIST_POINT_DRAW: {
-                        PointDraw element(chunk, i);
+//
+// vector list files
+//
+/// the header of a file written by VectorList::Save()
+struct VectorListFileHeader {
+    char     magic[8];
+    uint32_t version;             ///< identifies the byte order too
+    uint32_t coordinateFormat;    ///< VectorList::CoordinateFormat
+    uint64_t numberOfElements;
+    uint64_t numberOfUnquantized; ///< elements whose coordinates follow the quantized ones as doubles
+    double   minimum[3];          ///< the origin of the quantized points
+    double   step[3];             ///< the quantization step of the points
+};
 
-                        if (!callback(&element))
-                            cont = false;
 
-                        break;
-                    }
+static_assert(sizeof(VectorListFileHeader) == 80, "the header of the vector list files must not be padded");
 
-                    case BV_VLIST_POINT_SIZE: {
-                        PointSize element(chunk, i);
 
-                        if (!callback(&element))
-                            cont = false;
+static const char     VectorListFileMagic[8] = {'B', 'R', 'L', 'V', 'L', 'I', 'S', 'T'};
+static const uint32_t VectorListFileVersion  = 2;
 
-                        break;
-                    }
 
-                    case BV_VLIST_LINE_WIDTH: {
-                        LineWidth element(chunk, i);
+/// bytes of the coordinates of an element
+static size_t CoordinatesSize
+(
+    VectorList::CoordinateFormat coordinateFormat
+) {
+    size_t ret = 3 * sizeof(double);
 
-                        if (!callback(&element))
-                            cont = false;
+    if (coordinateFormat == VectorList::CoordinateFormat::Float)
+        ret = 3 * sizeof(float);
+    else if (coordinateFormat == VectorList::CoordinateFormat::Quantized16)
+        ret = 3 * sizeof(uint16_t);
 
-                        break;
-                    }
+    return ret;
+}
 
-                    case BV_VLIST_DISPLAY_MAT: {
-                        DisplaySpace element(chunk, i);
 
-                        if (!callback(&element))
-                            cont = false;
+/// the position of the coordinates in the file, they follow the commands aligned to 8 bytes
+static size_t CoordinatesOffset
+(
+    size_t numberOfElements
+) {
+    return (sizeof(VectorListFileHeader) + numberOfElements + 7) & ~static_cast<size_t>(7);
+}
 
-                        break;
-                    }
 
-                    case BV_VLIST_MODEL_MAT: {
-                        ModelSpace element(chunk, i);
+/// the position of the unquantized coordinates in the file, they follow the other coordinates aligned to 8 bytes
+static size_t UnquantizedOffset
+(
+    size_t numberOfElements,
+    size_t coordinatesSize
+) {
+    return (CoordinatesOffset(numberOfElements) + numberOfElements * coordinatesSize + 7) & ~static_cast<size_t>(7);
+}
 
-                        if (!callback(&element))
-                            cont = false;
 
-                        break;
-                    }
+/// the coordinates of these elements are normals, they are quantized relative to [-1, 1]
+static bool IsNormal
+(
+    int command
+) {
+    return (command == BV_VLIST_POLY_START) || (command == BV_VLIST_POLY_VERTNORM) || (command == BV_VLIST_TRI_START) || (command == BV_VLIST_TRI_VERTNORM);
+}
 
-                    default:
-                        if (!callback(nullptr))
-                            cont = false;
-                }
 
-                if (!cont)
-                    return;
-            }
-        }
-    }
+/// the coordinates of these elements are a size, a width or in display space, they aren't part of the bounding box and aren't quantized
+static bool IsUnquantized
+(
+    int command
+) {
+    return (command == BV_VLIST_POINT_SIZE) || (command == BV_VLIST_LINE_WIDTH) || (command == BV_VLIST_DISPLAY_MAT) || (command == BV_VLIST_MODEL_MAT);
 }
 
 
-void VectorList::Iterate
+static void EncodeCoordinates
 (
-    const std::function<bool(Element* element)>& callback
+    const VectorListFileHeader& header,
+    int                         command,
+    const double*               point,
+    unsigned char*              destination
 ) {
-    if (m_vlist != nullptr) {
-        bool      cont = true;
-        bv_vlist* chunk;
+    switch (static_cast<VectorList::CoordinateFormat>(header.coordinateFormat)) {
+        case VectorList::CoordinateFormat::Double:
+            memcpy(destination, point, 3 * sizeof(double));
+            break;
 
-        for (BU_LIST_FOR(chunk, bv_vlist, m_vlist)) {
-            for (size_t i = 0; i < chunk->nused; ++i) {
-                switch (chunk->cmd[i]) {
-                    case BV_VLIST_LINE_MOVE: {
-                        LineMove element(chunk, i);
+        case VectorList::CoordinateFormat::Float: {
+            float values[3] = {static_cast<float>(point[X]), static_cast<float>(point[Y]), static_cast<float>(point[Z])};
 
-                        if (!callback(&element))
-                            cont = false;
+            memcpy(destination, values, sizeof(values));
+            break;
+        }
 
-                        break;
-                    }
+        case VectorList::CoordinateFormat::Quantized16: {
+            uint16_t values[3];
 
-                    case BV_VLIST_LINE_DRAW: {
-                        LineDraw element(chunk, i);
+            for (size_t i = 0; i < 3; ++i) {
+                double value = 0.;
 
-                        if (!callback(&element))
-                            cont = false;
+                if (IsUnquantized(command))
+                    ; // the coordinates follow as doubles
+                else if (IsNormal(command))
+                    value = (point[i] + 1.) * 65535. / 2.;
+                else if (header.step[i] > 0.)
+                    value = (point[i] - header.minimum[i]) / header.step[i];
 
-                        break;
-                    }
+                values[i] = static_cast<uint16_t>(std::min(std::max(floor(value + 0.5), 0.), 65535.));
+            }
 
-                    case BV_VLIST_POLY_START: {
-                        PolygonStart element(chunk, i);
+            memcpy(destination, values, sizeof(values));
+        }
+    }
+}
 
-                        if (!callback(&element))
-                            cont = false;
 
-                        break;
-                    }
+/// decodes the coordinates of an element, the ones which aren't quantized are taken from \a unquantized in the order of the elements
+/** \a unquantizedIndex counts the unquantized coordinates read so far. */
+static void DecodeCoordinates
+(
+    const VectorListFileHeader& header,
+    int                         command,
+    const unsigned char*        source,
+    const unsigned char*        unquantized,
+    size_t&                     unquantizedIndex,
+    double*                     point
+) {
+    if ((static_cast<VectorList::CoordinateFormat>(header.coordinateFormat) == VectorList::CoordinateFormat::Quantized16) && IsUnquantized(command)) {
+        if (unquantizedIndex < header.numberOfUnquantized) {
+            memcpy(point, unquantized + unquantizedIndex * 3 * sizeof(double), 3 * sizeof(double));
+            ++unquantizedIndex;
+        }
+        else
+            VSETALL(point, 0.);
+    }
+    else {
+        switch (static_cast<VectorList::CoordinateFormat>(header.coordinateFormat)) {
+            case VectorList::CoordinateFormat::Double:
+                memcpy(point, source, 3 * sizeof(double));
+                break;
 
-                    case BV_VLIST_POLY_MOVE: {
-                        PolygonMove element(chunk, i);
+            case VectorList::CoordinateFormat::Float: {
+                float values[3];
 
-                        if (!callback(&element))
-                            cont = false;
+                memcpy(values, source, sizeof(values));
+                VSET(point, values[X], values[Y], values[Z]);
+                break;
+            }
 
-                        break;
-                    }
+            case VectorList::CoordinateFormat::Quantized16: {
+                uint16_t values[3];
 
-                    case BV_VLIST_POLY_DRAW: {
-                        PolygonDraw element(chunk, i);
+                memcpy(values, source, sizeof(values));
 
-                        if (!callback(&element))
-                            cont = false;
+                for (size_t i = 0; i < 3; ++i) {
+                    if (IsNormal(command))
+                        point[i] = values[i] * 2. / 65535. - 1.;
+                    else
+                        point[i] = header.minimum[i] + values[i] * header.step[i];
+                }
+            }
+        }
+    }
+}
 
-                        break;
-                    }
 
-                    case BV_VLIST_POLY_END: {
-                        PolygonEnd element(chunk, i);
+//
+// BRLCAD::VectorList::MappedView
+//
+class VectorList::MappedView::Mapping {
+public:
+    bu_mapped_file*      file;
+    VectorListFileHeader header;
+    const unsigned char* commands;
+    const unsigned char* coordinates;
+    size_t               coordinatesSize; ///< per element
+    const unsigned char* unquantized;
 
-                        if (!callback(&element))
-                            cont = false;
+    Mapping(void) : file(nullptr), header(), commands(nullptr), coordinates(nullptr), coordinatesSize(0), unquantized(nullptr) {}
+};
 
-                        break;
-                    }
 
-                    case BV_VLIST_POLY_VERTNORM: {
-                        PolygonVertexNormal element(chunk, i);
+VectorList::MappedView::MappedView(void) : m_mapping(new Mapping) {}
 
-                        if (!callback(&element))
-                            cont = false;
 
-                        break;
-                    }
+VectorList::MappedView::~MappedView(void) {
+    Close();
+    delete m_mapping;
+}
+
+
+bool VectorList::MappedView::Open
+(
+    const char* fileName
+) {
+    bool ret = false;
+
+    Close();
+
+    if (!BU_SETJUMP) {
+        bu_mapped_file* file = bu_open_mapped_file(fileName, "BRLCAD::VectorList::MappedView");
+
+        if (file != nullptr) {
+            const unsigned char*  buffer = static_cast<const unsigned char*>(file->buf);
+            VectorListFileHeader& header = m_mapping->header;
+
+            if (file->buflen >= sizeof(header)) {
+                memcpy(&header, buffer, sizeof(header));
+
+                if ((memcmp(header.magic, VectorListFileMagic, sizeof(VectorListFileMagic)) == 0) &&
+                    (header.version == VectorListFileVersion) &&
+                    (header.coordinateFormat <= static_cast<uint32_t>(CoordinateFormat::Quantized16)) &&
+                    (header.numberOfElements <= file->buflen) &&
+                    (header.numberOfUnquantized <= header.numberOfElements)) {
+                    size_t numberOfElements    = static_cast<size_t>(header.numberOfElements);
+                    size_t numberOfUnquantized = static_cast<size_t>(header.numberOfUnquantized);
+                    size_t coordinatesSize     = CoordinatesSize(static_cast<CoordinateFormat>(header.coordinateFormat));
+
+                    if (file->buflen >= UnquantizedOffset(numberOfElements, coordinatesSize) + numberOfUnquantized * 3 * sizeof(double)) {
+                        // every command has to be known, and the unquantized coordinates have to match their commands
+                        const unsigned char* commands            = buffer + sizeof(header);
+                        size_t               unquantizedCommands = 0;
+
+                        ret = true;
+
+                        for (size_t i = 0; ret && (i < numberOfElements); ++i) {
+                            VectorList::Element::ElementType elementType;
+
+                            ret = ElementTypeOf(commands[i], elementType);
+
+                            if (IsUnquantized(commands[i]))
+                                ++unquantizedCommands;
+                        }
+
+                        if (static_cast<CoordinateFormat>(header.coordinateFormat) == CoordinateFormat::Quantized16)
+                            ret = ret && (unquantizedCommands == numberOfUnquantized);
+                        else
+                            ret = ret && (numberOfUnquantized == 0);
+                    }
+
+                    if (ret) {
+                        m_mapping->file            = file;
+                        m_mapping->commands        = buffer + sizeof(header);
+                        m_mapping->coordinates     = buffer + CoordinatesOffset(numberOfElements);
+                        m_mapping->coordinatesSize = coordinatesSize;
+                        m_mapping->unquantized     = buffer + UnquantizedOffset(numberOfElements, coordinatesSize);
+                    }
+                }
+            }
+
+            if (!ret)
+                bu_close_mapped_file(file);
+        }
+    }
+    else
+        BU_UNSETJUMP;
+
+    BU_UNSETJUMP;
+
+    return ret;
+}
+
+
+void VectorList::MappedView::Close(void) {
+    if (m_mapping->file != nullptr)
+        bu_close_mapped_file(m_mapping->file);
+
+    *m_mapping = Mapping();
+}
+
+
+size_t VectorList::MappedView::NumberOfElements(void) const {
+    size_t ret = 0;
+
+    if (m_mapping->file != nullptr)
+        ret = static_cast<size_t>(m_mapping->header.numberOfElements);
+
+    return ret;
+}
+
+
+void VectorList::MappedView::Iterate
+(
+    const std::function<bool(const Element* element)>& callback
+) const {
+    bool   cont             = true;
+    size_t numberOfElements = NumberOfElements();
+    size_t unquantizedIndex = 0;
+
+    for (size_t i = 0; cont && (i < numberOfElements); ++i) {
+        int    command = m_mapping->commands[i];
+        double point[3];
+
+        DecodeCoordinates(m_mapping->header, command, m_mapping->coordinates + i * m_mapping->coordinatesSize, m_mapping->unquantized, unquantizedIndex, point);
+
+        switch (command) {
+            case BV_VLIST_LINE_MOVE: {
+                LineMove element;
+
+                element.SetPoint(Vector3D(point));
+
+                cont = callback(&element);
+                break;
+            }
+
+            case BV_VLIST_LINE_DRAW: {
+                LineDraw element;
+
+                element.SetPoint(Vector3D(point));
+
+                cont = callback(&element);
+                break;
+            }
+
+            case BV_VLIST_POLY_START: {
+                PolygonStart element;
+
+                element.SetNormal(Vector3D(point));
+
+                cont = callback(&element);
+                break;
+            }
+
+            case BV_VLIST_POLY_MOVE: {
+                PolygonMove element;
+
+                element.SetPoint(Vector3D(point));
+
+                cont = callback(&element);
+                break;
+            }
+
+            case BV_VLIST_POLY_DRAW: {
+                PolygonDraw element;
+
+                element.SetPoint(Vector3D(point));
+
+                cont = callback(&element);
+                break;
+            }
+
+            case BV_VLIST_POLY_END: {
+                PolygonEnd element;
+
+                element.SetPoint(Vector3D(point));
+
+                cont = callback(&element);
+                break;
+            }
+
+            case BV_VLIST_POLY_VERTNORM: {
+                PolygonVertexNormal element;
+
+                element.SetNormal(Vector3D(point));
+
+                cont = callback(&element);
+                break;
+            }
+
+            case BV_VLIST_TRI_START: {
+                TriangleStart element;
+
+                element.SetNormal(Vector3D(point));
+
+                cont = callback(&element);
+                break;
+            }
+
+            case BV_VLIST_TRI_MOVE: {
+                TriangleMove element;
+
+                element.SetPoint(Vector3D(point));
+
+                cont = callback(&element);
+                break;
+            }
+
+            case BV_VLIST_TRI_DRAW: {
+                TriangleDraw element;
+
+                element.SetPoint(Vector3D(point));
+
+                cont = callback(&element);
+                break;
+            }
+
+            case BV_VLIST_TRI_END: {
+                TriangleEnd element;
+
+                element.SetPoint(Vector3D(point));
+
+                cont = callback(&element);
+                break;
+            }
+
+            case BV_VLIST_TRI_VERTNORM: {
+                TriangleVertexNormal element;
+
+                element.SetNormal(Vector3D(point));
+
+                cont = callback(&element);
+                break;
+            }
+
+            case BV_VLIST_POINT_DRAW: {
+                PointDraw element;
+
+                element.SetPoint(Vector3D(point));
+
+                cont = callback(&element);
+                break;
+            }
+
+            case BV_VLIST_POINT_SIZE: {
+                PointSize element;
+
+                element.SetSize(point[0]);
+
+                cont = callback(&element);
+                break;
+            }
+
+            case BV_VLIST_LINE_WIDTH: {
+                LineWidth element;
+
+                element.SetWidth(point[0]);
+
+                cont = callback(&element);
+                break;
+            }
+
+            case BV_VLIST_DISPLAY_MAT: {
+                DisplaySpace element;
+
+                element.SetReferencePoint(Vector3D(point));
+
+                cont = callback(&element);
+                break;
+            }
+
+            case BV_VLIST_MODEL_MAT: {
+                ModelSpace element;
+
+                cont = callback(&element);
+            }
+        }
+    }
+}
+
+
+//
+// BRLCAD::VectorList
+//
+VectorList::VectorList(void) {
+    m_vlist      = new bu_list;
+    m_freeChunks = new bu_list;
+    BU_LIST_INIT(m_vlist);
+    BU_LIST_INIT(m_freeChunks);
+}
+
+
+VectorList::VectorList
+(
+    const VectorList& original
+) {
+    m_vlist      = new bu_list;
+    m_freeChunks = new bu_list;
+    BU_LIST_INIT(m_vlist);
+    BU_LIST_INIT(m_freeChunks);
+
+    if (!BU_SETJUMP)
+        bv_vlist_copy(m_freeChunks, m_vlist, original.m_vlist);
+    else
+        BU_UNSETJUMP;
+
+    BU_UNSETJUMP;
+}
+
+
+VectorList::~VectorList(void) {
+    BV_FREE_VLIST(m_freeChunks, m_vlist);
+    bv_vlist_cleanup(m_freeChunks);
+    delete m_vlist;
+    delete m_freeChunks;
+}
+
+
+const VectorList& VectorList::operator=
+(
+    const VectorList& original
+) {
+    if (&original != this) {
+        BV_FREE_VLIST(m_freeChunks, m_vlist);
+
+        if (!BU_SETJUMP)
+            bv_vlist_copy(m_freeChunks, m_vlist, original.m_vlist);
+        else
+            BU_UNSETJUMP;
+
+        BU_UNSETJUMP;
+    }
+
+    return *this;
+}
+
+
+void VectorList::Iterate
+(
+    const std::function<bool(const Element* element)>& callback
+) const {
+    if (m_vlist != nullptr) {
+        bool      cont = true;
+        bv_vlist* chunk;
+
+        for (BU_LIST_FOR(chunk, bv_vlist, m_vlist)) {
+            for (size_t i = 0; i < chunk->nused; ++i) {
+                switch (chunk->cmd[i]) {
+                    case BV_VLIST_LINE_MOVE: {
+                        LineMove element(chunk, i);
+
+                        if (!callback(&element))
+                            cont = false;
+
+                        break;
+                    }
+
+                    case BV_VLIST_LINE_DRAW: {
+                        LineDraw element(chunk, i);
+
+                        if (!callback(&element))
+                            cont = false;
+
+                        break;
+                    }
+
+                    case BV_VLIST_POLY_START: {
+                        PolygonStart element(chunk, i);
+
+                        if (!callback(&element))
+                            cont = false;
+
+                        break;
+                    }
+
+                    case BV_VLIST_POLY_MOVE: {
+                        PolygonMove element(chunk, i);
+
+                        if (!callback(&element))
+                            cont = false;
+
+                        break;
+                    }
+
+                    case BV_VLIST_POLY_DRAW: {
+                        PolygonDraw element(chunk, i);
+
+                        if (!callback(&element))
+                            cont = false;
+
+                        break;
+                    }
+
+                    case BV_VLIST_POLY_END: {
+                        PolygonEnd element(chunk, i);
+
+                        if (!callback(&element))
+                            cont = false;
+
+                        break;
+                    }
+
+                    case BV_VLIST_POLY_VERTNORM: {
+                        PolygonVertexNormal element(chunk, i);
+
+                        if (!callback(&element))
+                            cont = false;
+
+                        break;
+                    }
+
+                    case BV_VLIST_TRI_START: {
+                        TriangleStart element(chunk, i);
+
+                        if (!callback(&element))
+                            cont = false;
+
+                        break;
+                    }
+
+                    case BV_VLIST_TRI_MOVE: {
+                        TriangleMove element(chunk, i);
+
+                        if (!callback(&element))
+                            cont = false;
+
+                        break;
+                    }
+
+                    case BV_VLIST_TRI_DRAW: {
+                        TriangleDraw element(chunk, i);
+
+                        if (!callback(&element))
+                            cont = false;
+
+                        break;
+                    }
+
+                    case BV_VLIST_TRI_END: {
+                        TriangleEnd element(chunk, i);
+
+                        if (!callback(&element))
+                            cont = false;
+
+                        break;
+                    }
+
+                    case BV_VLIST_TRI_VERTNORM: {
+                        TriangleVertexNormal element(chunk, i);
+
+                        if (!callback(&element))
+                            cont = false;
+
+                        break;
+                    }
+
+                    case BV_VLIST_POINT_DRAW: {
+                        PointDraw element(chunk, i);
+
+                        if (!callback(&element))
+                            cont = false;
+
+                        break;
+                    }
+
+                    case BV_VLIST_POINT_SIZE: {
+                        PointSize element(chunk, i);
+
+                        if (!callback(&element))
+                            cont = false;
+
+                        break;
+                    }
+
+                    case BV_VLIST_LINE_WIDTH: {
+                        LineWidth element(chunk, i);
+
+                        if (!callback(&element))
+                            cont = false;
+
+                        break;
+                    }
+
+                    case BV_VLIST_DISPLAY_MAT: {
+                        DisplaySpace element(chunk, i);
+
+                        if (!callback(&element))
+                            cont = false;
+
+                        break;
+                    }
+
+                    case BV_VLIST_MODEL_MAT: {
+                        ModelSpace element(chunk, i);
+
+                        if (!callback(&element))
+                            cont = false;
+
+                        break;
+                    }
+
+                    default:
+                        if (!callback(nullptr))
+                            cont = false;
+                }
+
+                if (!cont)
+                    return;
+            }
+        }
+    }
+}
+
+
+void VectorList::Iterate
+(
+    const std::function<bool(Element* element)>& callback
+) {
+    if (m_vlist != nullptr) {
+        bool      cont = true;
+        bv_vlist* chunk;
+
+        for (BU_LIST_FOR(chunk, bv_vlist, m_vlist)) {
+            for (size_t i = 0; i < chunk->nused; ++i) {
+                switch (chunk->cmd[i]) {
+                    case BV_VLIST_LINE_MOVE: {
+                        LineMove element(chunk, i);
+
+                        if (!callback(&element))
+                            cont = false;
+
+                        break;
+                    }
+
+                    case BV_VLIST_LINE_DRAW: {
+                        LineDraw element(chunk, i);
+
+                        if (!callback(&element))
+                            cont = false;
+
+                        break;
+                    }
+
+                    case BV_VLIST_POLY_START: {
+                        PolygonStart element(chunk, i);
+
+                        if (!callback(&element))
+                            cont = false;
+
+                        break;
+                    }
+
+                    case BV_VLIST_POLY_MOVE: {
+                        PolygonMove element(chunk, i);
+
+                        if (!callback(&element))
+                            cont = false;
+
+                        break;
+                    }
+
+                    case BV_VLIST_POLY_DRAW: {
+                        PolygonDraw element(chunk, i);
+
+                        if (!callback(&element))
+                            cont = false;
+
+                        break;
+                    }
+
+                    case BV_VLIST_POLY_END: {
+                        PolygonEnd element(chunk, i);
+
+                        if (!callback(&element))
+                            cont = false;
+
+                        break;
+                    }
+
+                    case BV_VLIST_POLY_VERTNORM: {
+                        PolygonVertexNormal element(chunk, i);
+
+                        if (!callback(&element))
+                            cont = false;
+
+                        break;
+                    }
 
                     case BV_VLIST_TRI_START: {
                         TriangleStart element(chunk, i);
@@ -1184,64 +1833,260 @@ void VectorList::Iterate
                     case BV_VLIST_TRI_VERTNORM: {
                         TriangleVertexNormal element(chunk, i);
 
-                        if (!callback(&element))
-                            cont = false;
+                        if (!callback(&element))
+                            cont = false;
+
+                        break;
+                    }
+
+                    case BV_VLIST_POINT_DRAW: {
+                        PointDraw element(chunk, i);
+
+                        if (!callback(&element))
+                            cont = false;
+
+                        break;
+                    }
+
+                    case BV_VLIST_POINT_SIZE: {
+                        PointSize element(chunk, i);
+
+                        if (!callback(&element))
+                            cont = false;
+
+                        break;
+                    }
+
+                    case BV_VLIST_LINE_WIDTH: {
+                        LineWidth element(chunk, i);
+
+                        if (!callback(&element))
+                            cont = false;
+
+                        break;
+                    }
+
+                    case BV_VLIST_DISPLAY_MAT: {
+                        DisplaySpace element(chunk, i);
+
+                        if (!callback(&element))
+                            cont = false;
+
+                        break;
+                    }
+
+                    case BV_VLIST_MODEL_MAT: {
+                        ModelSpace element(chunk, i);
+
+                        if (!callback(&element))
+                            cont = false;
+
+                        break;
+                    }
+
+                    default:
+                        if (!callback(nullptr))
+                            cont = false;
+                }
+
+                if (!cont)
+                    return;
+            }
+        }
+    }
+}
+
+
+const bv_vlist* VectorList::NextChunk
+(
+    const bv_vlist* chunk
+) const {
+    const bv_vlist* ret = nullptr;
+
+    if (m_vlist != nullptr) {
+        const bu_list* next = (chunk == nullptr) ? m_vlist->forw : chunk->l.forw;
+
+        if (next != m_vlist)
+            ret = reinterpret_cast<const bv_vlist*>(next);
+    }
+
+    return ret;
+}
+
+
+size_t VectorList::ChunkElements
+(
+    const bv_vlist* chunk,
+    const int*&     commands,
+    const double*&  points
+) {
+    // Visit() relies on the BV_VLIST_* values
+    static_assert(static_cast<int>(Command::LineMove) == BV_VLIST_LINE_MOVE, "vlist command code mismatch");
+    static_assert(static_cast<int>(Command::LineDraw) == BV_VLIST_LINE_DRAW, "vlist command code mismatch");
+    static_assert(static_cast<int>(Command::PolygonStart) == BV_VLIST_POLY_START, "vlist command code mismatch");
+    static_assert(static_cast<int>(Command::PolygonMove) == BV_VLIST_POLY_MOVE, "vlist command code mismatch");
+    static_assert(static_cast<int>(Command::PolygonDraw) == BV_VLIST_POLY_DRAW, "vlist command code mismatch");
+    static_assert(static_cast<int>(Command::PolygonEnd) == BV_VLIST_POLY_END, "vlist command code mismatch");
+    static_assert(static_cast<int>(Command::PolygonVertexNormal) == BV_VLIST_POLY_VERTNORM, "vlist command code mismatch");
+    static_assert(static_cast<int>(Command::TriangleStart) == BV_VLIST_TRI_START, "vlist command code mismatch");
+    static_assert(static_cast<int>(Command::TriangleMove) == BV_VLIST_TRI_MOVE, "vlist command code mismatch");
+    static_assert(static_cast<int>(Command::TriangleDraw) == BV_VLIST_TRI_DRAW, "vlist command code mismatch");
+    static_assert(static_cast<int>(Command::TriangleEnd) == BV_VLIST_TRI_END, "vlist command code mismatch");
+    static_assert(static_cast<int>(Command::TriangleVertexNormal) == BV_VLIST_TRI_VERTNORM, "vlist command code mismatch");
+    static_assert(static_cast<int>(Command::PointDraw) == BV_VLIST_POINT_DRAW, "vlist command code mismatch");
+    static_assert(static_cast<int>(Command::PointSize) == BV_VLIST_POINT_SIZE, "vlist command code mismatch");
+    static_assert(static_cast<int>(Command::LineWidth) == BV_VLIST_LINE_WIDTH, "vlist command code mismatch");
+    static_assert(static_cast<int>(Command::DisplaySpace) == BV_VLIST_DISPLAY_MAT, "vlist command code mismatch");
+    static_assert(static_cast<int>(Command::ModelSpace) == BV_VLIST_MODEL_MAT, "vlist command code mismatch");
+
+    commands = chunk->cmd;
+    points   = chunk->pt[0];
+
+    return chunk->nused;
+}
+
+
+void VectorList::Export
+(
+    ElementArrays& elementArrays
+) const {
+    ElementArrays::Arrays& arrays           = *elementArrays.m_arrays;
+    size_t                 numberOfElements = 0;
+    bv_vlist*              chunk;
+
+    for (BU_LIST_FOR(chunk, bv_vlist, m_vlist))
+        numberOfElements += chunk->nused;
+
+    arrays.elementTypes.clear();
+    arrays.values.clear();
+    arrays.elementTypes.reserve(numberOfElements);
+    arrays.values.reserve(3 * numberOfElements);
+
+    for (BU_LIST_FOR(chunk, bv_vlist, m_vlist)) {
+        for (size_t i = 0; i < chunk->nused; ++i) {
+            Element::ElementType elementType;
+
+            if (ElementTypeOf(chunk->cmd[i], elementType)) {
+                arrays.elementTypes.push_back(elementType);
+                arrays.values.insert(arrays.values.end(), chunk->pt[i], chunk->pt[i] + 3);
+            }
+        }
+    }
+}
+
+
+/// identifies a vertex by the bit patterns of its coordinates
+struct VertexKey {
+    uint64_t coordinates[3];
+
+    VertexKey(const double* point) {
+        for (size_t i = 0; i < 3; ++i) {
+            double coordinate = point[i] + 0.; // -0 becomes +0
+
+            memcpy(coordinates + i, &coordinate, sizeof(uint64_t));
+        }
+    }
 
-                        break;
-                    }
+    bool operator==(const VertexKey& other) const {
+        return (coordinates[0] == other.coordinates[0]) && (coordinates[1] == other.coordinates[1]) && (coordinates[2] == other.coordinates[2]);
+    }
+};
 
-                    case BV_VLIST_POINT_DRAW: {
-                        PointDraw element(chunk, i);
 
-                        if (!callback(&element))
-                            cont = false;
+struct VertexKeyHash {
+    size_t operator()(const VertexKey& key) const {
+        uint64_t ret = key.coordinates[0];
 
-                        break;
-                    }
+        ret = ret * 0x9e3779b97f4a7c15ULL ^ key.coordinates[1];
+        ret = ret * 0x9e3779b97f4a7c15ULL ^ key.coordinates[2];
 
-                    case BV_VLIST_POINT_SIZE: {
-                        PointSize element(chunk, i);
+        return static_cast<size_t>(ret ^ (ret >> 32));
+    }
+};
 
-                        if (!callback(&element))
-                            cont = false;
 
+void VectorList::Export
+(
+    IndexedPrimitives& indexedPrimitives
+) const {
+    IndexedPrimitives::Arrays&                          arrays       = *indexedPrimitives.m_arrays;
+    std::unordered_map<VertexKey, size_t, VertexKeyHash> vertexIndices;
+    std::vector<size_t>                                 polygon;
+    size_t                                              lastVertex   = SIZE_MAX;
+    bool                                                displaySpace = false;
+    bv_vlist*                                           chunk;
+
+    arrays.Clear();
+
+    auto vertexIndex = [&arrays, &vertexIndices](const double* point) {
+        auto inserted = vertexIndices.insert(std::make_pair(VertexKey(point), arrays.vertices.size() / 3));
+
+        if (inserted.second)
+            arrays.vertices.insert(arrays.vertices.end(), point, point + 3);
+
+        return inserted.first->second;
+    };
+
+    for (BU_LIST_FOR(chunk, bv_vlist, m_vlist)) {
+        for (size_t i = 0; i < chunk->nused; ++i) {
+            const double* point = chunk->pt[i];
+            int           cmd   = chunk->cmd[i];
+
+            if (cmd == BV_VLIST_DISPLAY_MAT)
+                displaySpace = true;
+            else if (cmd == BV_VLIST_MODEL_MAT)
+                displaySpace = false;
+            else if (!displaySpace) {
+                switch (cmd) {
+                    case BV_VLIST_LINE_MOVE:
+                        lastVertex = vertexIndex(point);
                         break;
-                    }
 
-                    case BV_VLIST_LINE_WIDTH: {
-                        LineWidth element(chunk, i);
+                    case BV_VLIST_LINE_DRAW: {
+                        size_t vertex = vertexIndex(point);
 
-                        if (!callback(&element))
-                            cont = false;
+                        if ((lastVertex != SIZE_MAX) && (lastVertex != vertex)) {
+                            arrays.lineIndices.push_back(lastVertex);
+                            arrays.lineIndices.push_back(vertex);
+                        }
 
+                        lastVertex = vertex;
                         break;
                     }
 
-                    case BV_VLIST_DISPLAY_MAT: {
-                        DisplaySpace element(chunk, i);
+                    case BV_VLIST_POINT_DRAW:
+                        arrays.pointIndices.push_back(vertexIndex(point));
+                        break;
 
-                        if (!callback(&element))
-                            cont = false;
+                    case BV_VLIST_POLY_START:
+                    case BV_VLIST_TRI_START:
+                        polygon.clear();
+                        break;
 
+                    case BV_VLIST_POLY_MOVE:
+                    case BV_VLIST_POLY_DRAW:
+                    case BV_VLIST_TRI_MOVE:
+                    case BV_VLIST_TRI_DRAW:
+                        polygon.push_back(vertexIndex(point));
                         break;
-                    }
 
-                    case BV_VLIST_MODEL_MAT: {
-                        ModelSpace element(chunk, i);
+                    case BV_VLIST_POLY_END:
+                    case BV_VLIST_TRI_END: {
+                        // the end point closes the polygon, i.e. it is usually the first one
+                        size_t vertex = vertexIndex(point);
 
-                        if (!callback(&element))
-                            cont = false;
+                        if (polygon.empty() || (polygon.front() != vertex))
+                            polygon.push_back(vertex);
 
-                        break;
-                    }
+                        for (size_t j = 1; j + 1 < polygon.size(); ++j) {
+                            arrays.triangleIndices.push_back(polygon[0]);
+                            arrays.triangleIndices.push_back(polygon[j]);
+                            arrays.triangleIndices.push_back(polygon[j + 1]);
+                        }
 
-                    default:
-                        if (!callback(nullptr))
-                            cont = false;
+                        polygon.clear();
+                    }
                 }
-
-                if (!cont)
-                    return;
             }
         }
     }
@@ -1259,117 +2104,266 @@ bool VectorList::Append
             case Element::ElementType::PointDraw: {
                 const PointDraw& actualElement = static_cast<const PointDraw&>(element);
 
-                BV_ADD_VLIST(&rt_vlfree, m_vlist, actualElement.Point().coordinates, BV_VLIST_POINT_DRAW);
+                BV_ADD_VLIST(m_freeChunks, m_vlist, actualElement.Point().coordinates, BV_VLIST_POINT_DRAW);
                 break;
             }
 
             case Element::ElementType::PointSize: {
                 const PointSize& actualElement = static_cast<const PointSize&>(element);
 
-                BV_VLIST_SET_POINT_SIZE(&rt_vlfree, m_vlist, actualElement.Size());
+                BV_VLIST_SET_POINT_SIZE(m_freeChunks, m_vlist, actualElement.Size());
                 break;
             }
 
             case Element::ElementType::LineMove: {
                 const LineMove& actualElement = static_cast<const LineMove&>(element);
 
-                BV_ADD_VLIST(&rt_vlfree, m_vlist, actualElement.Point().coordinates, BV_VLIST_LINE_MOVE);
+                BV_ADD_VLIST(m_freeChunks, m_vlist, actualElement.Point().coordinates, BV_VLIST_LINE_MOVE);
                 break;
             }
 
             case Element::ElementType::LineDraw: {
                 const LineDraw& actualElement = static_cast<const LineDraw&>(element);
 
-                BV_ADD_VLIST(&rt_vlfree, m_vlist, actualElement.Point().coordinates, BV_VLIST_LINE_DRAW);
+                BV_ADD_VLIST(m_freeChunks, m_vlist, actualElement.Point().coordinates, BV_VLIST_LINE_DRAW);
                 break;
             }
 
             case Element::ElementType::LineWidth: {
                 const LineWidth& actualElement = static_cast<const LineWidth&>(element);
 
-                BV_VLIST_SET_LINE_WIDTH(&rt_vlfree, m_vlist, actualElement.Width());
+                BV_VLIST_SET_LINE_WIDTH(m_freeChunks, m_vlist, actualElement.Width());
                 break;
             }
 
             case Element::ElementType::TriangleStart: {
                 const TriangleStart& actualElement = static_cast<const TriangleStart&>(element);
 
-                BV_ADD_VLIST(&rt_vlfree, m_vlist, actualElement.Normal().coordinates, BV_VLIST_TRI_START);
+                BV_ADD_VLIST(m_freeChunks, m_vlist, actualElement.Normal().coordinates, BV_VLIST_TRI_START);
                 break;
             }
 
             case Element::ElementType::TriangleMove: {
                 const TriangleMove& actualElement = static_cast<const TriangleMove&>(element);
 
-                BV_ADD_VLIST(&rt_vlfree, m_vlist, actualElement.Point().coordinates, BV_VLIST_TRI_MOVE);
+                BV_ADD_VLIST(m_freeChunks, m_vlist, actualElement.Point().coordinates, BV_VLIST_TRI_MOVE);
                 break;
             }
 
             case Element::ElementType::TriangleDraw: {
                 const TriangleDraw& actualElement = static_cast<const TriangleDraw&>(element);
 
-                BV_ADD_VLIST(&rt_vlfree, m_vlist, actualElement.Point().coordinates, BV_VLIST_TRI_DRAW);
+                BV_ADD_VLIST(m_freeChunks, m_vlist, actualElement.Point().coordinates, BV_VLIST_TRI_DRAW);
                 break;
             }
 
             case Element::ElementType::TriangleEnd: {
                 const TriangleEnd& actualElement = static_cast<const TriangleEnd&>(element);
 
-                BV_ADD_VLIST(&rt_vlfree, m_vlist, actualElement.Point().coordinates, BV_VLIST_TRI_END);
+                BV_ADD_VLIST(m_freeChunks, m_vlist, actualElement.Point().coordinates, BV_VLIST_TRI_END);
                 break;
             }
 
             case Element::ElementType::TriangleVertexNormal: {
                 const TriangleVertexNormal& actualElement = static_cast<const TriangleVertexNormal&>(element);
 
-                BV_ADD_VLIST(&rt_vlfree, m_vlist, actualElement.Normal().coordinates, BV_VLIST_TRI_VERTNORM);
+                BV_ADD_VLIST(m_freeChunks, m_vlist, actualElement.Normal().coordinates, BV_VLIST_TRI_VERTNORM);
                 break;
             }
 
             case Element::ElementType::PolygonStart: {
                 const PolygonStart& actualElement = static_cast<const PolygonStart&>(element);
 
-                BV_ADD_VLIST(&rt_vlfree, m_vlist, actualElement.Normal().coordinates, BV_VLIST_POLY_START);
+                BV_ADD_VLIST(m_freeChunks, m_vlist, actualElement.Normal().coordinates, BV_VLIST_POLY_START);
                 break;
             }
 
             case Element::ElementType::PolygonMove: {
                 const PolygonMove& actualElement = static_cast<const PolygonMove&>(element);
 
-                BV_ADD_VLIST(&rt_vlfree, m_vlist, actualElement.Point().coordinates, BV_VLIST_POLY_MOVE);
+                BV_ADD_VLIST(m_freeChunks, m_vlist, actualElement.Point().coordinates, BV_VLIST_POLY_MOVE);
                 break;
             }
 
             case Element::ElementType::PolygonDraw: {
                 const PolygonDraw& actualElement = static_cast<const PolygonDraw&>(element);
 
-                BV_ADD_VLIST(&rt_vlfree, m_vlist, actualElement.Point().coordinates, BV_VLIST_POLY_DRAW);
+                BV_ADD_VLIST(m_freeChunks, m_vlist, actualElement.Point().coordinates, BV_VLIST_POLY_DRAW);
                 break;
             }
 
             case Element::ElementType::PolygonEnd: {
                 const PolygonEnd& actualElement = static_cast<const PolygonEnd&>(element);
 
-                BV_ADD_VLIST(&rt_vlfree, m_vlist, actualElement.Point().coordinates, BV_VLIST_POLY_END);
+                BV_ADD_VLIST(m_freeChunks, m_vlist, actualElement.Point().coordinates, BV_VLIST_POLY_END);
                 break;
             }
 
             case Element::ElementType::PolygonVertexNormal: {
                 const PolygonVertexNormal& actualElement = static_cast<const PolygonVertexNormal&>(element);
 
-                BV_ADD_VLIST(&rt_vlfree, m_vlist, actualElement.Normal().coordinates, BV_VLIST_POLY_VERTNORM);
+                BV_ADD_VLIST(m_freeChunks, m_vlist, actualElement.Normal().coordinates, BV_VLIST_POLY_VERTNORM);
                 break;
             }
 
             case Element::ElementType::DisplaySpace: {
                 const DisplaySpace& actualElement = static_cast<const DisplaySpace&>(element);
 
-                BV_VLIST_SET_DISP_MAT(&rt_vlfree, m_vlist, actualElement.ReferencePoint().coordinates);
+                BV_VLIST_SET_DISP_MAT(m_freeChunks, m_vlist, actualElement.ReferencePoint().coordinates);
                 break;
             }
 
             case Element::ElementType::ModelSpace:
-                BV_VLIST_SET_MODEL_MAT(&rt_vlfree, m_vlist);
+                BV_VLIST_SET_MODEL_MAT(m_freeChunks, m_vlist);
+        }
+
+        ret = true;
+    }
+    else
+        BU_UNSETJUMP;
+
+    BU_UNSETJUMP;
+
+    return ret;
+}
+
+
+/// appends elements to a vlist, the chunks for all of them are taken from \a freeChunks in advance
+class ChunkFiller {
+public:
+    ChunkFiller
+    (
+        bu_list* freeChunks,
+        bu_list* vlist,
+        size_t   numberOfElements
+    ) : m_chunk(nullptr) {
+        size_t room = 0;
+
+        if (!BU_LIST_IS_EMPTY(vlist)) {
+            bv_vlist* last = BU_LIST_LAST(bv_vlist, vlist);
+
+            if (last->nused < BV_VLIST_CHUNK) {
+                m_chunk = last;
+                room    = BV_VLIST_CHUNK - last->nused;
+            }
+        }
+
+        while (room < numberOfElements) {
+            bv_vlist* chunk;
+
+            BV_GET_VLIST(freeChunks, chunk);
+            BU_LIST_INSERT(vlist, &chunk->l);
+
+            if (m_chunk == nullptr)
+                m_chunk = chunk;
+
+            room += BV_VLIST_CHUNK;
+        }
+    }
+
+    /// appends \a count elements of type \a command with the 3 * \a count coordinates in \a points
+    void Add
+    (
+        int           command,
+        size_t        count,
+        const double* points
+    ) {
+        while (count > 0) {
+            if (m_chunk->nused >= BV_VLIST_CHUNK)
+                m_chunk = BU_LIST_NEXT(bv_vlist, &m_chunk->l);
+
+            size_t copied = std::min(count, BV_VLIST_CHUNK - m_chunk->nused);
+
+            memcpy(m_chunk->pt[m_chunk->nused], points, copied * sizeof(point_t));
+
+            for (size_t i = 0; i < copied; ++i)
+                m_chunk->cmd[m_chunk->nused + i] = command;
+
+            m_chunk->nused += copied;
+            count          -= copied;
+            points         += 3 * copied;
+        }
+    }
+
+private:
+    bv_vlist* m_chunk;
+};
+
+
+bool VectorList::AppendPoints
+(
+    size_t        numberOfPoints,
+    const double* points
+) {
+    bool ret = false;
+
+    if (!BU_SETJUMP) {
+        ChunkFiller filler(m_freeChunks, m_vlist, numberOfPoints);
+
+        filler.Add(BV_VLIST_POINT_DRAW, numberOfPoints, points);
+
+        ret = true;
+    }
+    else
+        BU_UNSETJUMP;
+
+    BU_UNSETJUMP;
+
+    return ret;
+}
+
+
+bool VectorList::AppendPolyline
+(
+    size_t        numberOfPoints,
+    const double* points
+) {
+    bool ret = false;
+
+    if (!BU_SETJUMP) {
+        if (numberOfPoints > 0) {
+            ChunkFiller filler(m_freeChunks, m_vlist, numberOfPoints);
+
+            filler.Add(BV_VLIST_LINE_MOVE, 1, points);
+            filler.Add(BV_VLIST_LINE_DRAW, numberOfPoints - 1, points + 3);
+        }
+
+        ret = true;
+    }
+    else
+        BU_UNSETJUMP;
+
+    BU_UNSETJUMP;
+
+    return ret;
+}
+
+
+bool VectorList::AppendTriangles
+(
+    size_t        numberOfTriangles,
+    const double* vertices
+) {
+    bool ret = false;
+
+    if (!BU_SETJUMP) {
+        ChunkFiller filler(m_freeChunks, m_vlist, 5 * numberOfTriangles);
+
+        for (size_t i = 0; i < numberOfTriangles; ++i) {
+            const double* triangle = vertices + 9 * i;
+            vect_t        edge1;
+            vect_t        edge2;
+            vect_t        normal;
+
+            VSUB2(edge1, triangle + 3, triangle);
+            VSUB2(edge2, triangle + 6, triangle);
+            VCROSS(normal, edge1, edge2);
+            VUNITIZE(normal);
+
+            filler.Add(BV_VLIST_TRI_START, 1, normal);
+            filler.Add(BV_VLIST_TRI_MOVE, 1, triangle);
+            filler.Add(BV_VLIST_TRI_DRAW, 2, triangle + 3);
+            filler.Add(BV_VLIST_TRI_END, 1, triangle);
         }
 
         ret = true;
@@ -1383,6 +2377,344 @@ bool VectorList::Append
 }
 
 
+/// squared distance of \a point from the segment between \a start and \a end
+static double SegmentDistanceSquared
+(
+    const double* point,
+    const double* start,
+    const double* end
+) {
+    vect_t  direction;
+    vect_t  offset;
+    point_t nearest;
+    double  lengthSquared;
+    double  parameter = 0.;
+
+    VSUB2(direction, end, start);
+    VSUB2(offset, point, start);
+    lengthSquared = MAGSQ(direction);
+
+    if (lengthSquared > 0.)
+        parameter = std::min(std::max(VDOT(offset, direction) / lengthSquared, 0.), 1.);
+
+    VJOIN1(nearest, start, parameter, direction);
+
+    return DIST_PNT_PNT_SQ(point, nearest);
+}
+
+
+/// marks the points of the polyline \a points[begin, end] which are kept by the Douglas-Peucker algorithm
+static void SimplifyPolyline
+(
+    const std::vector<const double*>& points,
+    size_t                            begin,
+    size_t                            end,
+    double                            toleranceSquared,
+    std::vector<unsigned char>&       keep
+) {
+    std::vector<std::pair<size_t, size_t>> sections;
+
+    keep[begin] = 1;
+    keep[end]   = 1;
+    sections.push_back(std::make_pair(begin, end));
+
+    while (!sections.empty()) {
+        size_t first        = sections.back().first;
+        size_t last         = sections.back().second;
+        size_t farthest     = first;
+        double maximalError = toleranceSquared;
+
+        sections.pop_back();
+
+        for (size_t i = first + 1; i < last; ++i) {
+            double error = SegmentDistanceSquared(points[i], points[first], points[last]);
+
+            if (error > maximalError) {
+                farthest     = i;
+                maximalError = error;
+            }
+        }
+
+        if (farthest != first) {
+            keep[farthest] = 1;
+
+            sections.push_back(std::make_pair(first, farthest));
+            sections.push_back(std::make_pair(farthest, last));
+        }
+    }
+}
+
+
+void VectorList::Simplify
+(
+    double tolerance
+) {
+    std::vector<int>                       commands;
+    std::vector<const double*>             points;
+    std::vector<std::pair<size_t, size_t>> polylines;
+    bool                                   displaySpace = false;
+    bv_vlist*                              chunk;
+
+    for (BU_LIST_FOR(chunk, bv_vlist, m_vlist)) {
+        for (size_t i = 0; i < chunk->nused; ++i) {
+            int command = chunk->cmd[i];
+
+            if (command == BV_VLIST_DISPLAY_MAT)
+                displaySpace = true;
+            else if (command == BV_VLIST_MODEL_MAT)
+                displaySpace = false;
+            else if ((command == BV_VLIST_LINE_DRAW) && !displaySpace && !commands.empty()) {
+                int previousCommand = commands.back();
+
+                if ((previousCommand == BV_VLIST_LINE_MOVE) || (previousCommand == BV_VLIST_LINE_DRAW)) {
+                    if (polylines.empty() || (polylines.back().second != commands.size() - 1))
+                        polylines.push_back(std::make_pair(commands.size() - 1, commands.size()));
+                    else
+                        polylines.back().second = commands.size();
+                }
+            }
+
+            commands.push_back(command);
+            points.push_back(chunk->pt[i]);
+        }
+    }
+
+    // the polylines are simplified in parallel, the elements are only marked there
+    std::vector<unsigned char> keep(commands.size(), 1);
+    double                     toleranceSquared = tolerance * tolerance;
+
+    for (size_t i = 0; i < polylines.size(); ++i) {
+        for (size_t j = polylines[i].first + 1; j < polylines[i].second; ++j)
+            keep[j] = 0;
+    }
+
+    ParallelFor(polylines.size(), 64, [&polylines, &points, toleranceSquared, &keep](size_t begin, size_t end, size_t) {
+        for (size_t i = begin; i < end; ++i)
+            SimplifyPolyline(points, polylines[i].first, polylines[i].second, toleranceSquared, keep);
+    });
+
+    // moves the kept elements to the front of the list, the writing position never overtakes the reading one
+    bv_vlist* writeChunk = BU_LIST_FIRST(bv_vlist, m_vlist);
+    size_t    writeIndex = 0;
+    size_t    element    = 0;
+
+    for (BU_LIST_FOR(chunk, bv_vlist, m_vlist)) {
+        for (size_t i = 0; i < chunk->nused; ++i, ++element) {
+            if (keep[element] != 0) {
+                if (writeIndex == BV_VLIST_CHUNK) {
+                    writeChunk->nused = writeIndex;
+                    writeChunk        = BU_LIST_NEXT(bv_vlist, &writeChunk->l);
+                    writeIndex        = 0;
+                }
+
+                writeChunk->cmd[writeIndex] = chunk->cmd[i];
+                VMOVE(writeChunk->pt[writeIndex], chunk->pt[i]);
+                ++writeIndex;
+            }
+        }
+    }
+
+    if (!BU_LIST_IS_HEAD(writeChunk, m_vlist)) {
+        writeChunk->nused = writeIndex;
+
+        // the emptied chunks go back to the pool
+        while (BU_LIST_NEXT_NOT_HEAD(writeChunk, m_vlist)) {
+            chunk = BU_LIST_NEXT(bv_vlist, &writeChunk->l);
+            BU_LIST_DEQUEUE(&chunk->l);
+            BU_LIST_INSERT(m_freeChunks, &chunk->l);
+        }
+
+        if (writeIndex == 0) {
+            BU_LIST_DEQUEUE(&writeChunk->l);
+            BU_LIST_INSERT(m_freeChunks, &writeChunk->l);
+        }
+    }
+}
+
+
 void VectorList::Clear(void) {
-    BV_FREE_VLIST(&rt_vlfree, m_vlist);
+    BV_FREE_VLIST(m_freeChunks, m_vlist);
+}
+
+
+void VectorList::Reserve
+(
+    size_t numberOfElements
+) {
+    size_t    available = 0;
+    bv_vlist* chunk;
+
+    for (BU_LIST_FOR(chunk, bv_vlist, m_freeChunks))
+        available += BV_VLIST_CHUNK;
+
+    if (!BU_LIST_IS_EMPTY(m_vlist))
+        available += BV_VLIST_CHUNK - BU_LIST_LAST(bv_vlist, m_vlist)->nused;
+
+    if (!BU_SETJUMP) {
+        while (available < numberOfElements) {
+            BU_ALLOC(chunk, bv_vlist);
+            chunk->l.magic = BV_VLIST_MAGIC;
+            BU_LIST_INSERT(m_freeChunks, &chunk->l);
+
+            available += BV_VLIST_CHUNK;
+        }
+    }
+    else
+        BU_UNSETJUMP;
+
+    BU_UNSETJUMP;
+}
+
+
+void VectorList::FreeUnusedMemory(void) {
+    bv_vlist_cleanup(m_freeChunks);
+}
+
+
+bool VectorList::Save
+(
+    const char*      fileName,
+    CoordinateFormat coordinateFormat
+) const {
+    bool                 ret = false;
+    VectorListFileHeader header;
+    double               maximum[3];
+    bv_vlist*            chunk;
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, VectorListFileMagic, sizeof(VectorListFileMagic));
+    header.version          = VectorListFileVersion;
+    header.coordinateFormat = static_cast<uint32_t>(coordinateFormat);
+    VSETALL(header.minimum, INFINITY);
+    VSETALL(maximum, -INFINITY);
+
+    for (BU_LIST_FOR(chunk, bv_vlist, m_vlist)) {
+        header.numberOfElements += chunk->nused;
+
+        for (size_t i = 0; i < chunk->nused; ++i) {
+            if (IsUnquantized(chunk->cmd[i])) {
+                if (coordinateFormat == CoordinateFormat::Quantized16)
+                    ++header.numberOfUnquantized;
+            }
+            else if (!IsNormal(chunk->cmd[i])) {
+                VMIN(header.minimum, chunk->pt[i]);
+                VMAX(maximum, chunk->pt[i]);
+            }
+        }
+    }
+
+    if ((coordinateFormat == CoordinateFormat::Quantized16) && (header.minimum[X] <= maximum[X])) {
+        for (size_t i = 0; i < 3; ++i)
+            header.step[i] = (maximum[i] - header.minimum[i]) / 65535.;
+    }
+    else
+        VSETALL(header.minimum, 0.);
+
+    FILE* file = fopen(fileName, "wb");
+
+    if (file != nullptr) {
+        size_t                     numberOfElements = static_cast<size_t>(header.numberOfElements);
+        size_t                     coordinatesSize  = CoordinatesSize(coordinateFormat);
+        std::vector<unsigned char> buffer(CoordinatesOffset(numberOfElements), 0);
+        size_t                     index            = sizeof(header);
+        std::vector<double>        unquantized;
+        bool                       success;
+
+        memcpy(buffer.data(), &header, sizeof(header));
+
+        for (BU_LIST_FOR(chunk, bv_vlist, m_vlist)) {
+            for (size_t i = 0; i < chunk->nused; ++i)
+                buffer[index++] = static_cast<unsigned char>(chunk->cmd[i]);
+        }
+
+        success = (fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size());
+
+        // the coordinates are written chunk by chunk
+        buffer.resize(BV_VLIST_CHUNK * coordinatesSize);
+
+        for (BU_LIST_FOR(chunk, bv_vlist, m_vlist)) {
+            if (!success)
+                break;
+
+            for (size_t i = 0; i < chunk->nused; ++i) {
+                EncodeCoordinates(header, chunk->cmd[i], chunk->pt[i], buffer.data() + i * coordinatesSize);
+
+                if ((coordinateFormat == CoordinateFormat::Quantized16) && IsUnquantized(chunk->cmd[i]))
+                    unquantized.insert(unquantized.end(), chunk->pt[i], chunk->pt[i] + 3);
+            }
+
+            success = (fwrite(buffer.data(), 1, chunk->nused * coordinatesSize, file) == chunk->nused * coordinatesSize);
+        }
+
+        if (success && !unquantized.empty()) {
+            size_t padding = UnquantizedOffset(numberOfElements, coordinatesSize) - CoordinatesOffset(numberOfElements) - numberOfElements * coordinatesSize;
+
+            buffer.assign(padding, 0);
+            success = (fwrite(buffer.data(), 1, padding, file) == padding) &&
+                      (fwrite(unquantized.data(), sizeof(double), unquantized.size(), file) == unquantized.size());
+        }
+
+        success = (fclose(file) == 0) && success;
+
+        if (!success)
+            std::remove(fileName);
+
+        ret = success;
+    }
+
+    return ret;
+}
+
+
+bool VectorList::Save
+(
+    const char* fileName
+) const {
+    return Save(fileName, CoordinateFormat::Double);
+}
+
+
+bool VectorList::Load
+(
+    const char* fileName
+) {
+    MappedView view;
+    bool       ret = view.Open(fileName);
+
+    if (ret) {
+        const MappedView::Mapping& mapping          = *view.m_mapping;
+        size_t                     numberOfElements = view.NumberOfElements();
+        bu_list                    loaded;
+
+        // the elements are decoded into a list of their own, the content is replaced only if this succeeds
+        BU_LIST_INIT(&loaded);
+
+        if (!BU_SETJUMP) {
+            ChunkFiller filler(m_freeChunks, &loaded, numberOfElements);
+            size_t      unquantizedIndex = 0;
+
+            for (size_t i = 0; i < numberOfElements; ++i) {
+                int    command = mapping.commands[i];
+                double point[3];
+
+                DecodeCoordinates(mapping.header, command, mapping.coordinates + i * mapping.coordinatesSize, mapping.unquantized, unquantizedIndex, point);
+                filler.Add(command, 1, point);
+            }
+        }
+        else {
+            BU_UNSETJUMP;
+            ret = false;
+        }
+
+        BU_UNSETJUMP;
+
+        if (ret) {
+            Clear();
+            BU_LIST_APPEND_LIST(m_vlist, &loaded);
+        }
+        else
+            BV_FREE_VLIST(m_freeChunks, &loaded);
+    }
+
+    return ret;
 }